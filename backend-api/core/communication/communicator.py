@@ -8,6 +8,7 @@ import services.script_to_api_pb2_grpc
 import services.marketdata_pb2_grpc
 
 import messages.script_submit_pb2
+import messages.market_data_request_pb2
 
 
 class ApiToCoreHandler:
@@ -47,15 +48,19 @@ class DistributorToApiHandler:
 
     async def _listen(self):
         try:
-            stream = self.stub.StreamPrices(empty_pb2.Empty())
-            async for price_update in stream:
-                data = {}
-                data['MessageType'] = 'price_update'
-                data['price'] = price_update.price
-                data['quantity'] = price_update.quantity
-                await self.notif_callback(json.dumps(data))
+            # no instrument ids, the web api streams every instrument
+            request = messages.market_data_request_pb2.MarketDataRequest()
+            # one message per write holds every queued update
+            stream = self.stub.StreamPriceBatches(request)
+            async for batch in stream:
+                for price_update in batch.updates:
+                    data = {}
+                    data['MessageType'] = 'price_update'
+                    data['price'] = price_update.price
+                    data['quantity'] = price_update.quantity
+                    await self.notif_callback(json.dumps(data))
         except grpc.RpcError as err:
-            print(f"StreamPrices error: {err}")
+            print(f"StreamPriceBatches error: {err}")
 
     async def stop(self):
         if self._stream_task:
@@ -0,0 +1,103 @@
+// fire latency of fast timers when slow timers share the TimerManager
+//
+// a few slow timers sleep in their callback, the fast timers record how
+// late they ran compared to their deadline
+// run once with the callbacks on the timer thread (worker_threads = 0)
+// and with the work stealing executor
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "processors/common/timers.h"
+
+using namespace std::chrono;
+
+namespace {
+
+constexpr int kSlowTimers = 4;
+constexpr milliseconds kSlowDelay{20};
+constexpr milliseconds kSlowDuration{15};
+constexpr int kSlowRepeat = 50;
+
+constexpr int kFastTimers = 200;
+constexpr milliseconds kFastDelay{5};
+constexpr int kFastRepeat = 200;
+
+double Percentile(const std::vector<long long> &sorted, double percent) {
+  if (sorted.empty()) {
+    return 0.0;
+  }
+
+  const std::size_t index = static_cast<std::size_t>(
+      percent / 100.0 * static_cast<double>(sorted.size() - 1));
+  return static_cast<double>(sorted[index]);
+}
+
+void Run(std::size_t worker_threads) {
+  TimerConfig config;
+  config.backend = TimerBackend::Wheel;
+  config.worker_threads = worker_threads;
+
+  std::mutex latencies_mtx;
+  std::vector<long long> latencies;
+  latencies.reserve(kFastTimers * kFastRepeat);
+
+  {
+    TimerManager manager(config);
+
+    for (int i = 0; i < kSlowTimers; ++i) {
+      manager.CreateTimer([] { std::this_thread::sleep_for(kSlowDuration); },
+                          kSlowDelay, kSlowRepeat);
+    }
+
+    for (int i = 0; i < kFastTimers; ++i) {
+      const auto start = steady_clock::now();
+      auto fire_index = std::make_shared<int>(0);
+
+      manager.CreateTimer(
+          [&latencies_mtx, &latencies, start, fire_index] {
+            const auto expected = start + kFastDelay * ++(*fire_index);
+            const auto late = steady_clock::now() - expected;
+
+            std::lock_guard<std::mutex> lock(latencies_mtx);
+            latencies.push_back(duration_cast<microseconds>(late).count());
+          },
+          kFastDelay, kFastRepeat);
+    }
+
+    manager.WaitTillLast(0);
+  }
+
+  std::sort(latencies.begin(), latencies.end());
+
+  std::cout << std::setw(8) << worker_threads << std::setw(10)
+            << latencies.size() << std::fixed << std::setprecision(0)
+            << std::setw(10) << Percentile(latencies, 50) << std::setw(10)
+            << Percentile(latencies, 90) << std::setw(10)
+            << Percentile(latencies, 99) << std::setw(10)
+            << Percentile(latencies, 99.9) << std::setw(10)
+            << (latencies.empty() ? 0 : latencies.back()) << std::endl;
+}
+
+} // namespace
+
+int main() {
+  std::cout << "fast timer fire latency in us, " << kSlowTimers
+            << " slow timers sleeping " << kSlowDuration.count() << "ms every "
+            << kSlowDelay.count() << "ms" << std::endl;
+  std::cout << std::setw(8) << "workers" << std::setw(10) << "fires"
+            << std::setw(10) << "p50" << std::setw(10) << "p90"
+            << std::setw(10) << "p99" << std::setw(10) << "p99.9"
+            << std::setw(10) << "max" << std::endl;
+
+  for (std::size_t workers : {0, 2, 4, 8}) {
+    Run(workers);
+  }
+
+  return 0;
+}
@@ -0,0 +1,126 @@
+// CreateTimer() cost when many threads create timers at the same time
+//
+// 1, 4 and 16 producer threads create short timers while the timer
+// thread fires the ones created before, as ReactOn callbacks creating
+// timers at tick rate would do
+// every call is timed, the table shows the latency of one call
+// and the number of timers created per second by all the producers
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "processors/common/timers.h"
+
+using namespace std::chrono;
+
+namespace {
+
+constexpr int kTimersPerRound = 160000;
+constexpr milliseconds kDelay{1};
+
+double Percentile(const std::vector<long long> &sorted, double percent) {
+  if (sorted.empty()) {
+    return 0.0;
+  }
+
+  const std::size_t index = static_cast<std::size_t>(
+      percent / 100.0 * static_cast<double>(sorted.size() - 1));
+  return static_cast<double>(sorted[index]);
+}
+
+// returns the time taken by the slowest producer
+nanoseconds Round(TimerManager &manager, int producers,
+                  std::vector<std::vector<long long>> &latencies,
+                  std::atomic<long long> &fired) {
+  const int per_producer = kTimersPerRound / producers;
+  std::atomic<int> ready{0};
+  std::atomic<bool> go{false};
+  std::vector<std::thread> threads;
+  std::vector<nanoseconds> elapsed(producers);
+
+  for (int p = 0; p < producers; ++p) {
+    latencies[p].clear();
+    threads.emplace_back([&, p] {
+      ready++;
+      while (!go.load()) {
+        std::this_thread::yield();
+      }
+
+      const auto start = steady_clock::now();
+      for (int i = 0; i < per_producer; ++i) {
+        const auto before = steady_clock::now();
+        manager.CreateTimer([&fired] { fired++; }, kDelay, 1);
+        latencies[p].push_back(
+            duration_cast<nanoseconds>(steady_clock::now() - before).count());
+      }
+      elapsed[p] = steady_clock::now() - start;
+    });
+  }
+
+  while (ready.load() != producers) {
+    std::this_thread::yield();
+  }
+  go = true;
+
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  manager.WaitTillLast(0);
+
+  return *std::max_element(elapsed.begin(), elapsed.end());
+}
+
+void Run(int producers) {
+  TimerConfig config;
+  config.backend = TimerBackend::Wheel;
+
+  TimerManager manager(config);
+  std::atomic<long long> fired{0};
+  std::vector<std::vector<long long>> latencies(producers);
+  for (auto &producer_latencies : latencies) {
+    producer_latencies.reserve(kTimersPerRound / producers);
+  }
+
+  // warmup, the store and the queue grow here
+  Round(manager, producers, latencies, fired);
+  const nanoseconds elapsed = Round(manager, producers, latencies, fired);
+
+  std::vector<long long> all;
+  for (const auto &producer_latencies : latencies) {
+    all.insert(all.end(), producer_latencies.begin(),
+               producer_latencies.end());
+  }
+  std::sort(all.begin(), all.end());
+
+  const double timers_per_second =
+      static_cast<double>(all.size()) /
+      duration_cast<duration<double>>(elapsed).count();
+
+  std::cout << std::setw(10) << producers << std::fixed
+            << std::setprecision(0) << std::setw(10) << Percentile(all, 50)
+            << std::setw(10) << Percentile(all, 99) << std::setw(10)
+            << Percentile(all, 99.9) << std::setw(12) << all.back()
+            << std::setw(14) << timers_per_second << std::endl;
+}
+
+} // namespace
+
+int main() {
+  std::cout << "CreateTimer() latency in ns, " << kTimersPerRound
+            << " timers of " << kDelay.count() << "ms per round" << std::endl;
+  std::cout << std::setw(10) << "producers" << std::setw(10) << "p50"
+            << std::setw(10) << "p99" << std::setw(10) << "p99.9"
+            << std::setw(12) << "max" << std::setw(14) << "timers/s"
+            << std::endl;
+
+  for (int producers : {1, 4, 16}) {
+    Run(producers);
+  }
+
+  return 0;
+}
@@ -0,0 +1,93 @@
+// how late a repeating timer fires, with each wait mode
+//
+// one timer repeats at a fixed interval, its callback takes the time
+// and compares it to the deadline of the fire (the interval doesn't
+// drift, fire i is due at start + interval * (i + 1))
+// the table shows the lateness of the fires in us
+//
+// TimerWait::Sleep relies on the condition variable waking up in time,
+// TimerWait::Hybrid sleeps until spin_window before the deadline
+// and spins for the rest, at the cost of a busy core
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "processors/common/timers.h"
+
+using namespace std::chrono;
+
+namespace {
+
+constexpr seconds kRoundTime{2};
+
+double Percentile(const std::vector<long long> &sorted, double percent) {
+  if (sorted.empty()) {
+    return 0.0;
+  }
+
+  const std::size_t index = static_cast<std::size_t>(
+      percent / 100.0 * static_cast<double>(sorted.size() - 1));
+  return static_cast<double>(sorted[index]);
+}
+
+void Run(const std::string &name, const TimerConfig &config,
+         microseconds interval) {
+  const int fires = static_cast<int>(kRoundTime / interval);
+  std::vector<steady_clock::time_point> fire_times;
+  fire_times.reserve(fires);
+
+  TimerManager manager(config);
+  const auto start = steady_clock::now();
+  manager.CreateTimer([&] { fire_times.push_back(steady_clock::now()); },
+                      interval, fires);
+  manager.WaitTillLast(0);
+
+  std::vector<long long> lateness;
+  lateness.reserve(fire_times.size());
+  for (std::size_t i = 0; i < fire_times.size(); ++i) {
+    const auto due = start + interval * (i + 1);
+    lateness.push_back(duration_cast<nanoseconds>(fire_times[i] - due).count());
+  }
+  std::sort(lateness.begin(), lateness.end());
+
+  std::cout << std::setw(18) << name << std::setw(10) << interval.count()
+            << std::fixed << std::setprecision(1) << std::setw(10)
+            << Percentile(lateness, 50) / 1000.0 << std::setw(10)
+            << Percentile(lateness, 99) / 1000.0 << std::setw(10)
+            << Percentile(lateness, 99.9) / 1000.0 << std::setw(10)
+            << lateness.back() / 1000.0 << std::endl;
+}
+
+} // namespace
+
+int main() {
+  TimerConfig heap_sleep;
+
+  TimerConfig heap_hybrid;
+  heap_hybrid.wait = TimerWait::Hybrid;
+
+  // deadlines are rounded to the tick, so a small one
+  TimerConfig wheel_hybrid;
+  wheel_hybrid.backend = TimerBackend::Wheel;
+  wheel_hybrid.wheel_tick = microseconds(10);
+  wheel_hybrid.wait = TimerWait::Hybrid;
+
+  std::cout << "fire lateness in us, " << kRoundTime.count()
+            << "s per round" << std::endl;
+  std::cout << std::setw(18) << "mode" << std::setw(10) << "every us"
+            << std::setw(10) << "p50" << std::setw(10) << "p99"
+            << std::setw(10) << "p99.9" << std::setw(10) << "max"
+            << std::endl;
+
+  for (const microseconds interval : {microseconds(1000), microseconds(250)}) {
+    Run("heap sleep", heap_sleep, interval);
+    Run("heap hybrid", heap_hybrid, interval);
+    Run("wheel hybrid", wheel_hybrid, interval);
+  }
+
+  return 0;
+}
@@ -0,0 +1,119 @@
+// compares the heap and the timing wheel backends of TimerManager
+// the queues are driven directly with a simulated clock
+// so only the data structure cost is measured
+//
+// for each size the queue is filled with periodic timers (1ms to 10s)
+// then the time is advanced by 1ms steps, every expired timer being
+// pushed back with its interval, as TimerManager::Run() does
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "processors/common/timer_queue.h"
+#include "processors/common/timing_wheel.h"
+
+using namespace std::chrono;
+
+namespace {
+
+constexpr microseconds kWheelTick{100};
+constexpr milliseconds kStep{1};
+constexpr int kSteps = 2000;
+
+struct Result {
+  double insert_ns;
+  double fire_ns;
+  unsigned long long fired;
+};
+
+std::vector<std::unique_ptr<Task>> MakeTasks(std::size_t count,
+                                             steady_clock::time_point origin) {
+  std::mt19937_64 rng(42);
+  std::uniform_int_distribution<int> interval_ms(1, 10000);
+
+  std::vector<std::unique_ptr<Task>> tasks;
+  tasks.reserve(count);
+  for (std::size_t i = 0; i < count; ++i) {
+    const milliseconds interval(interval_ms(rng));
+    tasks.push_back(
+        std::make_unique<Task>(origin + interval, interval, [] {}, -1));
+  }
+  return tasks;
+}
+
+Result Run(TimerQueue &queue, const std::vector<std::unique_ptr<Task>> &tasks,
+           steady_clock::time_point origin) {
+  Result result{};
+
+  const auto insert_start = steady_clock::now();
+  for (const auto &task : tasks) {
+    queue.Push(task.get());
+  }
+  const auto insert_end = steady_clock::now();
+  result.insert_ns =
+      static_cast<double>(duration_cast<nanoseconds>(insert_end - insert_start)
+                              .count()) /
+      tasks.size();
+
+  std::vector<Task *> expired;
+  auto now = origin;
+
+  const auto fire_start = steady_clock::now();
+  for (int step = 0; step < kSteps; ++step) {
+    now += kStep;
+    queue.PopExpired(now, expired);
+
+    for (Task *task : expired) {
+      task->time_to_run += task->interval;
+      queue.Push(task);
+    }
+    result.fired += expired.size();
+    expired.clear();
+  }
+  const auto fire_end = steady_clock::now();
+
+  result.fire_ns =
+      result.fired == 0
+          ? 0.0
+          : static_cast<double>(
+                duration_cast<nanoseconds>(fire_end - fire_start).count()) /
+                result.fired;
+  return result;
+}
+
+void Print(const std::string &name, std::size_t count, const Result &result) {
+  std::cout << std::left << std::setw(8) << name << std::right << std::setw(10)
+            << count << std::setw(14) << std::fixed << std::setprecision(1)
+            << result.insert_ns << std::setw(14) << result.fire_ns
+            << std::setw(12) << result.fired << std::endl;
+}
+
+} // namespace
+
+int main() {
+  std::cout << std::left << std::setw(8) << "queue" << std::right
+            << std::setw(10) << "timers" << std::setw(14) << "insert ns/op"
+            << std::setw(14) << "fire ns/op" << std::setw(12) << "fired"
+            << std::endl;
+
+  for (std::size_t count : {10'000, 100'000, 1'000'000}) {
+    const auto origin = steady_clock::now();
+
+    {
+      HeapTimerQueue heap;
+      Print("heap", count, Run(heap, MakeTasks(count, origin), origin));
+    }
+
+    {
+      TimingWheel wheel(kWheelTick, origin);
+      Print("wheel", count, Run(wheel, MakeTasks(count, origin), origin));
+    }
+  }
+
+  return 0;
+}
@@ -0,0 +1,138 @@
+// cost of the shared memory market data ring
+//
+// one writer publishes ticks at a steady pace, each reader spins on the
+// ring and records the time between the publish and its read
+// the writer cost per tick does not depend on the number of readers,
+// readers run as threads here, separate processes see the same memory
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "services/market_data_ring.h"
+
+using namespace std::chrono;
+
+namespace {
+
+constexpr int kTicks = 200000;
+// one tick every 2 us
+constexpr nanoseconds kTickInterval{2000};
+
+long long NowNs() {
+  return duration_cast<nanoseconds>(steady_clock::now().time_since_epoch())
+      .count();
+}
+
+double Percentile(const std::vector<long long> &sorted, double percent) {
+  if (sorted.empty()) {
+    return 0.0;
+  }
+
+  const std::size_t index = static_cast<std::size_t>(
+      percent / 100.0 * static_cast<double>(sorted.size() - 1));
+  return static_cast<double>(sorted[index]);
+}
+
+void Run(const std::string &name, int reader_count) {
+  MarketDataRingWriter writer;
+  if (!writer.Create(name)) {
+    return;
+  }
+
+  std::vector<std::vector<long long>> latencies(reader_count);
+  std::vector<uint64_t> lost(reader_count, 0);
+  std::atomic<int> ready{0};
+  std::atomic<bool> done{false};
+  std::vector<std::thread> readers;
+
+  for (int i = 0; i < reader_count; ++i) {
+    readers.emplace_back([&, i] {
+      MarketDataRingReader reader;
+      if (!reader.Open(name)) {
+        ready++;
+        return;
+      }
+      latencies[i].reserve(kTicks);
+      ready++;
+
+      MarketDataRecord record;
+      while (!done) {
+        if (reader.Poll(record)) {
+          latencies[i].push_back(NowNs() - record.timestamp_seconds);
+        }
+      }
+      lost[i] = reader.LostCount();
+    });
+  }
+
+  while (ready < reader_count) {
+    std::this_thread::yield();
+  }
+
+  MarketDataRecord record{};
+  std::strncpy(record.instrument_id, "AAPL", sizeof(record.instrument_id));
+
+  long long publish_ns = 0;
+  auto next_tick = steady_clock::now();
+  for (int tick = 0; tick < kTicks; ++tick) {
+    while (steady_clock::now() < next_tick) {
+    }
+    next_tick += kTickInterval;
+
+    // the publish time goes in the record
+    const long long start = NowNs();
+    record.timestamp_seconds = start;
+    record.quantity = tick;
+    writer.Publish(record);
+    publish_ns += NowNs() - start;
+  }
+
+  std::this_thread::sleep_for(milliseconds(10));
+  done = true;
+  for (auto &reader : readers) {
+    reader.join();
+  }
+
+  std::vector<long long> all;
+  uint64_t all_lost = 0;
+  for (int i = 0; i < reader_count; ++i) {
+    all.insert(all.end(), latencies[i].begin(), latencies[i].end());
+    all_lost += lost[i];
+  }
+  std::sort(all.begin(), all.end());
+
+  std::cout << std::setw(8) << reader_count << std::fixed
+            << std::setprecision(1) << std::setw(12)
+            << static_cast<double>(publish_ns) / kTicks << std::setprecision(0)
+            << std::setw(10) << Percentile(all, 50) << std::setw(10)
+            << Percentile(all, 99) << std::setw(10) << all_lost << std::endl;
+}
+
+} // namespace
+
+int main() {
+  const std::string name =
+      "/fiscript_market_data_bench_" + std::to_string(getpid());
+  const int max_readers = std::max(
+      1, static_cast<int>(std::thread::hardware_concurrency()) - 1);
+
+  std::cout << kTicks << " ticks, one every " << kTickInterval.count()
+            << " ns" << std::endl;
+  std::cout << std::setw(8) << "readers" << std::setw(12) << "publish ns"
+            << std::setw(10) << "p50 ns" << std::setw(10) << "p99 ns"
+            << std::setw(10) << "lost" << std::endl;
+
+  for (int readers = 1; readers <= max_readers; readers *= 2) {
+    Run(name, readers);
+  }
+
+  return 0;
+}
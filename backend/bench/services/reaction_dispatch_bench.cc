@@ -0,0 +1,95 @@
+// cost of finding the reactions of a tick on a 5k symbols feed
+//
+// scan goes through every registered reaction and compares its
+// instrument, as the stream reader did before the ReactionIndex
+// (plus a second pass for the stop check), index does one lookup
+// 1, 100 and 5000 reactions watch different symbols, every symbol
+// of the feed ticks in turn, so most ticks match no reaction
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "services/reaction_index.h"
+#include "services/reacton_service.h"
+
+using namespace std::chrono;
+
+namespace {
+
+constexpr int kSymbols = 5000;
+constexpr int kTicks = 2000000;
+
+double Scan(const std::vector<std::shared_ptr<Reaction>> &reactions,
+            const std::vector<std::string> &feed, long long &matches) {
+  const auto start = steady_clock::now();
+  for (int tick = 0; tick < kTicks; ++tick) {
+    const std::string &instrument_id = feed[tick % kSymbols];
+    for (const auto &reaction : reactions) {
+      if (reaction->instrument_id == instrument_id) {
+        matches++;
+      }
+    }
+    // ShouldStopReading()
+    for (const auto &reaction : reactions) {
+      if (reaction->current_count < reaction->max_count) {
+        break;
+      }
+    }
+  }
+  return duration<double, std::nano>(steady_clock::now() - start).count() /
+         kTicks;
+}
+
+double Index(const ReactionIndex &index, const std::vector<std::string> &feed,
+             long long &matches) {
+  const auto start = steady_clock::now();
+  for (int tick = 0; tick < kTicks; ++tick) {
+    for (Reaction *reaction : index.Find(feed[tick % kSymbols])) {
+      (void)reaction;
+      matches++;
+    }
+  }
+  return duration<double, std::nano>(steady_clock::now() - start).count() /
+         kTicks;
+}
+
+} // namespace
+
+int main() {
+  std::vector<std::string> feed;
+  for (int i = 0; i < kSymbols; ++i) {
+    feed.push_back("SYM" + std::to_string(i));
+  }
+
+  std::cout << "ns per tick, " << kSymbols << " symbols on the feed"
+            << std::endl;
+  std::cout << std::setw(10) << "reactions" << std::setw(10) << "scan"
+            << std::setw(10) << "index" << std::endl;
+
+  for (int watched : {1, 100, 5000}) {
+    std::vector<std::shared_ptr<Reaction>> reactions;
+    for (int i = 0; i < watched; ++i) {
+      reactions.push_back(std::make_shared<Reaction>(
+          feed[i * (kSymbols / watched)], -1,
+          [](const internal::PriceUpdate &) {}));
+    }
+    const ReactionIndex index(reactions);
+
+    long long scan_matches = 0;
+    long long index_matches = 0;
+    const double scan = Scan(reactions, feed, scan_matches);
+    const double indexed = Index(index, feed, index_matches);
+
+    std::cout << std::setw(10) << watched << std::fixed
+              << std::setprecision(1) << std::setw(10) << scan
+              << std::setw(10) << indexed
+              << (scan_matches == index_matches ? "" : "  (mismatch)")
+              << std::endl;
+  }
+
+  return 0;
+}
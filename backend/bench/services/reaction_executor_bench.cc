@@ -0,0 +1,128 @@
+// latency of fast reactions when one reaction is slow
+//
+// the slow reaction sleeps 5 ms per tick, the fast ones record the time
+// between the arrival of their tick and the start of their callback
+// "inline" runs every callback on the reading thread, as the stream
+// reader did before the ReactionExecutor, the other rows use the
+// executor with per reaction strands
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "services/reaction_executor.h"
+#include "services/reacton_service.h"
+
+using namespace std::chrono;
+
+namespace {
+
+constexpr milliseconds kSlowDuration{5};
+constexpr int kFastReactions = 50;
+constexpr int kTicks = 400;
+// one tick every 250 us, the slow reaction gets one tick in 20
+constexpr microseconds kTickInterval{250};
+constexpr int kSlowEvery = 20;
+
+double Percentile(const std::vector<long long> &sorted, double percent) {
+  if (sorted.empty()) {
+    return 0.0;
+  }
+
+  const std::size_t index = static_cast<std::size_t>(
+      percent / 100.0 * static_cast<double>(sorted.size() - 1));
+  return static_cast<double>(sorted[index]);
+}
+
+void Run(std::size_t worker_threads) {
+  std::mutex latencies_mtx;
+  std::vector<long long> latencies;
+
+  auto record = [&latencies_mtx,
+                 &latencies](const internal::PriceUpdate &update) {
+    const auto arrival = steady_clock::time_point(nanoseconds(
+        update.timestamp().seconds() * 1000000000LL +
+        update.timestamp().nanos()));
+    const auto late = steady_clock::now() - arrival;
+
+    std::lock_guard<std::mutex> lock(latencies_mtx);
+    latencies.push_back(duration_cast<microseconds>(late).count());
+  };
+
+  Reaction slow("SLOW", -1, [](const internal::PriceUpdate &) {
+    std::this_thread::sleep_for(kSlowDuration);
+  });
+  std::vector<std::unique_ptr<Reaction>> fast;
+  for (int i = 0; i < kFastReactions; ++i) {
+    fast.push_back(std::make_unique<Reaction>("FAST" + std::to_string(i), -1,
+                                              record));
+  }
+
+  std::unique_ptr<ReactionExecutor> executor;
+  if (worker_threads > 0) {
+    executor = std::make_unique<ReactionExecutor>(worker_threads,
+                                                  [](Reaction &) {});
+  }
+
+  auto next_tick = steady_clock::now();
+  for (int tick = 0; tick < kTicks; ++tick) {
+    // a tick arrives every kTickInterval, a late reader reads it later
+    const auto arrival = next_tick;
+    std::this_thread::sleep_until(arrival);
+    next_tick += kTickInterval;
+
+    Reaction &reaction =
+        tick % kSlowEvery == 0 ? slow : *fast[tick % kFastReactions];
+
+    const long long now =
+        duration_cast<nanoseconds>(arrival.time_since_epoch()).count();
+    internal::PriceUpdate update;
+    update.set_instrument_id(reaction.instrument_id);
+    update.mutable_timestamp()->set_seconds(now / 1000000000LL);
+    update.mutable_timestamp()->set_nanos(
+        static_cast<int32_t>(now % 1000000000LL));
+
+    if (executor) {
+      executor->Post(reaction, update);
+    } else {
+      reaction.callback(update);
+    }
+  }
+
+  if (executor) {
+    executor->WaitIdle();
+  }
+
+  std::sort(latencies.begin(), latencies.end());
+
+  std::cout << std::setw(8)
+            << (worker_threads == 0 ? std::string("inline")
+                                    : std::to_string(worker_threads))
+            << std::setw(10) << latencies.size() << std::fixed
+            << std::setprecision(0) << std::setw(10)
+            << Percentile(latencies, 50) << std::setw(10)
+            << Percentile(latencies, 99) << std::setw(10)
+            << Percentile(latencies, 100) << std::endl;
+}
+
+} // namespace
+
+int main() {
+  std::cout << "fast reaction latency in us, one reaction sleeps "
+            << kSlowDuration.count() << " ms per tick" << std::endl;
+  std::cout << std::setw(8) << "workers" << std::setw(10) << "ticks"
+            << std::setw(10) << "p50" << std::setw(10) << "p99"
+            << std::setw(10) << "max" << std::endl;
+
+  for (std::size_t worker_threads : {0, 2, 4}) {
+    Run(worker_threads);
+  }
+
+  return 0;
+}
@@ -54,7 +54,7 @@ struct ParenExprNode : ExprNode {
 };
 
 struct Command {
-  enum CommandType { Schedule, ReactOn, Print, Alert, VariableDeclaration, VariableAssignment, SendOrder, If };
+  enum CommandType { Schedule, ReactOn, Print, Alert, VariableDeclaration, VariableAssignment, SendOrder, If, Cancel, Reschedule };
 
   CommandType type;
   std::vector<std::string> arguments;
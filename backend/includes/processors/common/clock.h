@@ -0,0 +1,86 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+
+// time source of the TimerManager and of the services
+//
+// Now() is the steady time used for the deadlines, WallNow() the
+// date written in the messages (alerts creation time for instance)
+class Clock {
+public:
+  using TimePoint = std::chrono::steady_clock::time_point;
+  using Duration = std::chrono::steady_clock::duration;
+  using WallTimePoint = std::chrono::system_clock::time_point;
+
+  virtual ~Clock() = default;
+
+  virtual TimePoint Now() const = 0;
+  virtual WallTimePoint WallNow() const = 0;
+};
+
+class RealClock final : public Clock {
+public:
+  TimePoint Now() const override { return std::chrono::steady_clock::now(); }
+  WallTimePoint WallNow() const override {
+    return std::chrono::system_clock::now();
+  }
+};
+
+// time only moves when AdvanceTo() is called
+//
+// a TimerManager using it jumps straight to its next deadline instead of
+// sleeping, once the thread owning it waits in WaitTillLast() and no
+// callback is running, so a run is deterministic and goes as fast as
+// the callbacks do
+// a simulated clock is meant to drive a single TimerManager
+class SimulatedClock final : public Clock {
+public:
+  explicit SimulatedClock(TimePoint start = TimePoint(),
+                          WallTimePoint wall_start =
+                              std::chrono::system_clock::now())
+      : start_(start), wall_start_(wall_start),
+        now_(start.time_since_epoch().count()) {}
+
+  TimePoint Now() const override { return TimePoint(Duration(now_.load())); }
+
+  WallTimePoint WallNow() const override {
+    using std::chrono::system_clock;
+    return wall_start_ +
+           std::chrono::duration_cast<system_clock::duration>(Now() - start_);
+  }
+
+  // never goes back, an earlier time is ignored
+  void AdvanceTo(TimePoint time) {
+    Duration::rep now = now_.load();
+    const Duration::rep target = time.time_since_epoch().count();
+    while (now < target && !now_.compare_exchange_weak(now, target)) {
+    }
+  }
+
+  void AdvanceBy(Duration duration) { AdvanceTo(Now() + duration); }
+
+private:
+  const TimePoint start_;
+  const WallTimePoint wall_start_;
+  std::atomic<Duration::rep> now_;
+};
+
+// clock used when none is given, the real one unless the process
+// is started with FISCRIPT_CLOCK=simulated (replays faster than real time)
+inline Clock &DefaultClock() {
+  static RealClock real;
+  static SimulatedClock simulated;
+
+  static Clock *clock = []() -> Clock * {
+    const char *name = std::getenv("FISCRIPT_CLOCK");
+    if (name != nullptr && std::strcmp(name, "simulated") == 0) {
+      return &simulated;
+    }
+    return &real;
+  }();
+
+  return *clock;
+}
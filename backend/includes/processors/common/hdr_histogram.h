@@ -0,0 +1,59 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+// lock free histogram of positive values (HDR style)
+//
+// values are counted in log linear buckets: each power of 2 is cut
+// in kSubBuckets / 2 buckets of the same width, so a value is known
+// with a relative error under 2 / kSubBuckets (~6%, reported values
+// are the top of their bucket) from 0 to UINT64_MAX, in a fixed array
+//
+// Record() is a few relaxed atomic adds, any thread can call it
+// the readers see a snapshot which can miss the values being recorded
+class HdrHistogram {
+public:
+  static constexpr int kSubBucketBits = 5;
+  static constexpr int kSubBuckets = 1 << kSubBucketBits;
+  static constexpr int kHalfSubBuckets = kSubBuckets / 2;
+  // values under kSubBuckets have their own bucket, then each
+  // shift of the value adds kHalfSubBuckets buckets
+  static constexpr int kBucketCount =
+      kSubBuckets + (64 - kSubBucketBits) * kHalfSubBuckets;
+
+  HdrHistogram();
+
+  HdrHistogram(const HdrHistogram &) = delete;
+  HdrHistogram &operator=(const HdrHistogram &) = delete;
+
+  void Record(uint64_t value);
+
+  uint64_t Count() const { return count_.load(std::memory_order_relaxed); }
+  // 0 when empty
+  uint64_t Min() const;
+  uint64_t Max() const { return max_.load(std::memory_order_relaxed); }
+  double Mean() const;
+
+  // smallest recorded value (top of its bucket) such that percent %
+  // of the values are at or under it, 0 when empty
+  uint64_t ValueAtPercentile(double percent) const;
+
+  // count, min, p50, p90, p99, p99.9 and max on one line
+  void Print(std::ostream &os, const std::string &name,
+             const std::string &unit) const;
+
+  static int BucketIndex(uint64_t value);
+  // highest value counted in the bucket
+  static uint64_t BucketTop(int index);
+
+private:
+  std::array<std::atomic<uint64_t>, kBucketCount> buckets_;
+  std::atomic<uint64_t> count_;
+  std::atomic<uint64_t> sum_;
+  std::atomic<uint64_t> min_;
+  std::atomic<uint64_t> max_;
+};
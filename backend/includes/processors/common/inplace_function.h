@@ -0,0 +1,151 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+// move only std::function with a fixed size inline buffer
+//
+// a callable fitting in Capacity bytes is stored inside the object
+// so building, moving and calling it never allocates
+// a bigger callable is moved to the heap once, when it is stored
+template <typename Signature, std::size_t Capacity = 64>
+class InplaceFunction;
+
+template <typename R, typename... Args, std::size_t Capacity>
+class InplaceFunction<R(Args...), Capacity> {
+public:
+  InplaceFunction() noexcept : ops_(nullptr) {}
+  InplaceFunction(std::nullptr_t) noexcept : ops_(nullptr) {}
+
+  template <typename F,
+            typename = std::enable_if_t<
+                !std::is_same<std::decay_t<F>, InplaceFunction>::value>>
+  InplaceFunction(F &&callable) : ops_(nullptr) {
+    Store(std::forward<F>(callable));
+  }
+
+  InplaceFunction(InplaceFunction &&other) noexcept : ops_(nullptr) {
+    MoveFrom(other);
+  }
+
+  InplaceFunction &operator=(InplaceFunction &&other) noexcept {
+    if (this != &other) {
+      Reset();
+      MoveFrom(other);
+    }
+    return *this;
+  }
+
+  InplaceFunction &operator=(std::nullptr_t) noexcept {
+    Reset();
+    return *this;
+  }
+
+  template <typename F,
+            typename = std::enable_if_t<
+                !std::is_same<std::decay_t<F>, InplaceFunction>::value>>
+  InplaceFunction &operator=(F &&callable) {
+    Reset();
+    Store(std::forward<F>(callable));
+    return *this;
+  }
+
+  InplaceFunction(const InplaceFunction &) = delete;
+  InplaceFunction &operator=(const InplaceFunction &) = delete;
+
+  ~InplaceFunction() { Reset(); }
+
+  explicit operator bool() const noexcept { return ops_ != nullptr; }
+
+  // like std::function, a mutable lambda can be called
+  R operator()(Args... args) const {
+    return ops_->invoke(storage_, std::forward<Args>(args)...);
+  }
+
+  // true when a callable of type F is stored without allocation
+  template <typename F> static constexpr bool StoredInline() {
+    return sizeof(F) <= Capacity &&
+           alignof(F) <= alignof(std::max_align_t) &&
+           std::is_nothrow_move_constructible<F>::value;
+  }
+
+private:
+  struct Ops {
+    R (*invoke)(void *storage, Args &&...args);
+    void (*move)(void *destination, void *source) noexcept;
+    void (*destroy)(void *storage) noexcept;
+  };
+
+  template <typename F> struct InlineOps {
+    static R Invoke(void *storage, Args &&...args) {
+      return (*static_cast<F *>(storage))(std::forward<Args>(args)...);
+    }
+    static void Move(void *destination, void *source) noexcept {
+      ::new (destination) F(std::move(*static_cast<F *>(source)));
+      static_cast<F *>(source)->~F();
+    }
+    static void Destroy(void *storage) noexcept {
+      static_cast<F *>(storage)->~F();
+    }
+    static constexpr Ops kOps = {&Invoke, &Move, &Destroy};
+  };
+
+  template <typename F> struct HeapOps {
+    static R Invoke(void *storage, Args &&...args) {
+      return (**static_cast<F **>(storage))(std::forward<Args>(args)...);
+    }
+    static void Move(void *destination, void *source) noexcept {
+      *static_cast<F **>(destination) = *static_cast<F **>(source);
+    }
+    static void Destroy(void *storage) noexcept {
+      delete *static_cast<F **>(storage);
+    }
+    static constexpr Ops kOps = {&Invoke, &Move, &Destroy};
+  };
+
+  template <typename F> void Store(F &&callable) {
+    using Callable = std::decay_t<F>;
+
+    if constexpr (std::is_pointer<Callable>::value ||
+                  std::is_member_pointer<Callable>::value) {
+      if (callable == nullptr) {
+        return;
+      }
+    }
+
+    if constexpr (StoredInline<Callable>()) {
+      ::new (static_cast<void *>(storage_))
+          Callable(std::forward<F>(callable));
+      ops_ = &InlineOps<Callable>::kOps;
+    } else {
+      *reinterpret_cast<Callable **>(storage_) =
+          new Callable(std::forward<F>(callable));
+      ops_ = &HeapOps<Callable>::kOps;
+    }
+  }
+
+  void MoveFrom(InplaceFunction &other) noexcept {
+    if (other.ops_ == nullptr) {
+      return;
+    }
+
+    other.ops_->move(storage_, other.storage_);
+    ops_ = other.ops_;
+    other.ops_ = nullptr;
+  }
+
+  void Reset() noexcept {
+    if (ops_ != nullptr) {
+      ops_->destroy(storage_);
+      ops_ = nullptr;
+    }
+  }
+
+  static_assert(Capacity >= sizeof(void *),
+                "InplaceFunction needs room for at least a pointer");
+
+  alignas(std::max_align_t) mutable unsigned char storage_[Capacity];
+  const Ops *ops_;
+};
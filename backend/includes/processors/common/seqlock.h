@@ -0,0 +1,62 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <type_traits>
+
+// latest value slot, one writer and any number of readers
+//
+// the writer never waits, a reader copies the value and retries
+// when a write overlapped its copy
+// the sequence is odd during a write and grows by 2 for each value
+// so a reader tells how many values it missed between two reads
+template <typename T> class SeqLock {
+  static_assert(std::is_trivially_copyable<T>::value,
+                "SeqLock copies its value with memcpy");
+
+public:
+  SeqLock() : sequence_(0), value_() {}
+
+  SeqLock(const SeqLock &) = delete;
+  SeqLock &operator=(const SeqLock &) = delete;
+
+  // only one thread at a time can store
+  void Store(const T &value) {
+    const uint64_t sequence = sequence_.load(std::memory_order_relaxed);
+    sequence_.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    std::memcpy(&value_, &value, sizeof(T));
+
+    sequence_.store(sequence + 2, std::memory_order_release);
+  }
+
+  // returns the sequence of the value copied, 0 when nothing was stored
+  uint64_t Load(T &value) const {
+    while (true) {
+      const uint64_t before = sequence_.load(std::memory_order_acquire);
+      if (before & 1) {
+        std::this_thread::yield();
+        continue;
+      }
+
+      std::memcpy(&value, &value_, sizeof(T));
+      std::atomic_thread_fence(std::memory_order_acquire);
+
+      if (sequence_.load(std::memory_order_relaxed) == before) {
+        return before;
+      }
+    }
+  }
+
+  // sequence of the last value stored
+  uint64_t Sequence() const {
+    return sequence_.load(std::memory_order_acquire) & ~uint64_t(1);
+  }
+
+private:
+  std::atomic<uint64_t> sequence_;
+  T value_;
+};
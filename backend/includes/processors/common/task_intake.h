@@ -0,0 +1,30 @@
+#pragma once
+
+#include <atomic>
+
+#include "processors/common/timer_queue.h"
+
+// lock free multi producer, single consumer intake of new timers
+//
+// any thread pushes with a CAS, without waiting for the timer thread
+// the timer thread takes every pushed task at once before each
+// deadline check (Treiber stack, reversed when taken)
+// tasks are chained through Task::next
+class TaskIntake {
+public:
+  TaskIntake() : head_(nullptr) {}
+
+  TaskIntake(const TaskIntake &) = delete;
+  TaskIntake &operator=(const TaskIntake &) = delete;
+
+  void Push(Task *task);
+
+  // tasks in push order, nullptr when empty
+  // only one thread at a time can take
+  Task *TakeAll();
+
+  bool Empty() const { return head_.load() == nullptr; }
+
+private:
+  std::atomic<Task *> head_;
+};
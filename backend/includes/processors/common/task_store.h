@@ -0,0 +1,68 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+#include "processors/common/timer_queue.h"
+
+// slab of Task used by the TimerManager
+//
+// tasks are allocated by chunks and recycled through a free list
+// so once the store has grown to the number of live timers
+// acquiring and releasing a task doesn't allocate
+// tasks keep their address until the store is destroyed
+//
+// the free list is lock free, any thread can create a timer without
+// waiting for the timer thread or a worker releasing a task
+// only growing the store takes a lock
+class TaskStore {
+public:
+  explicit TaskStore(std::size_t chunk_size = 256);
+  ~TaskStore();
+
+  TaskStore(const TaskStore &) = delete;
+  TaskStore &operator=(const TaskStore &) = delete;
+  TaskStore(TaskStore &&) = delete;
+  TaskStore &operator=(TaskStore &&) = delete;
+
+  Task *Acquire();
+
+  // destroys the callable of the task and recycles it
+  // the generation of the task changes, so its id becomes invalid
+  void Release(Task *task);
+
+  // id of an acquired task, valid until it is released
+  static TimerId Id(const Task *task) {
+    return (TimerId(Task::Generation(task->state.load())) << 32) |
+           task->index;
+  }
+
+  // task the id was given for, or nullptr when the id is invalid
+  // the task can be released right after, the caller has to check
+  // Task::state against the generation of the id
+  Task *Find(TimerId id) const;
+
+  std::size_t Capacity() const;
+  std::size_t InUse() const;
+
+private:
+  // chunk k holds chunk_size * 2^k tasks
+  static constexpr std::size_t kMaxChunks = 32;
+  static constexpr uint64_t kIndexMask = 0xffffffff;
+
+  Task *At(uint32_t index) const;
+  void Grow();
+
+  // index + 1 of the first free task, 0 when empty
+  // the upper bits count the updates so that a pop racing with
+  // a pop and a push of the same task fails (ABA)
+  std::atomic<uint64_t> free_head_;
+  std::array<std::atomic<Task *>, kMaxChunks> chunks_;
+  std::atomic<std::size_t> chunk_count_;
+  std::atomic<std::size_t> in_use_;
+  std::size_t chunk_size_;
+  std::mutex grow_mtx_;
+};
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "processors/common/inplace_function.h"
+
+// work stealing thread pool
+//
+// every worker owns a queue, a job submitted from a worker goes to its
+// own queue, otherwise the queues are picked round robin
+// an idle worker steals from the back of the other queues
+//
+// the destructor runs every job already submitted before joining
+// queues keep their memory once grown, so a job whose closure fits
+// in the Job buffer is submitted without allocation
+class ThreadPool {
+public:
+  using Job = InplaceFunction<void()>;
+
+  explicit ThreadPool(std::size_t thread_count);
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool &) = delete;
+  ThreadPool &operator=(const ThreadPool &) = delete;
+  ThreadPool(ThreadPool &&) = delete;
+  ThreadPool &operator=(ThreadPool &&) = delete;
+
+  void Submit(Job job);
+
+  std::size_t Size() const { return workers_.size(); }
+
+private:
+  // ring buffer, its size is a power of 2
+  struct WorkerQueue {
+    std::mutex mtx;
+    std::vector<Job> jobs;
+    std::size_t head = 0;
+    std::size_t count = 0;
+
+    void PushBack(Job job);
+    bool PopFront(Job &job);
+    bool PopBack(Job &job);
+  };
+
+  void Run(std::size_t index);
+  bool PopOwn(std::size_t index, Job &job);
+  bool Steal(std::size_t thief, Job &job);
+
+  std::vector<std::unique_ptr<WorkerQueue>> workers_;
+  std::vector<std::thread> threads_;
+  std::atomic<std::size_t> next_queue_;
+
+  // number of submitted jobs not yet taken by a worker
+  std::atomic<std::size_t> pending_;
+  bool stop_;
+  std::mutex idle_mtx_;
+  std::condition_variable idle_cond_var_;
+};
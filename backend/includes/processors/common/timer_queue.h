@@ -0,0 +1,151 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "processors/common/inplace_function.h"
+
+// handle of a timer, given by TimerManager::CreateTimer()
+// it holds the index of the task in the TaskStore and the generation
+// of the task, so an id of a finished timer never matches a new one
+using TimerId = uint64_t;
+constexpr TimerId kInvalidTimerId = 0;
+
+struct Task {
+  // closures bigger than this are moved to the heap when stored
+  static constexpr std::size_t kCallableSize = 64;
+  using Callable = InplaceFunction<void(), kCallableSize>;
+
+  // fires dispatched to the executor and not run yet
+  // the last fire of the timer also sets kLastFire
+  static constexpr uint32_t kLastFire = uint32_t(1) << 31;
+  static constexpr uint32_t kFireCountMask = kLastFire - 1;
+
+  // Task::state, the generation of the task is in the upper 32 bits
+  static constexpr uint64_t kCancelled = 1;
+  // the last fire was dispatched (or the task is free), the timer
+  // can't be cancelled or rescheduled anymore
+  static constexpr uint64_t kFinished = 2;
+
+  static uint32_t Generation(uint64_t state) {
+    return static_cast<uint32_t>(state >> 32);
+  }
+
+  Task()
+      : interval(0), repeat(0), pending_fires(0), state(0),
+        dispatched_due(0), index(0), version(0), free_next(0), next(nullptr),
+        prev(nullptr), wheel_slot(0) {}
+
+  Task(std::chrono::steady_clock::time_point time_to_run,
+       std::chrono::steady_clock::duration interval, Callable task,
+       int repeat)
+      : time_to_run(time_to_run), interval(interval), task(std::move(task)),
+        repeat(repeat), pending_fires(0), state(0), dispatched_due(0),
+        index(0), version(0), free_next(0), next(nullptr), prev(nullptr),
+        wheel_slot(0) {}
+
+  bool Cancelled() const { return (state.load() & kCancelled) != 0; }
+
+  std::chrono::steady_clock::time_point
+      time_to_run;                              // time for which the task need to be ran
+  std::chrono::steady_clock::duration interval; // when repeating
+  Callable task;                                // the lambda function needed
+  int repeat;                                   // -1 means indefinitly
+  std::atomic<uint32_t> pending_fires;
+
+  // generation and flags
+  // kCancelled and kFinished are set by the TimerManager with its mutex
+  // locked, the generation changes when the task is released so
+  // a Cancel() with an old id can't match the timer reusing it
+  std::atomic<uint64_t> state;
+
+  // deadline of the last fire given to the executor (time since epoch)
+  // the worker running it measures the lateness from it
+  std::atomic<int64_t> dispatched_due;
+
+  uint32_t index;   // position in the TaskStore
+  uint32_t version; // entries of an older version are stale
+  // index + 1 of the next free task in the TaskStore
+  std::atomic<uint32_t> free_next;
+
+  // intrusive links, used by the timing wheel slots
+  // and by the intake of the TimerManager (next only)
+  Task *next;
+  Task *prev;
+  uint16_t wheel_slot; // level * slots per level + slot
+};
+
+// storage of the pending timers of a TimerManager
+// it is only accessed by the TimerManager with its mutex locked
+// so implementations don't need to be thread safe
+//
+// the queue doesn't own the tasks, and keeps its memory
+// once it has grown, so pushing and popping don't allocate
+class TimerQueue {
+public:
+  using TimePoint = std::chrono::steady_clock::time_point;
+
+  virtual ~TimerQueue() = default;
+
+  virtual void Push(Task *task) = 0;
+
+  // the task must be in the queue, PopExpired() won't return it anymore
+  // (the heap only forgets it, its entry is dropped when it expires)
+  virtual void Remove(Task *task) = 0;
+
+  virtual bool Empty() const = 0;
+  virtual std::size_t Size() const = 0;
+
+  // time at which the queue has work to do
+  // PopExpired() can return nothing at this time (for instance when
+  // the timing wheel only needs to cascade its upper levels)
+  virtual TimePoint NextDeadline() const = 0;
+
+  // appends to expired every task whose time_to_run is <= now
+  virtual void PopExpired(const TimePoint &now,
+                          std::vector<Task *> &expired) = 0;
+};
+
+// binary heap, O(log n) push and pop
+// deadlines are exact
+//
+// an entry keeps the deadline and the version of its task when it was
+// pushed, Remove() bumps the version so the entry is skipped later
+class HeapTimerQueue final : public TimerQueue {
+public:
+  HeapTimerQueue() : live_(0) {}
+
+  void Push(Task *task) override;
+  void Remove(Task *task) override;
+
+  bool Empty() const override { return live_ == 0; }
+  std::size_t Size() const override { return live_; }
+
+  TimePoint NextDeadline() const override;
+  void PopExpired(const TimePoint &now, std::vector<Task *> &expired) override;
+
+private:
+  struct Entry {
+    TimePoint time;
+    Task *task;
+    uint32_t version;
+  };
+
+  struct EntryCmp {
+    bool operator()(const Entry &e1, const Entry &e2) const {
+      return e1.time > e2.time;
+    }
+  };
+
+  static bool Stale(const Entry &entry) {
+    return entry.version != entry.task->version;
+  }
+
+  void PopFront();
+
+  std::vector<Entry> tasks_;
+  std::size_t live_;
+};
@@ -3,31 +3,67 @@
 #include <atomic>
 #include <chrono>
 #include <condition_variable>
-#include <functional>
 #include <memory>
 #include <mutex>
-#include <queue>
+#include <ostream>
 #include <thread>
+#include <utility>
 #include <vector>
 
-struct Task {
-  std::chrono::steady_clock::time_point
-      time_to_run;                    // time for which the task need to be ran
-  std::chrono::milliseconds interval; // when repeating
-  std::function<void()> task;         // the lambda function needed
-  int repeat;                         // -1 means indefinitly
+#include "processors/common/clock.h"
+#include "processors/common/hdr_histogram.h"
+#include "processors/common/task_intake.h"
+#include "processors/common/task_store.h"
+#include "processors/common/thread_pool.h"
+#include "processors/common/timer_queue.h"
+#include "processors/common/timing_wheel.h"
+
+enum class TimerBackend {
+  Heap,  // binary heap, exact deadlines, O(log n)
+  Wheel, // hierarchical timing wheel, deadlines rounded to a tick, O(1)
 };
 
-struct TimerCmp {
-  bool operator()(const std::shared_ptr<Task> &t1,
-                  const std::shared_ptr<Task> &t2) {
-    return t1->time_to_run > t2->time_to_run;
-  }
+enum class TimerWait {
+  Sleep,  // condition variable, tens of us of wake up jitter
+  Hybrid, // sleeps until spin_window before the deadline, then spins
+};
+
+struct TimerConfig {
+  TimerBackend backend = TimerBackend::Heap;
+  // only used by the timing wheel
+  // deadlines are rounded to it, so keep it small with TimerWait::Hybrid
+  std::chrono::microseconds wheel_tick{100};
+  // threads running the callbacks
+  // 0 runs them on the timer thread, one after the other
+  std::size_t worker_threads = 0;
+  // Hybrid keeps a core busy for spin_window before each deadline
+  TimerWait wait = TimerWait::Sleep;
+  std::chrono::microseconds spin_window{200};
+  // not owned, DefaultClock() when null
+  // with a SimulatedClock the wait mode is not used
+  Clock *clock = nullptr;
+  // two clock reads and a few atomic adds per fire
+  bool record_stats = true;
+  // also on when the process is started with FISCRIPT_TIMER_STATS set
+  bool dump_stats_at_exit = false;
+};
+
+// filled by the TimerManager for every fire
+struct TimerStats {
+  // ns between the time_to_run of the fire and the start of its callback
+  HdrHistogram lateness;
+  // ns taken by the callback
+  HdrHistogram run_time;
+  // timers in the queue at the deadline check which popped the fire
+  HdrHistogram queue_depth;
+
+  void Print(std::ostream &os) const;
 };
 
 class TimerManager {
 public:
   TimerManager();
+  explicit TimerManager(const TimerConfig &config);
   ~TimerManager();
 
   TimerManager(const TimerManager &) = delete;
@@ -35,11 +71,42 @@ public:
   TimerManager(TimerManager &&) = delete;
   TimerManager &operator=(TimerManager &&) = delete;
 
-  void CreateTimer(std::function<void()> task,
-                   const std::chrono::milliseconds &delay, int repeat_count);
+  // the task is stored in a Task of the TaskStore, a closure up to
+  // Task::kCallableSize bytes is stored inline, so creating and firing
+  // a timer doesn't allocate once the store has grown
+  //
+  // lock free, can be called from any thread (a callback too)
+  // the timer is handed to the timer thread through the intake
+  //
+  // the returned id can be given to Cancel() and Reschedule()
+  template <typename F>
+  TimerId CreateTimer(F &&task,
+                      const std::chrono::steady_clock::duration &delay,
+                      int repeat_count) {
+    Task *timer = store_.Acquire();
+    timer->task = std::forward<F>(task);
+
+    // before AddTimer(), the timer can be finished and reused
+    // as soon as it is pushed
+    const TimerId id = TaskStore::Id(timer);
+    AddTimer(timer, delay, repeat_count);
+    return id;
+  }
+
+  // the timer won't fire anymore (a fire already running or dispatched
+  // to the executor can still run), it stops counting as active right away
+  // returns false if the timer is already cancelled or finished
+  bool Cancel(TimerId id);
+
+  // the next fire of the timer happens after delay, then every delay
+  // the remaining repetitions are kept
+  // returns false if the timer is cancelled or finished
+  bool Reschedule(TimerId id,
+                  const std::chrono::steady_clock::duration &delay);
 
   // to use only if the thread is waiting for
   // a number of tasks to be finished (to wait for all timers rest = 0)
+  // with a SimulatedClock, the time moves while a thread waits here
   // if you add others tasks during this waiting (even because of repeatition)
   // it will also wait for them to be finished
   // so it will wait until GetActiveTimerCount()
@@ -56,39 +123,89 @@ public:
     return timer_count_;
   }
 
+  // can be read while the timers run
+  const TimerStats &GetStats() const { return stats_; }
+  void DumpStats(std::ostream &os) const;
+
 private:
   void Run();
-
-  using TaskPtr = std::shared_ptr<Task>;
-  std::priority_queue<TaskPtr, std::vector<TaskPtr>, TimerCmp> tasks_to_do_;
-
-  // lock mutex before calling Push or Pop
-  void inline PushTask(const std::chrono::steady_clock::time_point &time_to_run,
-                       const std::chrono::milliseconds &interval,
-                       const std::function<void()> &task, int repeat) {
-    PushTaskPtr(
-        std::make_shared<Task>(Task{time_to_run, interval, task, repeat}));
-  }
-
-  void inline PushTaskPtr(const TaskPtr& task) {
-    tasks_to_do_.push(task);
+  void AddTimer(Task *timer,
+                const std::chrono::steady_clock::duration &delay,
+                int repeat_count);
+  // runs on the executor, a timer is never run twice at the same time
+  void RunSerialized(Task *job);
+  // called with the lock held, the task is cancelled
+  // and its entry has just been popped
+  void DropCancelled(Task *job);
+  // called with the lock held, task of id which can still fire
+  Task *FindPending(TimerId id);
+  // called with the lock held, moves the new timers to the queue
+  void DrainIntake();
+  // waits until deadline, a new timer or a stop
+  void Sleep(std::unique_lock<std::mutex> &lock,
+             const TimerQueue::TimePoint &deadline);
+  // busy waits until deadline, a new timer, a Reschedule() or a stop
+  void Spin(std::unique_lock<std::mutex> &lock,
+            const TimerQueue::TimePoint &deadline);
+  // moves the simulated clock to deadline when nothing can still
+  // create a timer at the current time, otherwise waits for it
+  void Advance(std::unique_lock<std::mutex> &lock,
+               const TimerQueue::TimePoint &deadline);
+  // called by the executor once a dispatched fire has run
+  void FireDone();
+  // runs the callback of job, due is the deadline of the fire
+  void Fire(Task *job, const TimerQueue::TimePoint &due);
+
+  TaskStore store_;
+  TaskIntake intake_;
+  std::unique_ptr<TimerQueue> tasks_to_do_;
+
+  // lock mutex before calling Push
+  void inline PushTaskPtr(Task *task) {
+    tasks_to_do_->Push(task);
     timer_count_++;
   }
 
-  void inline PopTask() {
-    if (tasks_to_do_.empty())
-      return;
-
-    tasks_to_do_.pop();
-  }
-
   bool stop_;
   std::thread worker_;
   std::mutex timer_mtx_;
   std::condition_variable cond_var_;
   std::condition_variable wait_cond_var_;
+  // set by the timer thread while it waits
+  std::atomic<bool> sleeping_;
+  // ends a Spin(), the deadline may have changed
+  std::atomic<bool> interrupt_spin_;
+
+  TimerWait wait_;
+  std::chrono::microseconds spin_window_;
+
+  Clock *clock_;
+  // null with a real clock
+  SimulatedClock *simulated_clock_;
+  // threads in WaitTillLast()
+  int waiters_;
+  // fires submitted to the executor and not done
+  std::atomic<uint32_t> in_flight_;
+
+  // null when the callbacks are run by the timer thread
+  std::unique_ptr<ThreadPool> executor_;
+
+  // tasks fired by the last deadline check
+  std::vector<Task *> expired_;
+  struct Fired {
+    Task *task;
+    // the last repetition of the task
+    bool last;
+    TimerQueue::TimePoint due;
+  };
+  std::vector<Fired> batch_;
+
+  TimerStats stats_;
+  bool record_stats_;
+  bool dump_stats_at_exit_;
 
   std::atomic<unsigned long long> active_timer_count_;
-  unsigned long long timer_count_;
+  // counts the creations and the repetitions
+  std::atomic<unsigned long long> timer_count_;
   unsigned long long timer_limit_;
 };
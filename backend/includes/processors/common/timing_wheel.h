@@ -0,0 +1,106 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+#include "processors/common/timer_queue.h"
+
+// hierarchical timing wheel (Varghese & Lauck)
+//
+// time is cut in ticks, a task is stored in the slot of the tick
+// it expires in, so push and expiry are O(1)
+// level 0 has one slot per tick, each slot of level N covers a full
+// rotation of level N - 1, when the wheel reaches a slot of an upper
+// level its tasks are cascaded down to the lower levels
+//
+// deadlines are rounded up to the next tick, all the tasks sharing
+// a tick are returned together by PopExpired()
+// slots are intrusive lists chained through Task::next and Task::prev
+// so the wheel never allocates and Remove() is O(1)
+class TimingWheel final : public TimerQueue {
+public:
+  explicit TimingWheel(std::chrono::steady_clock::duration tick,
+                       TimePoint origin = std::chrono::steady_clock::now());
+
+  void Push(Task *task) override;
+  void Remove(Task *task) override;
+
+  bool Empty() const override { return size_ == 0; }
+  std::size_t Size() const override { return size_; }
+
+  TimePoint NextDeadline() const override;
+  void PopExpired(const TimePoint &now, std::vector<Task *> &expired) override;
+
+private:
+  static constexpr int kLevelBits = 6;
+  static constexpr int kLevels = 6;
+  static constexpr int kSlotsPerLevel = 1 << kLevelBits;
+  static constexpr uint64_t kSlotMask = kSlotsPerLevel - 1;
+  // the wheel covers 2^36 ticks (~79 days with 100us ticks)
+  // tasks further away wait in overflow_ until the next rotation
+  static constexpr uint64_t kRotationMask =
+      (uint64_t(1) << (kLevelBits * kLevels)) - 1;
+  static constexpr uint64_t kNoTick = UINT64_MAX;
+  // Task::wheel_slot of the tasks in overflow_
+  static constexpr uint16_t kOverflowSlot = kLevels * kSlotsPerLevel;
+
+  // tasks in insertion order
+  struct Slot {
+    Task *head = nullptr;
+    Task *tail = nullptr;
+
+    void Append(Task *task) {
+      task->next = nullptr;
+      task->prev = tail;
+      if (tail == nullptr) {
+        head = task;
+      } else {
+        tail->next = task;
+      }
+      tail = task;
+    }
+
+    void Unlink(Task *task) {
+      if (task->prev == nullptr) {
+        head = task->next;
+      } else {
+        task->prev->next = task->next;
+      }
+
+      if (task->next == nullptr) {
+        tail = task->prev;
+      } else {
+        task->next->prev = task->prev;
+      }
+
+      task->next = nullptr;
+      task->prev = nullptr;
+    }
+
+    Task *Detach() {
+      Task *first = head;
+      head = nullptr;
+      tail = nullptr;
+      return first;
+    }
+  };
+
+  uint64_t ExpiryTick(const TimePoint &time) const;
+  void Insert(Task *task, uint64_t expiry_tick);
+  void InsertAll(Task *first);
+  // first tick at which a slot needs to be fired or cascaded
+  uint64_t NextEventTick() const;
+  void Cascade(uint64_t tick);
+
+  std::array<std::array<Slot, kSlotsPerLevel>, kLevels> slots_;
+  // one bit per non empty slot, for each level
+  std::array<uint64_t, kLevels> occupied_{};
+  Slot overflow_;
+
+  std::chrono::steady_clock::duration tick_;
+  TimePoint origin_;
+  uint64_t current_tick_;
+  std::size_t size_;
+};
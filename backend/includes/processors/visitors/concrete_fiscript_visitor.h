@@ -21,6 +21,10 @@ private:
 
   virtual std::any visitSchedule(FiScriptParser::ScheduleContext *context);
 
+  virtual std::any visitCancel(FiScriptParser::CancelContext *context);
+
+  virtual std::any visitReschedule(FiScriptParser::RescheduleContext *context);
+
   virtual std::any visitReacton(FiScriptParser::ReactonContext *context);
 
   virtual std::any visitPrint(FiScriptParser::PrintContext *context);
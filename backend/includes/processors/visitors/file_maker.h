@@ -2,6 +2,7 @@
 
 #include <list>
 #include <map>
+#include <set>
 #include <string>
 #include <unordered_set>
 #include <utility>
@@ -26,6 +27,8 @@ private:
   void BuildOutput();
 
   bool MakeScheduleCommand(const Command &command);
+  bool MakeCancelCommand(const Command &command);
+  bool MakeRescheduleCommand(const Command &command);
   bool MakePrintCommand(const Command &command);
   bool MakeAlertCommand(const Command &command);
   bool MakeReactOnCommand(const Command &command);
@@ -35,6 +38,7 @@ private:
   bool MakeVariableAssignment(const Command &command);
 
   void AddTimerManager(const Command &command);
+  void DeclareTimerHandle(const std::string &name);
   void AddReactOnService(const Command &command);
   void AddAlertService(const Command &command);
 
@@ -57,6 +61,10 @@ private:
     }
   }
 
+  // file used by an included header, it is copied
+  // in the generated project but not included in main.cc
+  inline void AddDependency(const std::string &name) { includes_.insert(name); }
+
   void SetGRPC();
   void SetScriptInfo(const std::string &username,
                      const std::string &script_title);
@@ -69,6 +77,9 @@ private:
   std::unordered_set<Command::CommandType> history_;
   std::unordered_set<Command::CommandType> active_managers_;
   std::map<std::string, VariableType> variable_types_;
+  // names given to timers, declared once in main
+  // and captured by reference by every lambda
+  std::set<std::string> timer_handles_;
   std::string output_;
   bool compiled_;
   long tab_to_add_;
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <sys/types.h>
+
+// market data broadcast ring in shared memory (/dev/shm)
+//
+// the distributor writes every tick once, any number of scripts on the
+// same host read it without a syscall, gRPC or a decode
+// one writer, readers never slow it down: a reader which is lapped
+// jumps to the newest tick and counts the ones it lost
+// each slot is guarded by its own sequence (a seqlock), a reader copies
+// the record and checks that the slot was not rewritten meanwhile
+// a transport, not zero-copy: the writer may rewrite a slot at any
+// time, so a record is only used once copied out of the ring
+
+constexpr const char *kMarketDataRingName = "/fiscript_market_data";
+
+// same fields as the MarketDataPoint of the distributor
+struct MarketDataRecord {
+  double price;
+  int64_t quantity;
+  int64_t timestamp_seconds;
+  int32_t timestamp_nanos;
+  char instrument_id[32];
+};
+
+struct MarketDataRingHeader {
+  uint64_t magic;
+  uint32_t version;
+  // power of 2
+  uint32_t capacity;
+  pid_t writer_pid;
+  // set when the writer is destroyed
+  std::atomic<uint32_t> closed;
+
+  // sequence of the next record written
+  alignas(64) std::atomic<uint64_t> write_sequence;
+};
+
+struct alignas(64) MarketDataRingSlot {
+  // 2 * (n + 1) once record n is written, odd while it is written
+  std::atomic<uint64_t> sequence;
+  MarketDataRecord record;
+};
+
+class MarketDataRingWriter {
+public:
+  static constexpr uint32_t kDefaultCapacity = 1 << 16;
+
+  MarketDataRingWriter();
+  // marks the ring closed and removes it
+  ~MarketDataRingWriter();
+
+  MarketDataRingWriter(const MarketDataRingWriter &) = delete;
+  MarketDataRingWriter &operator=(const MarketDataRingWriter &) = delete;
+
+  // replaces a ring left with the same name
+  // capacity is rounded up to a power of 2
+  bool Create(const std::string &name, uint32_t capacity = kDefaultCapacity);
+
+  // only one thread at a time can publish
+  void Publish(const MarketDataRecord &record);
+
+  bool IsOpen() const { return header_ != nullptr; }
+
+private:
+  std::string name_;
+  void *memory_;
+  std::size_t size_;
+  MarketDataRingHeader *header_;
+  MarketDataRingSlot *slots_;
+  uint64_t mask_;
+  uint64_t next_;
+};
+
+class MarketDataRingReader {
+public:
+  MarketDataRingReader();
+  ~MarketDataRingReader();
+
+  MarketDataRingReader(const MarketDataRingReader &) = delete;
+  MarketDataRingReader &operator=(const MarketDataRingReader &) = delete;
+
+  // false when there is no ring or its writer is gone
+  // reading starts at the next record written
+  bool Open(const std::string &name);
+
+  // copies the next record, false when none was written yet
+  bool Poll(MarketDataRecord &record);
+
+  // a syscall, to call when Poll() keeps returning false
+  bool WriterAlive() const;
+
+  // records overwritten before this reader got to them
+  uint64_t LostCount() const { return lost_; }
+
+private:
+  // after a lap, reading goes on from the newest record
+  void Resync();
+
+  void *memory_;
+  std::size_t size_;
+  const MarketDataRingHeader *header_;
+  const MarketDataRingSlot *slots_;
+  uint64_t mask_;
+  uint64_t next_;
+  uint64_t lost_;
+};
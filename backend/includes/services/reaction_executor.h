@@ -0,0 +1,88 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+
+#include "messages/price_update.pb.h"
+#include "processors/common/seqlock.h"
+#include "processors/common/thread_pool.h"
+
+struct Reaction;
+
+// trivially copyable part of a PriceUpdate, the instrument id is the
+// one of the reaction
+struct PriceSnapshot {
+  double price = 0.0;
+  int64_t quantity = 0;
+  int64_t timestamp_seconds = 0;
+  int32_t timestamp_nanos = 0;
+};
+
+// ticks of a reaction waiting for its callback
+struct ReactionStrand {
+  std::mutex mtx;
+  // in arrival order, ReactionMode::Queue
+  std::deque<internal::PriceUpdate> updates;
+  // ReactionMode::Conflate, written by the stream reader
+  SeqLock<PriceSnapshot> latest;
+  // sequence of the last value given to the callback, worker only
+  uint64_t consumed_sequence = 0;
+  // a job of the pool runs (or will run) the updates
+  bool scheduled = false;
+};
+
+// runs the callbacks of the reactions on a thread pool
+//
+// every reaction has a strand: at most one worker runs its ticks at a
+// time, in arrival order, so a slow reaction only delays itself
+// a worker hands the strand back to the pool after kStrandBatch ticks,
+// a busy reaction doesn't keep a worker while others wait
+// a conflating reaction only keeps the latest tick, the ones overwritten
+// before its callback was free are counted in conflated_count
+class ReactionExecutor {
+public:
+  static constexpr int kStrandBatch = 16;
+
+  // called by the worker after each callback
+  using AfterRun = std::function<void(Reaction &reaction)>;
+
+  ReactionExecutor(std::size_t thread_count, AfterRun after_run);
+  // runs the ticks already posted
+  ~ReactionExecutor() = default;
+
+  ReactionExecutor(const ReactionExecutor &) = delete;
+  ReactionExecutor &operator=(const ReactionExecutor &) = delete;
+  ReactionExecutor(ReactionExecutor &&) = delete;
+  ReactionExecutor &operator=(ReactionExecutor &&) = delete;
+
+  // copies the update in the strand of the reaction
+  // only the stream reader posts
+  void Post(Reaction &reaction, const internal::PriceUpdate &update);
+
+  // returns once every posted tick has run
+  // ticks posted by the callbacks meanwhile are waited for too
+  void WaitIdle();
+
+  std::size_t Size() const { return pool_.Size(); }
+
+private:
+  void RunStrand(Reaction *reaction);
+  // next tick of the strand, false (and the strand is not scheduled
+  // anymore) when there is none
+  bool Take(Reaction &reaction, internal::PriceUpdate &update);
+
+  AfterRun after_run_;
+
+  // strands with a job in the pool
+  int busy_strands_;
+  std::mutex idle_mtx_;
+  std::condition_variable idle_cond_var_;
+
+  // last, its destructor runs the queued jobs which use the members above
+  ThreadPool pool_;
+};
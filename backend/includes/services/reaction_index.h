@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+struct Reaction;
+
+// reactions of the ReactOnService grouped by instrument
+//
+// built when a reaction is registered, then only read by the stream
+// reader, so a tick costs one lookup whatever the number of reactions
+// the instrument ids are interned in a flat open addressing table
+// (linear probing, at most half full), each of them points to its
+// range of a single array holding every reaction
+class ReactionIndex {
+public:
+  struct Range {
+    Reaction *const *first = nullptr;
+    Reaction *const *last = nullptr;
+
+    Reaction *const *begin() const { return first; }
+    Reaction *const *end() const { return last; }
+    bool empty() const { return first == last; }
+  };
+
+  ReactionIndex() = default;
+  explicit ReactionIndex(
+      const std::vector<std::shared_ptr<Reaction>> &reactions);
+
+  // reactions of the instrument in registration order
+  // empty when no reaction watches it
+  Range Find(std::string_view instrument_id) const;
+
+  std::size_t InstrumentCount() const { return instrument_count_; }
+  // in order of first registration
+  const std::vector<std::string> &InstrumentIds() const {
+    return instrument_ids_;
+  }
+
+private:
+  struct Slot {
+    std::size_t hash = 0;
+    std::string instrument_id;
+    // range in reactions_, empty for a free slot
+    uint32_t begin = 0;
+    uint32_t end = 0;
+  };
+
+  // size is a power of 2
+  std::vector<Slot> slots_;
+  std::vector<Reaction *> reactions_;
+  std::vector<std::string> instrument_ids_;
+  std::size_t instrument_count_ = 0;
+};
@@ -1,30 +1,70 @@
 #pragma once
 
 #include <atomic>
+#include <chrono>
 #include <functional>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <thread>
 #include <vector>
 
 #include <grpcpp/grpcpp.h>
+#include "messages/market_data_request.pb.h"
 #include "messages/price_update.pb.h"
+#include "services/market_data_ring.h"
 #include "services/marketdata.grpc.pb.h"
+#include "services/reaction_executor.h"
+#include "services/reaction_index.h"
+
+enum class ReactionMode {
+  Queue,    // the callback sees every tick, a slow one builds a backlog
+  Conflate, // a busy callback only sees the latest tick once it is free
+};
 
 struct Reaction {
   std::string instrument_id;
   int max_count;
+  // callbacks done
   std::atomic<int> current_count;
   std::function<void(const internal::PriceUpdate &quote)> callback;
+  ReactionMode mode;
+
+  // ticks handed to the callback, only used by the stream reader
+  int posted_count;
+  ReactionStrand strand;
+  // ticks replaced by a newer one before the callback took them
+  std::atomic<long long> conflated_count;
 
   Reaction(const std::string &id, int max,
-           std::function<void(const internal::PriceUpdate &quote)> cb)
-      : instrument_id(id), max_count(max), current_count(0), callback(cb) {}
+           std::function<void(const internal::PriceUpdate &quote)> cb,
+           ReactionMode reaction_mode = ReactionMode::Queue)
+      : instrument_id(id), max_count(max), current_count(0), callback(cb),
+        mode(reaction_mode), posted_count(0), conflated_count(0) {}
+};
+
+enum class MarketDataTransport {
+  // the shared memory ring of the distributor when it runs on this host
+  // gRPC otherwise, or once the ring is closed
+  Auto,
+  Grpc,
+};
+
+struct ReactOnConfig {
+  // threads running the callbacks
+  // 0 runs them on the stream reader thread, one after the other
+  std::size_t worker_threads = 4;
+  // also Grpc when the process is started with FISCRIPT_MARKET_DATA=grpc
+  MarketDataTransport transport = MarketDataTransport::Auto;
+  // the ring reader spins that long after a tick, then sleeps between
+  // polls, a core is busy while it spins
+  std::chrono::microseconds ring_spin{100};
 };
 
 class ReactOnService {
 public:
   ReactOnService();
+  explicit ReactOnService(const ReactOnConfig &config);
   ~ReactOnService();
 
   ReactOnService(const ReactOnService &) = delete;
@@ -32,20 +72,65 @@ public:
   ReactOnService(ReactOnService &&) = delete;
   ReactOnService &operator=(ReactOnService &&) = delete;
 
+  // the reading starts at the first registration
+  // a gRPC stream only carries the registered instruments, a new
+  // instrument restarts it, the shared memory ring carries them all
+  // ReactionMode::Conflate needs the executor, without worker threads
+  // every tick is run anyway
   void RegisterReaction(
       const std::string &instrument_id, int max_count,
-      std::function<void(const internal::PriceUpdate &quote)> callback);
+      std::function<void(const internal::PriceUpdate &quote)> callback,
+      ReactionMode mode = ReactionMode::Queue);
 
+  // ticks skipped by the conflating reactions
+  long long GetConflatedCount();
+
+  // waits for the reader and the callbacks it handed to the executor
+  // returns right away when no reaction was registered
   void WaitForCompletion();
 
 private:
   void ReadMarketDataStream();
+  // returns when the reading is over or the distributor closed the ring
+  void ReadMarketDataRing(MarketDataRingReader &ring);
+  void ReadGrpcStream();
   bool ShouldStopReading();
+  // takes the index published by the last registration
+  void RefreshIndex();
+  // hands the update to the reactions of its instrument
+  void Dispatch(ReactionIndex::Range reactions,
+                const internal::PriceUpdate &update);
+  // called once the callback of reaction has run
+  void ReactionRan(Reaction &reaction);
+
+  MarketDataTransport transport_;
+  std::chrono::microseconds ring_spin_;
 
   std::shared_ptr<grpc::Channel> channel_;
   std::unique_ptr<internal::MarketDataService::Stub> stub_;
   std::thread reader_thread_;
   std::atomic<bool> stop_;
 
+  // registered reactions, they live as long as the service
   std::vector<std::shared_ptr<Reaction>> reactions_;
+  std::mutex reactions_mtx_;
+
+  // guarded by reactions_mtx_
+  bool reader_started_;
+  // context of the open stream, nullptr between two streams
+  grpc::ClientContext *context_;
+
+  // rebuilt for every registration, the reader takes the new one
+  // when index_version_ changes (std::atomic_load/store)
+  std::shared_ptr<const ReactionIndex> index_;
+  std::atomic<uint64_t> index_version_;
+  // reader side copy of index_
+  std::shared_ptr<const ReactionIndex> reader_index_;
+  uint64_t reader_version_;
+
+  // reactions which can still run, -1 ones are never done
+  std::atomic<int> pending_reactions_;
+
+  // null when the callbacks run on the reader thread
+  std::unique_ptr<ReactionExecutor> executor_;
 };
@@ -0,0 +1,3 @@
+// goal of this file is just to be copied by the python system builder
+// the clocks are header only, so the services can use them
+// without linking the processors
@@ -0,0 +1,103 @@
+#include "processors/common/hdr_histogram.h"
+
+#include <iomanip>
+
+HdrHistogram::HdrHistogram()
+    : count_(0), sum_(0), min_(UINT64_MAX), max_(0) {
+  for (auto &bucket : buckets_) {
+    bucket.store(0, std::memory_order_relaxed);
+  }
+}
+
+int HdrHistogram::BucketIndex(uint64_t value) {
+  if (value < kSubBuckets) {
+    return static_cast<int>(value);
+  }
+
+  // the value is sub << shift, sub in [kHalfSubBuckets, kSubBuckets)
+  const int magnitude = 63 - __builtin_clzll(value);
+  const int shift = magnitude - (kSubBucketBits - 1);
+  const int sub = static_cast<int>(value >> shift);
+  return shift * kHalfSubBuckets + sub;
+}
+
+uint64_t HdrHistogram::BucketTop(int index) {
+  if (index < kSubBuckets) {
+    return static_cast<uint64_t>(index);
+  }
+
+  const int shift = index / kHalfSubBuckets - 1;
+  const uint64_t sub = index % kHalfSubBuckets + kHalfSubBuckets;
+  // the top bucket ends at UINT64_MAX, no overflow
+  return (sub << shift) + ((uint64_t(1) << shift) - 1);
+}
+
+void HdrHistogram::Record(uint64_t value) {
+  buckets_[BucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+  count_.fetch_add(1, std::memory_order_relaxed);
+  sum_.fetch_add(value, std::memory_order_relaxed);
+
+  uint64_t min = min_.load(std::memory_order_relaxed);
+  while (value < min &&
+         !min_.compare_exchange_weak(min, value, std::memory_order_relaxed)) {
+  }
+
+  uint64_t max = max_.load(std::memory_order_relaxed);
+  while (value > max &&
+         !max_.compare_exchange_weak(max, value, std::memory_order_relaxed)) {
+  }
+}
+
+uint64_t HdrHistogram::Min() const {
+  const uint64_t min = min_.load(std::memory_order_relaxed);
+  return min == UINT64_MAX && Count() == 0 ? 0 : min;
+}
+
+double HdrHistogram::Mean() const {
+  const uint64_t count = Count();
+  if (count == 0) {
+    return 0.0;
+  }
+
+  return static_cast<double>(sum_.load(std::memory_order_relaxed)) /
+         static_cast<double>(count);
+}
+
+uint64_t HdrHistogram::ValueAtPercentile(double percent) const {
+  // the buckets are summed, count_ can be ahead of them
+  uint64_t total = 0;
+  for (const auto &bucket : buckets_) {
+    total += bucket.load(std::memory_order_relaxed);
+  }
+  if (total == 0) {
+    return 0;
+  }
+
+  uint64_t rank = static_cast<uint64_t>(percent / 100.0 *
+                                        static_cast<double>(total) + 0.5);
+  if (rank == 0) {
+    rank = 1;
+  }
+
+  uint64_t seen = 0;
+  for (int index = 0; index < kBucketCount; ++index) {
+    seen += buckets_[index].load(std::memory_order_relaxed);
+    if (seen >= rank) {
+      // the top of the last bucket can be above the real max
+      const uint64_t top = BucketTop(index);
+      const uint64_t max = Max();
+      return top < max ? top : max;
+    }
+  }
+
+  return Max();
+}
+
+void HdrHistogram::Print(std::ostream &os, const std::string &name,
+                         const std::string &unit) const {
+  os << std::left << std::setw(12) << name << std::right
+     << " count " << Count() << " min " << Min() << " p50 "
+     << ValueAtPercentile(50) << " p90 " << ValueAtPercentile(90) << " p99 "
+     << ValueAtPercentile(99) << " p99.9 " << ValueAtPercentile(99.9)
+     << " max " << Max() << " (" << unit << ")" << std::endl;
+}
@@ -0,0 +1,2 @@
+// goal of this file is just to be copied by the python system builder
+// InplaceFunction is a header only template
@@ -0,0 +1,25 @@
+#include "processors/common/task_intake.h"
+
+void TaskIntake::Push(Task *task) {
+  Task *head = head_.load(std::memory_order_relaxed);
+
+  // seq_cst, the TimerManager checks if the timer thread sleeps
+  // right after and the timer thread checks Empty() before sleeping
+  do {
+    task->next = head;
+  } while (!head_.compare_exchange_weak(head, task));
+}
+
+Task *TaskIntake::TakeAll() {
+  Task *last = head_.exchange(nullptr);
+
+  Task *first = nullptr;
+  while (last != nullptr) {
+    Task *next = last->next;
+    last->next = first;
+    first = last;
+    last = next;
+  }
+
+  return first;
+}
@@ -0,0 +1,136 @@
+#include "processors/common/task_store.h"
+
+#include <new>
+
+TaskStore::TaskStore(std::size_t chunk_size)
+    : free_head_(0), chunk_count_(0), in_use_(0),
+      chunk_size_(chunk_size == 0 ? 1 : chunk_size) {
+  for (auto &chunk : chunks_) {
+    chunk.store(nullptr);
+  }
+}
+
+TaskStore::~TaskStore() {
+  for (auto &chunk : chunks_) {
+    delete[] chunk.load();
+  }
+}
+
+Task *TaskStore::Acquire() {
+  uint64_t head = free_head_.load(std::memory_order_acquire);
+
+  while (true) {
+    if ((head & kIndexMask) == 0) {
+      Grow();
+      head = free_head_.load(std::memory_order_acquire);
+      continue;
+    }
+
+    Task *task = At(static_cast<uint32_t>(head & kIndexMask) - 1);
+    const uint64_t next = ((head >> 32) + 1) << 32 |
+                          task->free_next.load(std::memory_order_relaxed);
+
+    if (free_head_.compare_exchange_weak(head, next,
+                                         std::memory_order_acq_rel,
+                                         std::memory_order_acquire)) {
+      in_use_.fetch_add(1, std::memory_order_relaxed);
+      return task;
+    }
+  }
+}
+
+void TaskStore::Release(Task *task) {
+  task->task = nullptr;
+  task->pending_fires.store(0);
+
+  // a new generation, marked finished until the task is armed again
+  uint32_t generation = Task::Generation(task->state.load()) + 1;
+  if (generation == 0) {
+    generation = 1;
+  }
+  task->state.store(uint64_t(generation) << 32 | Task::kFinished);
+
+  uint64_t head = free_head_.load(std::memory_order_relaxed);
+  uint64_t next;
+  do {
+    task->free_next.store(static_cast<uint32_t>(head & kIndexMask),
+                          std::memory_order_relaxed);
+    next = ((head >> 32) + 1) << 32 | (uint64_t(task->index) + 1);
+  } while (!free_head_.compare_exchange_weak(head, next,
+                                             std::memory_order_release,
+                                             std::memory_order_relaxed));
+
+  in_use_.fetch_sub(1, std::memory_order_relaxed);
+}
+
+Task *TaskStore::Find(TimerId id) const {
+  const uint32_t index = static_cast<uint32_t>(id & kIndexMask);
+  const uint32_t generation = static_cast<uint32_t>(id >> 32);
+
+  if (generation == 0 || index >= Capacity()) {
+    return nullptr;
+  }
+
+  Task *task = At(index);
+  if (Task::Generation(task->state.load()) != generation) {
+    return nullptr;
+  }
+
+  return task;
+}
+
+std::size_t TaskStore::Capacity() const {
+  return chunk_size_ * ((std::size_t(1) << chunk_count_.load()) - 1);
+}
+
+std::size_t TaskStore::InUse() const { return in_use_.load(); }
+
+Task *TaskStore::At(uint32_t index) const {
+  // chunk k starts at chunk_size * (2^k - 1)
+  const uint64_t position = index / chunk_size_ + 1;
+  const int chunk = 63 - __builtin_clzll(position);
+  const std::size_t first = chunk_size_ * ((std::size_t(1) << chunk) - 1);
+
+  return &chunks_[chunk].load(std::memory_order_acquire)[index - first];
+}
+
+void TaskStore::Grow() {
+  std::unique_lock<std::mutex> lock(grow_mtx_);
+
+  // another thread has grown the store meanwhile
+  if ((free_head_.load(std::memory_order_acquire) & kIndexMask) != 0) {
+    return;
+  }
+
+  const std::size_t chunk = chunk_count_.load();
+  if (chunk == kMaxChunks) {
+    throw std::bad_alloc();
+  }
+
+  const std::size_t size = chunk_size_ << chunk;
+  const std::size_t first = chunk_size_ * ((std::size_t(1) << chunk) - 1);
+  Task *tasks = new Task[size];
+
+  for (std::size_t i = 0; i < size; i++) {
+    tasks[i].index = static_cast<uint32_t>(first + i);
+    // generation 0 is never used, so kInvalidTimerId matches no task
+    tasks[i].state.store(uint64_t(1) << 32 | Task::kFinished);
+    tasks[i].free_next.store(
+        i + 1 < size ? static_cast<uint32_t>(first + i + 2) : 0,
+        std::memory_order_relaxed);
+  }
+
+  chunks_[chunk].store(tasks, std::memory_order_release);
+  chunk_count_.store(chunk + 1);
+
+  // the whole chunk is pushed at once in front of the free list
+  uint64_t head = free_head_.load(std::memory_order_relaxed);
+  uint64_t next;
+  do {
+    tasks[size - 1].free_next.store(static_cast<uint32_t>(head & kIndexMask),
+                                    std::memory_order_relaxed);
+    next = ((head >> 32) + 1) << 32 | (uint64_t(first) + 1);
+  } while (!free_head_.compare_exchange_weak(head, next,
+                                             std::memory_order_release,
+                                             std::memory_order_relaxed));
+}
@@ -0,0 +1,149 @@
+#include "processors/common/thread_pool.h"
+
+namespace {
+
+// pool and index of the worker running on this thread
+// used to push the jobs submitted from a job in the local queue
+thread_local const ThreadPool *current_pool = nullptr;
+thread_local std::size_t current_index = 0;
+
+constexpr std::size_t kInitialQueueSize = 64;
+
+} // namespace
+
+void ThreadPool::WorkerQueue::PushBack(Job job) {
+  if (count == jobs.size()) {
+    std::vector<Job> grown(jobs.empty() ? kInitialQueueSize : jobs.size() * 2);
+    for (std::size_t i = 0; i < count; i++) {
+      grown[i] = std::move(jobs[(head + i) & (jobs.size() - 1)]);
+    }
+    jobs.swap(grown);
+    head = 0;
+  }
+
+  jobs[(head + count) & (jobs.size() - 1)] = std::move(job);
+  count++;
+}
+
+bool ThreadPool::WorkerQueue::PopFront(Job &job) {
+  if (count == 0) {
+    return false;
+  }
+
+  job = std::move(jobs[head]);
+  head = (head + 1) & (jobs.size() - 1);
+  count--;
+  return true;
+}
+
+bool ThreadPool::WorkerQueue::PopBack(Job &job) {
+  if (count == 0) {
+    return false;
+  }
+
+  count--;
+  job = std::move(jobs[(head + count) & (jobs.size() - 1)]);
+  return true;
+}
+
+ThreadPool::ThreadPool(std::size_t thread_count)
+    : next_queue_(0), pending_(0), stop_(false) {
+  if (thread_count == 0) {
+    thread_count = 1;
+  }
+
+  for (std::size_t i = 0; i < thread_count; i++) {
+    workers_.push_back(std::make_unique<WorkerQueue>());
+  }
+
+  for (std::size_t i = 0; i < thread_count; i++) {
+    threads_.emplace_back(&ThreadPool::Run, this, i);
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::unique_lock<std::mutex> lock(idle_mtx_);
+    stop_ = true;
+  }
+
+  idle_cond_var_.notify_all();
+
+  for (auto &thread : threads_) {
+    thread.join();
+  }
+}
+
+void ThreadPool::Submit(Job job) {
+  std::size_t index;
+  if (current_pool == this) {
+    index = current_index;
+  } else {
+    index = next_queue_.fetch_add(1, std::memory_order_relaxed) %
+            workers_.size();
+  }
+
+  {
+    std::unique_lock<std::mutex> lock(workers_[index]->mtx);
+    workers_[index]->PushBack(std::move(job));
+  }
+
+  pending_.fetch_add(1);
+
+  // empty critical section, a worker checking pending_
+  // before going to sleep cannot miss this notification
+  { std::unique_lock<std::mutex> lock(idle_mtx_); }
+  idle_cond_var_.notify_one();
+}
+
+bool ThreadPool::PopOwn(std::size_t index, Job &job) {
+  WorkerQueue &queue = *workers_[index];
+  std::unique_lock<std::mutex> lock(queue.mtx);
+
+  // FIFO for the owner, so that the jobs run in the order they expired
+  return queue.PopFront(job);
+}
+
+bool ThreadPool::Steal(std::size_t thief, Job &job) {
+  const std::size_t count = workers_.size();
+
+  for (std::size_t offset = 1; offset < count; offset++) {
+    WorkerQueue &queue = *workers_[(thief + offset) % count];
+    std::unique_lock<std::mutex> lock(queue.mtx, std::try_to_lock);
+
+    if (lock.owns_lock() && queue.PopBack(job)) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+void ThreadPool::Run(std::size_t index) {
+  current_pool = this;
+  current_index = index;
+
+  Job job;
+
+  while (true) {
+    if (PopOwn(index, job) || Steal(index, job)) {
+      pending_.fetch_sub(1);
+      job();
+      job = nullptr;
+      continue;
+    }
+
+    std::unique_lock<std::mutex> lock(idle_mtx_);
+
+    // a steal can fail on a busy queue, so pending_ is the reference
+    if (pending_.load() > 0) {
+      continue;
+    }
+
+    if (stop_) {
+      return;
+    }
+
+    idle_cond_var_.wait(lock, [this]() { return stop_ || pending_.load() > 0; });
+  }
+}
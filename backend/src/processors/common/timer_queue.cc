@@ -0,0 +1,50 @@
+#include "processors/common/timer_queue.h"
+
+#include <algorithm>
+
+void HeapTimerQueue::Push(Task *task) {
+  tasks_.push_back({task->time_to_run, task, task->version});
+  std::push_heap(tasks_.begin(), tasks_.end(), EntryCmp());
+  live_++;
+}
+
+void HeapTimerQueue::Remove(Task *task) {
+  task->version++;
+  live_--;
+
+  // nothing left but stale entries
+  if (live_ == 0) {
+    tasks_.clear();
+  }
+}
+
+TimerQueue::TimePoint HeapTimerQueue::NextDeadline() const {
+  if (tasks_.empty()) {
+    return TimePoint::max();
+  }
+
+  // can be the deadline of a stale entry, the caller
+  // just wakes up for nothing
+  return tasks_.front().time;
+}
+
+void HeapTimerQueue::PopExpired(const TimePoint &now,
+                                std::vector<Task *> &expired) {
+  while (!tasks_.empty() && tasks_.front().time <= now) {
+    if (!Stale(tasks_.front())) {
+      expired.push_back(tasks_.front().task);
+      live_--;
+    }
+    PopFront();
+  }
+
+  // so that NextDeadline() is a live one when possible
+  while (!tasks_.empty() && Stale(tasks_.front())) {
+    PopFront();
+  }
+}
+
+void HeapTimerQueue::PopFront() {
+  std::pop_heap(tasks_.begin(), tasks_.end(), EntryCmp());
+  tasks_.pop_back();
+}
@@ -1,9 +1,49 @@
 #include "processors/common/timers.h"
 #include <chrono>
+#include <cstdlib>
 #include <iostream>
 
-TimerManager::TimerManager() {
+namespace {
+
+// tells the cpu we are spinning (less power, and the other
+// hyperthread of the core gets the pipeline)
+inline void CpuRelax() {
+#if defined(__x86_64__) || defined(__i386__)
+  __builtin_ia32_pause();
+#elif defined(__aarch64__)
+  asm volatile("yield");
+#endif
+}
+
+} // namespace
+
+TimerManager::TimerManager() : TimerManager(TimerConfig()) {}
+
+TimerManager::TimerManager(const TimerConfig &config) {
+  clock_ = config.clock != nullptr ? config.clock : &DefaultClock();
+  simulated_clock_ = dynamic_cast<SimulatedClock *>(clock_);
+
+  if (config.backend == TimerBackend::Wheel) {
+    tasks_to_do_ =
+        std::make_unique<TimingWheel>(config.wheel_tick, clock_->Now());
+  } else {
+    tasks_to_do_ = std::make_unique<HeapTimerQueue>();
+  }
+
+  if (config.worker_threads > 0) {
+    executor_ = std::make_unique<ThreadPool>(config.worker_threads);
+  }
+
   stop_ = false;
+  sleeping_ = false;
+  interrupt_spin_ = false;
+  wait_ = config.wait;
+  spin_window_ = config.spin_window;
+  waiters_ = 0;
+  in_flight_ = 0;
+  record_stats_ = config.record_stats;
+  dump_stats_at_exit_ = config.dump_stats_at_exit ||
+                        std::getenv("FISCRIPT_TIMER_STATS") != nullptr;
   active_timer_count_ = 0;
   timer_count_ = 0;
   timer_limit_ = 100;
@@ -14,76 +54,370 @@ TimerManager::~TimerManager() {
   {
     std::unique_lock<std::mutex> lock(timer_mtx_);
     stop_ = true;
+    interrupt_spin_ = true;
   }
 
   cond_var_.notify_one();
   worker_.join();
+
+  // runs the fires already dispatched
+  executor_.reset();
+
+  if (dump_stats_at_exit_) {
+    DumpStats(std::cout);
+  }
 }
 
-void TimerManager::CreateTimer(std::function<void()> task,
-                               const std::chrono::milliseconds &delay,
-                               int repeat_count) {
-  std::unique_lock<std::mutex> lock(timer_mtx_);
+void TimerStats::Print(std::ostream &os) const {
+  lateness.Print(os, "lateness", "ns");
+  run_time.Print(os, "run time", "ns");
+  queue_depth.Print(os, "queue depth", "timers");
+}
+
+void TimerManager::DumpStats(std::ostream &os) const {
+  os << "timer stats" << std::endl;
+  stats_.Print(os);
+}
+
+void TimerManager::AddTimer(Task *timer,
+                            const std::chrono::steady_clock::duration &delay,
+                            int repeat_count) {
+  timer->interval = delay;
+  timer->repeat = repeat_count;
+  timer->time_to_run = clock_->Now() + delay;
 
-  PushTask(std::chrono::steady_clock::now() + delay, delay, task, repeat_count);
+  // armed, with the generation given when it was released
+  timer->state.store(uint64_t(Task::Generation(timer->state.load())) << 32);
+
+  // before the push, the timer can fire and finish right after it
   active_timer_count_++;
+  timer_count_++;
+  intake_.Push(timer);
+
+  // only the first producer seeing the timer thread asleep wakes it
+  if (sleeping_.load() && sleeping_.exchange(false)) {
+    // the timer thread holds the lock until it waits
+    // so the notification can't be lost
+    { std::unique_lock<std::mutex> lock(timer_mtx_); }
+    cond_var_.notify_one();
+  }
+}
+
+bool TimerManager::Cancel(TimerId id) {
+  std::unique_lock<std::mutex> lock(timer_mtx_);
+
+  Task *task = FindPending(id);
+  if (task == nullptr) {
+    return false;
+  }
+
+  // the entry stays in the queue until it expires
+  task->state.fetch_or(Task::kCancelled);
+  active_timer_count_--;
+  wait_cond_var_.notify_all();
+  return true;
+}
+
+bool TimerManager::Reschedule(
+    TimerId id, const std::chrono::steady_clock::duration &delay) {
+  std::unique_lock<std::mutex> lock(timer_mtx_);
+
+  // the timer can still be in the intake
+  DrainIntake();
+
+  Task *task = FindPending(id);
+  if (task == nullptr) {
+    return false;
+  }
+
+  tasks_to_do_->Remove(task);
+  task->interval = delay;
+  task->time_to_run = clock_->Now() + delay;
+  PushTaskPtr(task);
+  interrupt_spin_ = true;
   lock.unlock();
   cond_var_.notify_one();
+  return true;
+}
+
+Task *TimerManager::FindPending(TimerId id) {
+  Task *task = store_.Find(id);
+
+  // armed with the generation of the id, neither cancelled nor finished
+  // such a task is in the queue or in the intake, and only changes
+  // with the lock held (a task is released once finished only)
+  if (task == nullptr || task->state.load() != (id >> 32) << 32) {
+    return nullptr;
+  }
+
+  return task;
+}
+
+void TimerManager::DrainIntake() {
+  Task *task = intake_.TakeAll();
+
+  while (task != nullptr) {
+    // the queue can use the link
+    Task *next = task->next;
+    // already counted by AddTimer()
+    tasks_to_do_->Push(task);
+    task = next;
+  }
+}
+
+void TimerManager::Sleep(std::unique_lock<std::mutex> &lock,
+                         const TimerQueue::TimePoint &deadline) {
+  auto wake_up = deadline;
+
+  // the condition variable wakes up late, so it is only used
+  // until a bit before the deadline
+  if (wait_ == TimerWait::Hybrid && deadline != TimerQueue::TimePoint::max()) {
+    wake_up = deadline - spin_window_;
+    if (clock_->Now() >= wake_up) {
+      Spin(lock, deadline);
+      return;
+    }
+  }
+
+  sleeping_ = true;
+
+  // a producer which has seen sleeping_ false pushed before,
+  // so its timer is seen here
+  if (intake_.Empty() && !stop_) {
+    if (wake_up == TimerQueue::TimePoint::max()) {
+      cond_var_.wait(lock);
+    } else {
+      cond_var_.wait_until(lock, wake_up);
+    }
+  }
+
+  sleeping_ = false;
+}
+
+void TimerManager::Spin(std::unique_lock<std::mutex> &lock,
+                        const TimerQueue::TimePoint &deadline) {
+  // set with the lock held, anything changing the deadline after
+  // this point sets it again
+  interrupt_spin_ = false;
+
+  // unlocked, so producers, Cancel() and Reschedule() don't wait
+  lock.unlock();
+  while (clock_->Now() < deadline && intake_.Empty() &&
+         !interrupt_spin_.load(std::memory_order_relaxed)) {
+    CpuRelax();
+  }
+  lock.lock();
+}
+
+void TimerManager::Advance(std::unique_lock<std::mutex> &lock,
+                           const TimerQueue::TimePoint &deadline) {
+  // a thread creating timers outside of WaitTillLast() or a running
+  // callback would create them at a time depending on the scheduling
+  if (waiters_ > 0 && in_flight_ == 0 && intake_.Empty()) {
+    simulated_clock_->AdvanceTo(deadline);
+    return;
+  }
+
+  // woken by WaitTillLast(), FireDone() or a new timer
+  Sleep(lock, TimerQueue::TimePoint::max());
+}
+
+void TimerManager::FireDone() {
+  if (in_flight_.fetch_sub(1) != 1 || simulated_clock_ == nullptr) {
+    return;
+  }
+
+  // the timer thread checks in_flight_ with the lock held
+  // before it waits, so the notification can't be lost
+  { std::unique_lock<std::mutex> lock(timer_mtx_); }
+  cond_var_.notify_one();
 }
 
 void TimerManager::WaitTillLast(long long rest) {
   std::unique_lock<std::mutex> lock(timer_mtx_);
 
+  // lets a simulated clock move
+  waiters_++;
+  if (simulated_clock_ != nullptr) {
+    cond_var_.notify_one();
+  }
+
   while (active_timer_count_ > rest) {
     wait_cond_var_.wait(lock,
                         [this, rest]() { return active_timer_count_ <= rest; });
   }
+
+  waiters_--;
 }
 
 void TimerManager::Run() {
   std::unique_lock<std::mutex> lock(timer_mtx_);
 
   while (!stop_) {
-    if (tasks_to_do_.empty()) {
-      cond_var_.wait(lock, [this]() { return stop_ || !tasks_to_do_.empty(); });
+    // timers created since the last check
+    DrainIntake();
+
+    if (tasks_to_do_->Empty()) {
+      Sleep(lock, TimerQueue::TimePoint::max());
       continue;
     }
 
-    const auto now = std::chrono::steady_clock::now();
+    const auto now = clock_->Now();
+    const auto deadline = tasks_to_do_->NextDeadline();
 
-    if (now < tasks_to_do_.top()->time_to_run) {
-      cond_var_.wait_until(lock, tasks_to_do_.top()->time_to_run, [this]() {
-        return stop_ || std::chrono::steady_clock::now() >=
-                            tasks_to_do_.top()->time_to_run;
-      });
+    // a timer created while waiting can have
+    // an earlier deadline, so it is checked again
+    if (now < deadline) {
+      if (simulated_clock_ != nullptr) {
+        Advance(lock, deadline);
+      } else {
+        Sleep(lock, deadline);
+      }
       continue;
     }
 
-    const auto job = tasks_to_do_.top();
-    PopTask();
+    // every task sharing this deadline check is fired as one batch
+    const std::size_t depth = tasks_to_do_->Size();
+    tasks_to_do_->PopExpired(now, expired_);
+
+    for (Task *job : expired_) {
+      if (job->Cancelled()) {
+        DropCancelled(job);
+        continue;
+      }
+
+      if (record_stats_) {
+        stats_.queue_depth.Record(depth);
+      }
+
+      // time_to_run is moved by the repeat
+      const auto due = job->time_to_run;
+      bool repeated = false;
+
+      // push the repeat before doing the job
+      // because WaitTillFinished() can have spurious wake
+      // during execution of a repeating job
+      if (job->repeat == -1 || --job->repeat > 0) {
+        job->time_to_run += job->interval;
+        PushTaskPtr(job);
+        repeated = true;
+      } else {
+        job->state.fetch_or(Task::kFinished);
+      }
 
-    bool repeated = false;
+      if (executor_) {
+        // the timer thread only does the bookkeeping
+        // if the previous fire of this timer is still running
+        // the worker running it will also run this one
+        const uint32_t fire = repeated ? 1 : 1 + Task::kLastFire;
+        job->dispatched_due.store(due.time_since_epoch().count());
+        if ((job->pending_fires.fetch_add(fire) & Task::kFireCountMask) == 0) {
+          in_flight_++;
+          executor_->Submit([this, job]() {
+            RunSerialized(job);
+            FireDone();
+          });
+        }
+        continue;
+      }
 
-    // push the repeat before doing the job
-    // because WaitTillFinished() can have spurious wake
-    // during execution of a repeating job
-    if (job->repeat == -1 || --job->repeat > 0) {
-      job->time_to_run += job->interval;
-      PushTaskPtr(job);
-      repeated = true;
+      batch_.push_back({job, !repeated, due});
     }
+    expired_.clear();
 
-    // this is not correct
-    // we should create a new thread for each task being done
-    // because a task can take a long time to be done, so the other tasks
-    // might take a few time before being done
-    // should do it once the thread pool is done
+    if (batch_.empty()) {
+      continue;
+    }
+
+    // without executor, a long task delays every other timer
     lock.unlock();
-    job->task();
-    wait_cond_var_.notify_all();
-    if (!repeated) {
-      active_timer_count_--;
+    for (const auto &fired : batch_) {
+      // can be cancelled by a task of the same batch
+      if (!fired.task->Cancelled()) {
+        Fire(fired.task, fired.due);
+      }
+      if (fired.last) {
+        store_.Release(fired.task);
+      }
     }
     lock.lock();
+
+    // done with the lock held, so that WaitTillLast()
+    // cannot miss the notification
+    for (const auto &fired : batch_) {
+      if (fired.last) {
+        active_timer_count_--;
+      }
+    }
+    batch_.clear();
+    wait_cond_var_.notify_all();
+  }
+}
+
+void TimerManager::RunSerialized(Task *job) {
+  uint32_t state;
+
+  do {
+    // fires dispatched before a Cancel() are skipped
+    // a fire queued behind a previous one of the same timer is
+    // measured from the last deadline dispatched, so its lateness
+    // can be under reported
+    if (!job->Cancelled()) {
+      Fire(job, TimerQueue::TimePoint(TimerQueue::TimePoint::duration(
+                    job->dispatched_due.load())));
+    }
+    state = job->pending_fires.fetch_sub(1) - 1;
+  } while ((state & Task::kFireCountMask) != 0);
+
+  // kLastFire is added with the last fire, so only
+  // the worker which ran it can see it here
+  if ((state & Task::kLastFire) != 0) {
+    // read before the release, the task can be reused right after
+    const bool cancelled = job->Cancelled();
+    store_.Release(job);
+
+    // Cancel() already removed it from the active timers
+    if (cancelled) {
+      return;
+    }
+
+    std::unique_lock<std::mutex> lock(timer_mtx_);
+    active_timer_count_--;
+    wait_cond_var_.notify_all();
   }
-}
\ No newline at end of file
+}
+
+void TimerManager::Fire(Task *job, const TimerQueue::TimePoint &due) {
+  if (!record_stats_) {
+    job->task();
+    return;
+  }
+
+  const auto start = clock_->Now();
+  job->task();
+  const auto end = clock_->Now();
+
+  // the histogram is unsigned, the clamp is only a safety
+  const auto lateness = start > due ? start - due : Clock::Duration(0);
+  stats_.lateness.Record(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(lateness).count());
+  stats_.run_time.Record(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(end - start)
+          .count());
+}
+
+void TimerManager::DropCancelled(Task *job) {
+  job->state.fetch_or(Task::kFinished);
+
+  // without executor, nothing else uses the task
+  if (!executor_) {
+    store_.Release(job);
+    return;
+  }
+
+  // a worker running a previous fire releases it when it is done
+  if ((job->pending_fires.fetch_add(Task::kLastFire) & Task::kFireCountMask) ==
+      0) {
+    store_.Release(job);
+  }
+}
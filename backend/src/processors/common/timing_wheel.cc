@@ -0,0 +1,195 @@
+#include "processors/common/timing_wheel.h"
+
+namespace {
+
+inline int LowestBit(uint64_t bits) { return __builtin_ctzll(bits); }
+
+} // namespace
+
+TimingWheel::TimingWheel(std::chrono::steady_clock::duration tick,
+                         TimePoint origin)
+    : tick_(tick), origin_(origin), current_tick_(0), size_(0) {
+  if (tick_.count() <= 0) {
+    tick_ = std::chrono::steady_clock::duration(1);
+  }
+}
+
+void TimingWheel::Push(Task *task) {
+  Insert(task, ExpiryTick(task->time_to_run));
+  size_++;
+}
+
+void TimingWheel::Remove(Task *task) {
+  if (task->wheel_slot == kOverflowSlot) {
+    overflow_.Unlink(task);
+  } else {
+    const int level = task->wheel_slot / kSlotsPerLevel;
+    const uint64_t slot_index = task->wheel_slot % kSlotsPerLevel;
+    Slot &slot = slots_[level][slot_index];
+
+    slot.Unlink(task);
+    if (slot.head == nullptr) {
+      occupied_[level] &= ~(uint64_t(1) << slot_index);
+    }
+  }
+
+  size_--;
+}
+
+TimerQueue::TimePoint TimingWheel::NextDeadline() const {
+  const uint64_t tick = NextEventTick();
+  if (tick == kNoTick) {
+    return TimePoint::max();
+  }
+
+  return origin_ + tick_ * tick;
+}
+
+void TimingWheel::PopExpired(const TimePoint &now,
+                             std::vector<Task *> &expired) {
+  if (now < origin_) {
+    return;
+  }
+
+  const uint64_t target_tick = (now - origin_) / tick_;
+
+  while (true) {
+    const uint64_t next_tick = NextEventTick();
+
+    if (next_tick == kNoTick || next_tick > target_tick) {
+      // nothing to do until target_tick, the slots in between are empty
+      // so the wheel can jump directly there
+      if (target_tick > current_tick_) {
+        current_tick_ = target_tick;
+      }
+      return;
+    }
+
+    if (next_tick > current_tick_) {
+      current_tick_ = next_tick;
+      Cascade(current_tick_);
+    }
+
+    const uint64_t slot_index = current_tick_ & kSlotMask;
+    if ((occupied_[0] & (uint64_t(1) << slot_index)) == 0) {
+      continue;
+    }
+
+    occupied_[0] &= ~(uint64_t(1) << slot_index);
+
+    Task *task = slots_[0][slot_index].Detach();
+    while (task != nullptr) {
+      Task *next = task->next;
+      task->next = nullptr;
+      task->prev = nullptr;
+      expired.push_back(task);
+      size_--;
+      task = next;
+    }
+  }
+}
+
+uint64_t TimingWheel::ExpiryTick(const TimePoint &time) const {
+  if (time <= origin_) {
+    return 0;
+  }
+
+  // rounded up, a task never fires before its time_to_run
+  const auto elapsed = time - origin_;
+  return static_cast<uint64_t>(
+      (elapsed + tick_ - std::chrono::steady_clock::duration(1)) / tick_);
+}
+
+void TimingWheel::Insert(Task *task, uint64_t expiry_tick) {
+  if (expiry_tick < current_tick_) {
+    expiry_tick = current_tick_;
+  }
+
+  if ((expiry_tick & ~kRotationMask) != (current_tick_ & ~kRotationMask)) {
+    overflow_.Append(task);
+    task->wheel_slot = kOverflowSlot;
+    return;
+  }
+
+  // the task goes in the lowest level where its expiry tick
+  // and the current tick agree on every upper digit
+  int level = 0;
+  while (level < kLevels - 1 &&
+         (expiry_tick >> (kLevelBits * (level + 1))) !=
+             (current_tick_ >> (kLevelBits * (level + 1)))) {
+    level++;
+  }
+
+  const uint64_t slot_index = (expiry_tick >> (kLevelBits * level)) & kSlotMask;
+  slots_[level][slot_index].Append(task);
+  occupied_[level] |= uint64_t(1) << slot_index;
+  task->wheel_slot = static_cast<uint16_t>(level * kSlotsPerLevel + slot_index);
+}
+
+uint64_t TimingWheel::NextEventTick() const {
+  // level 0, the slot of the current tick included
+  const uint64_t digit = current_tick_ & kSlotMask;
+  const uint64_t ready = occupied_[0] & (~uint64_t(0) << digit);
+  if (ready != 0) {
+    return (current_tick_ & ~kSlotMask) | LowestBit(ready);
+  }
+
+  // upper levels, only the slots after the current one can be used
+  for (int level = 1; level < kLevels; level++) {
+    const int shift = kLevelBits * level;
+    const uint64_t level_digit = (current_tick_ >> shift) & kSlotMask;
+    if (level_digit == kSlotMask) {
+      continue;
+    }
+
+    const uint64_t pending =
+        occupied_[level] & (~uint64_t(0) << (level_digit + 1));
+    if (pending == 0) {
+      continue;
+    }
+
+    const uint64_t rotation_start =
+        current_tick_ & ~((uint64_t(1) << (shift + kLevelBits)) - 1);
+    return rotation_start | (uint64_t(LowestBit(pending)) << shift);
+  }
+
+  if (overflow_.head != nullptr) {
+    return (current_tick_ | kRotationMask) + 1;
+  }
+
+  return kNoTick;
+}
+
+void TimingWheel::Cascade(uint64_t tick) {
+  // start of a new rotation, the tasks that were too far
+  // may fit in the wheel now
+  if ((tick & kRotationMask) == 0) {
+    InsertAll(overflow_.Detach());
+  }
+
+  // from the top, so that a task cascaded from level N
+  // can be cascaded again from level N - 1 in the same call
+  for (int level = kLevels - 1; level > 0; level--) {
+    const int shift = kLevelBits * level;
+    if ((tick & ((uint64_t(1) << shift) - 1)) != 0) {
+      continue;
+    }
+
+    const uint64_t slot_index = (tick >> shift) & kSlotMask;
+    if ((occupied_[level] & (uint64_t(1) << slot_index)) == 0) {
+      continue;
+    }
+
+    occupied_[level] &= ~(uint64_t(1) << slot_index);
+    InsertAll(slots_[level][slot_index].Detach());
+  }
+}
+
+void TimingWheel::InsertAll(Task *first) {
+  while (first != nullptr) {
+    // Insert() overwrites the link
+    Task *next = first->next;
+    Insert(first, ExpiryTick(first->time_to_run));
+    first = next;
+  }
+}
@@ -42,6 +42,8 @@ std::any
 ConcreteFiScriptVisitor::visitStatement(FiScriptParser::StatementContext *ctx) {
   FiScriptParser::ReactonContext *reacton = ctx->reacton();
   FiScriptParser::ScheduleContext *schedule = ctx->schedule();
+  FiScriptParser::CancelContext *cancel = ctx->cancel();
+  FiScriptParser::RescheduleContext *reschedule = ctx->reschedule();
   FiScriptParser::PrintContext *print = ctx->print();
   FiScriptParser::AlertContext *alert = ctx->alert();
   FiScriptParser::SendorderContext *sendOrder = ctx->sendorder();
@@ -55,6 +57,10 @@ ConcreteFiScriptVisitor::visitStatement(FiScriptParser::StatementContext *ctx) {
     return visitReacton(reacton);
   } else if (schedule != nullptr) {
     return visitSchedule(schedule);
+  } else if (cancel != nullptr) {
+    return visitCancel(cancel);
+  } else if (reschedule != nullptr) {
+    return visitReschedule(reschedule);
   } else if (print != nullptr) {
     return visitPrint(print);
   } else if (sendOrder != nullptr) {
@@ -84,6 +90,24 @@ ConcreteFiScriptVisitor::visitSchedule(FiScriptParser::ScheduleContext *ctx) {
   return command;
 }
 
+std::any
+ConcreteFiScriptVisitor::visitCancel(FiScriptParser::CancelContext *ctx) {
+  Command command;
+  command.type = Command::CommandType::Cancel;
+  command.arguments = std::any_cast<std::vector<std::string>>(
+      visitArgumentList(ctx->argumentList()));
+  return command;
+}
+
+std::any ConcreteFiScriptVisitor::visitReschedule(
+    FiScriptParser::RescheduleContext *ctx) {
+  Command command;
+  command.type = Command::CommandType::Reschedule;
+  command.arguments = std::any_cast<std::vector<std::string>>(
+      visitArgumentList(ctx->argumentList()));
+  return command;
+}
+
 std::any
 ConcreteFiScriptVisitor::visitReacton(FiScriptParser::ReactonContext *ctx) {
   Command command;
@@ -1,11 +1,14 @@
 #include "processors/visitors/file_maker.h"
 
+#include <cctype>
 #include <cstdlib>
 #include <filesystem>
 #include <fstream>
 #include <iostream>
 #include <sstream>
+#include <stdexcept>
 #include <string>
+#include <utility>
 #include <vector>
 
 constexpr std::string_view kEndIncludes = "// ----- end includes";
@@ -143,6 +146,10 @@ bool FileMaker::MakeLine(const Command &command) {
   switch (command.type) {
   case Type::Schedule:
     return MakeScheduleCommand(command);
+  case Type::Cancel:
+    return MakeCancelCommand(command);
+  case Type::Reschedule:
+    return MakeRescheduleCommand(command);
   case Type::Print:
     return MakePrintCommand(command);
   case Type::Alert:
@@ -212,25 +219,54 @@ bool ValidInteger(const std::string &str) {
   return true;
 }
 
-int TimeInSecondToInteger(const std::string &str) {
-  if (!ValidInteger(str.substr(0, str.size() - 1))) {
-    throw std::invalid_argument("should give a time in second");
+// "5s", "500ms" or "250us" to the std::chrono code of the duration
+std::string TimeToChronoDuration(const std::string &str) {
+  static const std::vector<std::pair<std::string, std::string>> units = {
+      {"ms", "std::chrono::milliseconds"},
+      {"us", "std::chrono::microseconds"},
+      {"s", "std::chrono::seconds"},
+  };
+
+  for (const auto &[suffix, type] : units) {
+    if (str.size() <= suffix.size() ||
+        str.compare(str.size() - suffix.size(), suffix.size(), suffix) != 0)
+      continue;
+
+    const std::string number = str.substr(0, str.size() - suffix.size());
+    for (char c : number) {
+      if (c < '0' || c > '9')
+        throw std::invalid_argument("should give an integer time");
+    }
+    if (number.front() == '0')
+      throw std::invalid_argument("should give an integer time");
+
+    // throws when out of range
+    const int value = std::stoi(number);
+    return type + "(" + std::to_string(value) + ")";
   }
 
-  if (str.back() != 's')
-    throw std::invalid_argument(
-        "should give a time in second (no s at the end)");
+  throw std::invalid_argument("should give a time in s, ms or us");
+}
+
+bool ValidTimerName(const std::string &str) {
+  bool valid = !str.empty() && !(str.front() >= '0' && str.front() <= '9');
+  for (char c : str) {
+    if (!std::isalnum(static_cast<unsigned char>(c)) && c != '_') {
+      valid = false;
+    }
+  }
 
-  // Convert to int
-  int value = std::stoi(std::string(str));
-  return value;
+  if (!valid) {
+    std::cout << "'" << str << "' is not a valid timer name" << std::endl;
+  }
+  return valid;
 }
 
 const bool ScheduleArgsValid(const std::vector<std::string> &args) {
   bool valid = true;
-  if (args.size() != 3) {
-    std::cout << "expected 3 arguments, type of timer, second time to wait, "
-                 "3rd repeatition"
+  if (args.size() != 3 && args.size() != 4) {
+    std::cout << "expected 3 arguments, type of timer, time to wait, "
+                 "3rd repeatition (and optionally the name of the timer)"
               << std::endl;
     return false;
   }
@@ -240,12 +276,11 @@ const bool ScheduleArgsValid(const std::vector<std::string> &args) {
     return false;
   }
 
-  int nbr = 0;
   try {
-    nbr = TimeInSecondToInteger(args[1]);
+    TimeToChronoDuration(args[1]);
   } catch (...) {
     std::cout << "could not interpret " << args[1]
-              << " as an integer number of seconds (format should be XXXs)"
+              << " as a time (format should be XXXs, XXXms or XXXus)"
               << std::endl;
     valid = false;
   }
@@ -253,6 +288,9 @@ const bool ScheduleArgsValid(const std::vector<std::string> &args) {
   if (!ValidInteger(args[2]))
     valid = false;
 
+  if (args.size() == 4 && !ValidTimerName(args[3]))
+    valid = false;
+
   return valid;
 }
 
@@ -264,24 +302,92 @@ bool FileMaker::MakeScheduleCommand(const Command &command) {
 
   std::cout << "adding the schedule command" << std::endl;
 
-  const int seconds_to_wait = TimeInSecondToInteger(args[1]);
+  const std::string time_to_wait = TimeToChronoDuration(args[1]);
   const int repeat = stoi(args[2]);
 
   long tab = code_it_->first;
 
   AddTimerManager(command);
 
+  // before the captures, the block can cancel its own timer
+  std::string handle;
+  if (args.size() == 4) {
+    if (variable_types_.find(args[3]) != variable_types_.end()) {
+      std::cout << "timer name " << args[3] << " is already a variable"
+                << std::endl;
+      return false;
+    }
+    DeclareTimerHandle(args[3]);
+    handle = args[3] + " = ";
+  }
+
   CollectRequiredManagers(command);
 
   std::string lambda_captures = GenerateLambdaCaptures();
 
-  InsertCode("timer_manager.CreateTimer(" + lambda_captures + "() mutable {", tab);
+  InsertCode(handle + "timer_manager.CreateTimer(" + lambda_captures +
+                 "() mutable {",
+             tab);
 
   MakeBlock(command.in_scope);
 
-  InsertCode(std::string("}, std::chrono::seconds(") +
-                 std::to_string(seconds_to_wait) + "), " +
-                 std::to_string(repeat) + ");",
+  InsertCode("}, " + time_to_wait + ", " + std::to_string(repeat) + ");",
+             tab);
+
+  return true;
+}
+
+bool FileMaker::MakeCancelCommand(const Command &command) {
+  const std::vector<std::string> &args = command.arguments;
+
+  if (args.size() != 1) {
+    std::cout << "expected 1 argument, the name of the timer" << std::endl;
+    return false;
+  }
+
+  if (timer_handles_.find(args[0]) == timer_handles_.end()) {
+    std::cout << "no timer named " << args[0] << std::endl;
+    return false;
+  }
+
+  std::cout << "adding the cancel command" << std::endl;
+
+  long tab = code_it_->first;
+  InsertCode("timer_manager.Cancel(" + args[0] + ");", tab);
+
+  return true;
+}
+
+bool FileMaker::MakeRescheduleCommand(const Command &command) {
+  const std::vector<std::string> &args = command.arguments;
+
+  if (args.size() != 2) {
+    std::cout << "expected 2 arguments, the name of the timer "
+                 "and the new time to wait"
+              << std::endl;
+    return false;
+  }
+
+  if (timer_handles_.find(args[0]) == timer_handles_.end()) {
+    std::cout << "no timer named " << args[0] << std::endl;
+    return false;
+  }
+
+  std::string time_to_wait;
+  try {
+    time_to_wait = TimeToChronoDuration(args[1]);
+  } catch (...) {
+    std::cout << "could not interpret " << args[1]
+              << " as a time (format should be XXXs, XXXms or XXXus)"
+              << std::endl;
+    return false;
+  }
+
+  std::cout << "adding the reschedule command" << std::endl;
+
+  long tab = code_it_->first;
+  InsertCode("timer_manager.Reschedule(" + args[0] + ", " + time_to_wait +
+                 ");",
              tab);
 
   return true;
@@ -327,8 +433,15 @@ bool FileMaker::MakeAlertCommand(const Command &command) {
 }
 
 bool ReactOnArgsValid(const std::vector<std::string> &args) {
-  if (args.size() != 2) {
-    std::cout << "expected 2 arguments: instrument_id and repetition count"
+  if (args.size() != 2 && args.size() != 3) {
+    std::cout << "expected 2 arguments: instrument_id and repetition count "
+                 "(and optionally the mode, queue or conflate)"
+              << std::endl;
+    return false;
+  }
+
+  if (args.size() == 3 && args[2] != "queue" && args[2] != "conflate") {
+    std::cout << "third argument (mode) should be queue or conflate"
               << std::endl;
     return false;
   }
@@ -381,7 +494,12 @@ bool FileMaker::MakeReactOnCommand(const Command &command) {
 
   MakeBlock(command.in_scope);
 
-  InsertCode("});", tab);
+  // a slow block only sees the latest tick
+  if (args.size() == 3 && args[2] == "conflate") {
+    InsertCode("}, ReactionMode::Conflate);", tab);
+  } else {
+    InsertCode("});", tab);
+  }
 
   return true;
 }
@@ -721,6 +839,21 @@ void FileMaker::AddTimerManager(const Command &command) {
   }
 }
 
+// the handle is declared where the outermost command is written
+// (in main for a top level command), so every lambda can capture it
+void FileMaker::DeclareTimerHandle(const std::string &name) {
+  if (timer_handles_.find(name) != timer_handles_.end())
+    return;
+
+  if (timer_handles_.empty()) {
+    InsertInclude("<atomic>", false);
+  }
+
+  const long tab = code_it_->first;
+  InsertCode("std::atomic<TimerId> " + name + "{kInvalidTimerId};", tab);
+  timer_handles_.insert(name);
+}
+
 void FileMaker::AddReactOnService(const Command &command) {
   const bool added_before =
       history_.find(Command::CommandType::ReactOn) != std::cend(history_);
@@ -740,13 +873,27 @@ void FileMaker::Include(const Command &command) {
     // because SendOrder also needs the AlertService (yet)
     type = Command::Alert;
   }
+  if (command.type == Command::Cancel || command.type == Command::Reschedule) {
+    // they only use the TimerManager
+    type = Command::Schedule;
+  }
   if (history_.find(type) != std::cend(history_))
     return;
 
   using Type = Command::CommandType;
   switch (command.type) {
   case Type::Schedule:
+  case Type::Cancel:
+  case Type::Reschedule:
     InsertInclude("\"processors/common/timers.h\"", true);
+    AddDependency("\"processors/common/timer_queue.h\"");
+    AddDependency("\"processors/common/timing_wheel.h\"");
+    AddDependency("\"processors/common/thread_pool.h\"");
+    AddDependency("\"processors/common/task_store.h\"");
+    AddDependency("\"processors/common/task_intake.h\"");
+    AddDependency("\"processors/common/inplace_function.h\"");
+    AddDependency("\"processors/common/clock.h\"");
+    AddDependency("\"processors/common/hdr_histogram.h\"");
     break;
   case Type::Print:
     InsertInclude("<iostream>", false);
@@ -754,9 +901,16 @@ void FileMaker::Include(const Command &command) {
   case Type::Alert:
   case Type::SendOrder:
     InsertInclude("\"services/script_alert_service.h\"", true);
+    AddDependency("\"processors/common/clock.h\"");
     break;
   case Type::ReactOn:
     InsertInclude("\"services/reacton_service.h\"", true);
+    AddDependency("\"services/reaction_index.h\"");
+    AddDependency("\"services/reaction_executor.h\"");
+    AddDependency("\"services/market_data_ring.h\"");
+    AddDependency("\"processors/common/thread_pool.h\"");
+    AddDependency("\"processors/common/seqlock.h\"");
+    AddDependency("\"processors/common/inplace_function.h\"");
     break;
   default:
     break;
@@ -772,6 +926,14 @@ void FileMaker::ProcessCommandsForManagers(const std::vector<Command> &commands)
     if (sub_command.type == Type::Schedule) {
       active_managers_.insert(Type::Schedule);
       AddTimerManager(sub_command);
+      if (sub_command.arguments.size() == 4 &&
+          ValidTimerName(sub_command.arguments[3])) {
+        DeclareTimerHandle(sub_command.arguments[3]);
+      }
+    } else if (sub_command.type == Type::Cancel ||
+               sub_command.type == Type::Reschedule) {
+      active_managers_.insert(Type::Schedule);
+      AddTimerManager(sub_command);
     } else if (sub_command.type == Type::ReactOn) {
       active_managers_.insert(Type::ReactOn);
       AddReactOnService(sub_command);
@@ -806,6 +968,10 @@ std::string FileMaker::GenerateLambdaCaptures() const {
     captures += ", &timer_manager";
   }
 
+  for (const auto &handle : timer_handles_) {
+    captures += ", &" + handle;
+  }
+
   if (active_managers_.find(Command::CommandType::ReactOn) != active_managers_.end() &&
       history_.find(Command::CommandType::ReactOn) != history_.end()) {
     captures += ", &reacton_service";
@@ -0,0 +1,209 @@
+#include "services/market_data_ring.h"
+
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <new>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr uint64_t kMagic = 0x46495343524d4452ull; // "FISCRMDR"
+constexpr uint32_t kVersion = 1;
+
+std::size_t RingSize(uint32_t capacity) {
+  return sizeof(MarketDataRingHeader) +
+         static_cast<std::size_t>(capacity) * sizeof(MarketDataRingSlot);
+}
+
+MarketDataRingSlot *Slots(void *memory) {
+  return reinterpret_cast<MarketDataRingSlot *>(
+      static_cast<char *>(memory) + sizeof(MarketDataRingHeader));
+}
+
+} // namespace
+
+MarketDataRingWriter::MarketDataRingWriter()
+    : memory_(nullptr), size_(0), header_(nullptr), slots_(nullptr),
+      mask_(0), next_(0) {}
+
+MarketDataRingWriter::~MarketDataRingWriter() {
+  if (header_ == nullptr) {
+    return;
+  }
+
+  // readers mapping it fall back to gRPC
+  header_->closed.store(1, std::memory_order_release);
+  munmap(memory_, size_);
+  shm_unlink(name_.c_str());
+}
+
+bool MarketDataRingWriter::Create(const std::string &name,
+                                  uint32_t capacity) {
+  uint32_t rounded = 1;
+  while (rounded < capacity) {
+    rounded *= 2;
+  }
+
+  // a ring left by a crashed distributor
+  shm_unlink(name.c_str());
+
+  const int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+  if (fd == -1) {
+    std::cerr << "could not create the market data ring " << name << ": "
+              << std::strerror(errno) << std::endl;
+    return false;
+  }
+
+  const std::size_t size = RingSize(rounded);
+  if (ftruncate(fd, static_cast<off_t>(size)) == -1) {
+    std::cerr << "could not size the market data ring " << name << ": "
+              << std::strerror(errno) << std::endl;
+    close(fd);
+    shm_unlink(name.c_str());
+    return false;
+  }
+
+  void *memory =
+      mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (memory == MAP_FAILED) {
+    std::cerr << "could not map the market data ring " << name << ": "
+              << std::strerror(errno) << std::endl;
+    shm_unlink(name.c_str());
+    return false;
+  }
+
+  // the pages are zeroed by ftruncate, every slot sequence is 0
+  header_ = new (memory) MarketDataRingHeader();
+  slots_ = Slots(memory);
+  header_->version = kVersion;
+  header_->capacity = rounded;
+  header_->writer_pid = getpid();
+  header_->closed.store(0, std::memory_order_relaxed);
+  header_->write_sequence.store(0, std::memory_order_relaxed);
+
+  // last, a reader only trusts the header once the magic is there
+  std::atomic_thread_fence(std::memory_order_release);
+  header_->magic = kMagic;
+
+  name_ = name;
+  memory_ = memory;
+  size_ = size;
+  mask_ = rounded - 1;
+  next_ = 0;
+  return true;
+}
+
+void MarketDataRingWriter::Publish(const MarketDataRecord &record) {
+  MarketDataRingSlot &slot = slots_[next_ & mask_];
+
+  slot.sequence.store(2 * next_ + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+
+  std::memcpy(&slot.record, &record, sizeof(MarketDataRecord));
+
+  slot.sequence.store(2 * next_ + 2, std::memory_order_release);
+  header_->write_sequence.store(++next_, std::memory_order_release);
+}
+
+MarketDataRingReader::MarketDataRingReader()
+    : memory_(nullptr), size_(0), header_(nullptr), slots_(nullptr),
+      mask_(0), next_(0), lost_(0) {}
+
+MarketDataRingReader::~MarketDataRingReader() {
+  if (memory_ != nullptr) {
+    munmap(memory_, size_);
+  }
+}
+
+bool MarketDataRingReader::Open(const std::string &name) {
+  const int fd = shm_open(name.c_str(), O_RDONLY, 0);
+  if (fd == -1) {
+    return false;
+  }
+
+  struct stat info;
+  if (fstat(fd, &info) == -1 ||
+      static_cast<std::size_t>(info.st_size) < sizeof(MarketDataRingHeader)) {
+    close(fd);
+    return false;
+  }
+
+  const std::size_t size = static_cast<std::size_t>(info.st_size);
+  void *memory = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (memory == MAP_FAILED) {
+    return false;
+  }
+
+  const auto *header = static_cast<const MarketDataRingHeader *>(memory);
+  std::atomic_thread_fence(std::memory_order_acquire);
+  if (header->magic != kMagic || header->version != kVersion ||
+      RingSize(header->capacity) != size) {
+    munmap(memory, size);
+    return false;
+  }
+
+  memory_ = memory;
+  size_ = size;
+  header_ = header;
+  slots_ = Slots(memory);
+  mask_ = header->capacity - 1;
+  next_ = header->write_sequence.load(std::memory_order_acquire);
+
+  if (!WriterAlive()) {
+    munmap(memory_, size_);
+    memory_ = nullptr;
+    header_ = nullptr;
+    return false;
+  }
+  return true;
+}
+
+bool MarketDataRingReader::Poll(MarketDataRecord &record) {
+  const MarketDataRingSlot &slot = slots_[next_ & mask_];
+  const uint64_t published = 2 * next_ + 2;
+
+  const uint64_t before = slot.sequence.load(std::memory_order_acquire);
+  if (before < published) {
+    // not written yet (or being written)
+    return false;
+  }
+  if (before > published) {
+    Resync();
+    return false;
+  }
+
+  std::memcpy(&record, &slot.record, sizeof(MarketDataRecord));
+  std::atomic_thread_fence(std::memory_order_acquire);
+
+  // rewritten by the writer during the copy, this reader was lapped
+  if (slot.sequence.load(std::memory_order_relaxed) != before) {
+    Resync();
+    return false;
+  }
+
+  next_++;
+  return true;
+}
+
+void MarketDataRingReader::Resync() {
+  const uint64_t newest =
+      header_->write_sequence.load(std::memory_order_acquire);
+  lost_ += newest - next_;
+  next_ = newest;
+}
+
+bool MarketDataRingReader::WriterAlive() const {
+  if (header_->closed.load(std::memory_order_acquire) != 0) {
+    return false;
+  }
+
+  // the writer crashed without closing the ring
+  return kill(header_->writer_pid, 0) == 0 || errno == EPERM;
+}
@@ -0,0 +1,125 @@
+#include "services/reaction_executor.h"
+
+#include "services/reacton_service.h"
+
+ReactionExecutor::ReactionExecutor(std::size_t thread_count,
+                                   AfterRun after_run)
+    : after_run_(std::move(after_run)), busy_strands_(0),
+      pool_(thread_count) {}
+
+void ReactionExecutor::Post(Reaction &reaction,
+                            const internal::PriceUpdate &update) {
+  ReactionStrand &strand = reaction.strand;
+
+  if (reaction.mode == ReactionMode::Conflate) {
+    PriceSnapshot snapshot;
+    snapshot.price = update.price();
+    snapshot.quantity = update.quantity();
+    snapshot.timestamp_seconds = update.timestamp().seconds();
+    snapshot.timestamp_nanos = update.timestamp().nanos();
+    // replaces a tick the callback did not take yet
+    strand.latest.Store(snapshot);
+  }
+
+  {
+    std::unique_lock<std::mutex> lock(strand.mtx);
+    if (reaction.mode == ReactionMode::Queue) {
+      strand.updates.push_back(update);
+    }
+    if (strand.scheduled) {
+      // the worker running the strand will take it
+      return;
+    }
+    strand.scheduled = true;
+  }
+
+  {
+    std::unique_lock<std::mutex> lock(idle_mtx_);
+    busy_strands_++;
+  }
+
+  Reaction *job_reaction = &reaction;
+  pool_.Submit([this, job_reaction]() { RunStrand(job_reaction); });
+}
+
+void ReactionExecutor::WaitIdle() {
+  std::unique_lock<std::mutex> lock(idle_mtx_);
+  idle_cond_var_.wait(lock, [this] { return busy_strands_ == 0; });
+}
+
+bool ReactionExecutor::Take(Reaction &reaction,
+                            internal::PriceUpdate &update) {
+  ReactionStrand &strand = reaction.strand;
+
+  if (reaction.mode == ReactionMode::Queue) {
+    std::unique_lock<std::mutex> lock(strand.mtx);
+    if (strand.updates.empty()) {
+      strand.scheduled = false;
+      return false;
+    }
+    update.Swap(&strand.updates.front());
+    strand.updates.pop_front();
+    return true;
+  }
+
+  PriceSnapshot snapshot;
+  uint64_t sequence = strand.latest.Load(snapshot);
+
+  if (sequence == strand.consumed_sequence) {
+    // the reader stores before checking scheduled, so a tick stored
+    // before this lock is seen here, a later one schedules the strand
+    std::unique_lock<std::mutex> lock(strand.mtx);
+    if (strand.latest.Sequence() == strand.consumed_sequence) {
+      strand.scheduled = false;
+      return false;
+    }
+    lock.unlock();
+    sequence = strand.latest.Load(snapshot);
+  }
+
+  // every tick stored since the last callback but this one was skipped
+  reaction.conflated_count += (sequence - strand.consumed_sequence) / 2 - 1;
+  strand.consumed_sequence = sequence;
+
+  update.Clear();
+  update.set_instrument_id(reaction.instrument_id);
+  update.set_price(snapshot.price);
+  update.set_quantity(snapshot.quantity);
+  update.mutable_timestamp()->set_seconds(snapshot.timestamp_seconds);
+  update.mutable_timestamp()->set_nanos(snapshot.timestamp_nanos);
+  return true;
+}
+
+void ReactionExecutor::RunStrand(Reaction *reaction) {
+  internal::PriceUpdate update;
+  bool idle = false;
+
+  for (int ran = 0; ran < kStrandBatch; ++ran) {
+    if (!Take(*reaction, update)) {
+      idle = true;
+      break;
+    }
+
+    // a conflating reaction is posted until its last callback has run
+    // the ticks read meanwhile are dropped
+    if (reaction->max_count != -1 &&
+        reaction->current_count >= reaction->max_count) {
+      continue;
+    }
+
+    reaction->callback(update);
+    after_run_(*reaction);
+  }
+
+  if (!idle) {
+    // the batch is over, the strand stays busy and goes back to the
+    // pool so that the other strands get a worker
+    pool_.Submit([this, reaction]() { RunStrand(reaction); });
+    return;
+  }
+
+  std::unique_lock<std::mutex> lock(idle_mtx_);
+  if (--busy_strands_ == 0) {
+    idle_cond_var_.notify_all();
+  }
+}
@@ -0,0 +1,97 @@
+#include "services/reaction_index.h"
+
+#include <unordered_map>
+
+#include "services/reacton_service.h"
+
+namespace {
+
+// FNV-1a, instrument ids are short, it beats std::hash there
+inline std::size_t HashId(std::string_view instrument_id) {
+  uint64_t hash = 14695981039346656037ull;
+  for (char c : instrument_id) {
+    hash ^= static_cast<unsigned char>(c);
+    hash *= 1099511628211ull;
+  }
+  return static_cast<std::size_t>(hash);
+}
+
+} // namespace
+
+ReactionIndex::ReactionIndex(
+    const std::vector<std::shared_ptr<Reaction>> &reactions) {
+  // interned ids, in order of first registration
+  std::unordered_map<std::string, uint32_t> ids;
+  std::vector<uint32_t> reaction_ids;
+  std::vector<uint32_t> offsets;
+  reaction_ids.reserve(reactions.size());
+
+  for (const auto &reaction : reactions) {
+    auto it = ids.emplace(reaction->instrument_id,
+                          static_cast<uint32_t>(ids.size()));
+    if (it.second) {
+      offsets.push_back(0);
+      instrument_ids_.push_back(reaction->instrument_id);
+    }
+    reaction_ids.push_back(it.first->second);
+    offsets[it.first->second]++;
+  }
+  instrument_count_ = ids.size();
+
+  // counts to starts
+  uint32_t start = 0;
+  for (auto &offset : offsets) {
+    const uint32_t count = offset;
+    offset = start;
+    start += count;
+  }
+
+  // stable, the reactions of an instrument keep their order
+  reactions_.resize(reactions.size());
+  std::vector<uint32_t> next = offsets;
+  for (std::size_t i = 0; i < reactions.size(); ++i) {
+    reactions_[next[reaction_ids[i]]++] = reactions[i].get();
+  }
+
+  std::size_t capacity = 8;
+  while (capacity < 2 * instrument_count_) {
+    capacity *= 2;
+  }
+  slots_.resize(capacity);
+
+  const std::size_t mask = capacity - 1;
+  for (const auto &[instrument_id, id] : ids) {
+    const std::size_t hash = HashId(instrument_id);
+    std::size_t index = hash & mask;
+    while (slots_[index].begin != slots_[index].end) {
+      index = (index + 1) & mask;
+    }
+
+    Slot &slot = slots_[index];
+    slot.hash = hash;
+    slot.instrument_id = instrument_id;
+    slot.begin = offsets[id];
+    slot.end = next[id];
+  }
+}
+
+ReactionIndex::Range
+ReactionIndex::Find(std::string_view instrument_id) const {
+  if (instrument_count_ == 0) {
+    return {};
+  }
+
+  const std::size_t mask = slots_.size() - 1;
+  const std::size_t hash = HashId(instrument_id);
+
+  for (std::size_t index = hash & mask;; index = (index + 1) & mask) {
+    const Slot &slot = slots_[index];
+    if (slot.begin == slot.end) {
+      return {};
+    }
+
+    if (slot.hash == hash && slot.instrument_id == instrument_id) {
+      return {reactions_.data() + slot.begin, reactions_.data() + slot.end};
+    }
+  }
+}
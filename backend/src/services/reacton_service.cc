@@ -1,89 +1,286 @@
 #include "services/reacton_service.h"
 
-#include <google/protobuf/empty.pb.h>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+namespace {
+
+// sleep between two polls of a quiet ring
+constexpr std::chrono::microseconds kRingIdleSleep{50};
+
+} // namespace
+
+ReactOnService::ReactOnService() : ReactOnService(ReactOnConfig{}) {}
+
+ReactOnService::ReactOnService(const ReactOnConfig &config)
+    : transport_(config.transport), ring_spin_(config.ring_spin),
+      stop_(false), reader_started_(false), context_(nullptr),
+      index_(std::make_shared<const ReactionIndex>()), index_version_(0),
+      reader_index_(index_), reader_version_(0), pending_reactions_(0) {
+  const char *transport = std::getenv("FISCRIPT_MARKET_DATA");
+  if (transport != nullptr && std::strcmp(transport, "grpc") == 0) {
+    transport_ = MarketDataTransport::Grpc;
+  }
+
+  if (config.worker_threads > 0) {
+    executor_ = std::make_unique<ReactionExecutor>(
+        config.worker_threads,
+        [this](Reaction &reaction) { ReactionRan(reaction); });
+  }
 
-ReactOnService::ReactOnService() : stop_(false) {
   channel_ = grpc::CreateChannel("localhost:50052",
                                  grpc::InsecureChannelCredentials());
   stub_ = internal::MarketDataService::NewStub(channel_);
-  reader_thread_ = std::thread(&ReactOnService::ReadMarketDataStream, this);
 }
 
 ReactOnService::~ReactOnService() {
-  stop_ = true;
+  {
+    std::unique_lock<std::mutex> lock(reactions_mtx_);
+    stop_ = true;
+    // the reader can be blocked in Read() waiting for a quiet instrument
+    if (context_ != nullptr) {
+      context_->TryCancel();
+    }
+  }
 
   if (reader_thread_.joinable()) {
     reader_thread_.join();
   }
+
+  // runs the callbacks already handed to it
+  executor_.reset();
+
+  const long long conflated = GetConflatedCount();
+  if (conflated > 0) {
+    std::cout << "ReactOn skipped " << conflated
+              << " stale ticks in conflating reactions" << std::endl;
+  }
 }
 
 void ReactOnService::RegisterReaction(
     const std::string &instrument_id, int max_count,
-    std::function<void(const internal::PriceUpdate &quote)> callback) {
+    std::function<void(const internal::PriceUpdate &quote)> callback,
+    ReactionMode mode) {
+  std::unique_lock<std::mutex> lock(reactions_mtx_);
+
+  const bool new_instrument = index_->Find(instrument_id).empty();
   reactions_.push_back(
-      std::make_shared<Reaction>(instrument_id, max_count, callback));
+      std::make_shared<Reaction>(instrument_id, max_count, callback, mode));
+  if (max_count == -1 || max_count > 0) {
+    pending_reactions_++;
+  }
+
+  // a new index, the reader can still be using the previous one
+  std::atomic_store(&index_, std::shared_ptr<const ReactionIndex>(
+                                 std::make_shared<ReactionIndex>(reactions_)));
+  index_version_++;
+
+  if (!reader_started_) {
+    reader_started_ = true;
+    reader_thread_ = std::thread(&ReactOnService::ReadMarketDataStream, this);
+  } else if (new_instrument && context_ != nullptr) {
+    // the reader opens a new stream with every instrument
+    // the updates sent in between are lost
+    context_->TryCancel();
+  }
 }
 
 void ReactOnService::WaitForCompletion() {
   if (reader_thread_.joinable()) {
     reader_thread_.join();
   }
+
+  if (executor_) {
+    executor_->WaitIdle();
+  }
+}
+
+long long ReactOnService::GetConflatedCount() {
+  std::unique_lock<std::mutex> lock(reactions_mtx_);
+
+  long long conflated = 0;
+  for (const auto &reaction : reactions_) {
+    conflated += reaction->conflated_count;
+  }
+  return conflated;
 }
 
 bool ReactOnService::ShouldStopReading() {
-  if (stop_) {
-    return true;
+  return stop_ || pending_reactions_ == 0;
+}
+
+void ReactOnService::RefreshIndex() {
+  // reactions registered since the last update
+  const uint64_t version = index_version_.load();
+  if (version != reader_version_) {
+    reader_index_ = std::atomic_load(&index_);
+    reader_version_ = version;
   }
+}
 
-  for (const auto &reaction : reactions_) {
-    if (reaction->max_count == -1 ||
-        reaction->current_count < reaction->max_count) {
-      return false;
+void ReactOnService::Dispatch(ReactionIndex::Range reactions,
+                              const internal::PriceUpdate &update) {
+  for (Reaction *reaction : reactions) {
+    // the ticks of a conflating reaction can be skipped, so it gets
+    // ticks until max_count callbacks have run
+    const int handed = executor_ && reaction->mode == ReactionMode::Conflate
+                           ? reaction->current_count.load()
+                           : reaction->posted_count;
+    if (reaction->max_count != -1 && handed >= reaction->max_count) {
+      continue;
     }
+    reaction->posted_count++;
+
+    // a slow callback only delays the ticks of its own reaction
+    if (executor_) {
+      executor_->Post(*reaction, update);
+      continue;
+    }
+
+    reaction->callback(update);
+    ReactionRan(*reaction);
+  }
+}
+
+void ReactOnService::ReactionRan(Reaction &reaction) {
+  if (++reaction.current_count != reaction.max_count) {
+    return;
   }
 
-  return true;
+  // the last callback can register new reactions, so a reaction is
+  // done once its last callback has run, not when its last tick is read
+  if (--pending_reactions_ > 0) {
+    return;
+  }
+
+  // the reader can be waiting for a tick which nobody needs anymore
+  std::unique_lock<std::mutex> lock(reactions_mtx_);
+  if (context_ != nullptr) {
+    context_->TryCancel();
+  }
 }
 
 void ReactOnService::ReadMarketDataStream() {
-  grpc::ClientContext context;
-  google::protobuf::Empty request;
+  if (transport_ == MarketDataTransport::Auto) {
+    MarketDataRingReader ring;
+    if (ring.Open(kMarketDataRingName)) {
+      ReadMarketDataRing(ring);
 
-  std::unique_ptr<grpc::ClientReader<internal::PriceUpdate>> reader(
-      stub_->StreamPrices(&context, request));
+      if (ring.LostCount() > 0) {
+        std::cerr << "ReactOn was lapped by the market data ring, "
+                  << ring.LostCount() << " ticks lost" << std::endl;
+      }
+      if (ShouldStopReading()) {
+        return;
+      }
+      std::cerr << "market data ring closed, reading from gRPC" << std::endl;
+    }
+  }
 
+  ReadGrpcStream();
+}
+
+void ReactOnService::ReadMarketDataRing(MarketDataRingReader &ring) {
+  MarketDataRecord record;
   internal::PriceUpdate update;
+  auto last_tick = std::chrono::steady_clock::now();
 
-  while (reader->Read(&update)) {
-    for (const auto &reaction : reactions_) {
-      if (reaction->max_count != -1 &&
-          reaction->current_count >= reaction->max_count) {
+  // every instrument is in the ring, the index drops the other ones
+  // before anything is decoded
+  while (!ShouldStopReading()) {
+    if (!ring.Poll(record)) {
+      if (std::chrono::steady_clock::now() - last_tick < ring_spin_) {
         continue;
       }
-
-      // same problem as timers
-      // if the callback takes a long time to execute
-      // it can cause the stream to be blocked
-      // thread pool should be used to execute the callbacks
-      reaction->callback(update);
-      reaction->current_count++;
+      if (!ring.WriterAlive()) {
+        return;
+      }
+      std::this_thread::sleep_for(kRingIdleSleep);
+      continue;
     }
+    last_tick = std::chrono::steady_clock::now();
 
-    // Here we use TryCancel
-    // because Finish() waits for
-    // the server to ends its streaming
-    // while we want to cancel the subscription
-    // immediatly
-    if (ShouldStopReading()) {
-      context.TryCancel();
-      break;
+    record.instrument_id[sizeof(record.instrument_id) - 1] = '\0';
+    RefreshIndex();
+    const ReactionIndex::Range reactions =
+        reader_index_->Find(record.instrument_id);
+    if (reactions.empty()) {
+      continue;
     }
+
+    // the second copy of the tick, the callbacks take a PriceUpdate
+    update.set_instrument_id(record.instrument_id);
+    update.set_price(record.price);
+    update.set_quantity(record.quantity);
+    update.mutable_timestamp()->set_seconds(record.timestamp_seconds);
+    update.mutable_timestamp()->set_nanos(record.timestamp_nanos);
+    Dispatch(reactions, update);
   }
+}
 
-  grpc::Status status = reader->Finish();
+void ReactOnService::ReadGrpcStream() {
+  while (true) {
+    grpc::ClientContext context;
+    internal::MarketDataRequest request;
+
+    {
+      std::unique_lock<std::mutex> lock(reactions_mtx_);
+      if (stop_) {
+        break;
+      }
 
-  if (!status.ok() && status.error_code() != grpc::StatusCode::CANCELLED) {
-    std::cerr << "StreamPrices RPC failed: " << status.error_message()
-              << std::endl;
+      // only the instruments with a reaction are sent by the distributor
+      for (const auto &instrument_id : index_->InstrumentIds()) {
+        request.add_instrument_ids(instrument_id);
+      }
+      context_ = &context;
+    }
+
+    // batches carry everything the distributor had queued for us
+    // so a burst costs one read instead of one per update
+    std::unique_ptr<grpc::ClientReader<internal::PriceUpdateBatch>> reader(
+        stub_->StreamPriceBatches(&context, request));
+
+    internal::PriceUpdateBatch batch;
+    bool stopped = false;
+
+    while (!stopped && reader->Read(&batch)) {
+      RefreshIndex();
+
+      for (const auto &update : batch.updates()) {
+        Dispatch(reader_index_->Find(update.instrument_id()), update);
+
+        // Here we use TryCancel
+        // because Finish() waits for
+        // the server to ends its streaming
+        // while we want to cancel the subscription
+        // immediatly
+        if (ShouldStopReading()) {
+          context.TryCancel();
+          stopped = true;
+          break;
+        }
+      }
+    }
+
+    grpc::Status status = reader->Finish();
+
+    {
+      std::unique_lock<std::mutex> lock(reactions_mtx_);
+      context_ = nullptr;
+    }
+
+    // a cancel with reactions left comes from a new instrument
+    if (status.error_code() == grpc::StatusCode::CANCELLED &&
+        !ShouldStopReading()) {
+      continue;
+    }
+
+    if (!status.ok() && status.error_code() != grpc::StatusCode::CANCELLED) {
+      std::cerr << "StreamPriceBatches RPC failed: " << status.error_message()
+                << std::endl;
+    }
+    break;
   }
 }
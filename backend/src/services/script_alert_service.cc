@@ -4,6 +4,7 @@
 #include <google/protobuf/util/time_util.h>
 
 #include "messages/script_alert_notif.pb.h"
+#include "processors/common/clock.h"
 #include "processors/common/script_info.h"
 
 ScriptAlertService::ScriptAlertService() {
@@ -25,8 +26,12 @@ void ScriptAlertService::SendAlert(const std::string &message, internal::Priorit
   request.set_script_title(script_info.GetScriptTitle());
   request.set_priority(priority);
 
+  // the simulated date when the script is replayed
+  const auto creation_time = DefaultClock().WallNow().time_since_epoch();
   *request.mutable_creation_time() =
-      google::protobuf::util::TimeUtil::GetCurrentTime();
+      google::protobuf::util::TimeUtil::NanosecondsToTimestamp(
+          std::chrono::duration_cast<std::chrono::nanoseconds>(creation_time)
+              .count());
 
   grpc::Status status = stub_->ScriptAlert(&context, request, &response);
 
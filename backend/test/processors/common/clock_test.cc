@@ -0,0 +1,37 @@
+#include <gtest/gtest.h>
+
+#include "processors/common/clock.h"
+
+using namespace std::chrono;
+
+TEST(ClockTest, SimulatedClockOnlyMovesWhenAdvanced) {
+  SimulatedClock clock;
+  const auto start = clock.Now();
+
+  EXPECT_EQ(clock.Now(), start);
+
+  clock.AdvanceBy(seconds(5));
+  EXPECT_EQ(clock.Now(), start + seconds(5));
+
+  clock.AdvanceTo(start + hours(1));
+  EXPECT_EQ(clock.Now(), start + hours(1));
+}
+
+TEST(ClockTest, SimulatedClockNeverGoesBack) {
+  SimulatedClock clock;
+  const auto start = clock.Now();
+
+  clock.AdvanceTo(start + seconds(10));
+  clock.AdvanceTo(start + seconds(3));
+  EXPECT_EQ(clock.Now(), start + seconds(10));
+}
+
+TEST(ClockTest, SimulatedWallTimeFollowsTheClock) {
+  const system_clock::time_point wall_start = system_clock::now();
+  SimulatedClock clock(Clock::TimePoint(), wall_start);
+
+  EXPECT_EQ(clock.WallNow(), wall_start);
+
+  clock.AdvanceBy(minutes(90));
+  EXPECT_EQ(clock.WallNow(), wall_start + minutes(90));
+}
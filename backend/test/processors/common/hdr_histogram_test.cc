@@ -0,0 +1,72 @@
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+
+#include "processors/common/hdr_histogram.h"
+
+TEST(HdrHistogramTest, EmptyHistogram) {
+  HdrHistogram histogram;
+
+  EXPECT_EQ(histogram.Count(), 0);
+  EXPECT_EQ(histogram.Min(), 0);
+  EXPECT_EQ(histogram.Max(), 0);
+  EXPECT_EQ(histogram.ValueAtPercentile(50), 0);
+  EXPECT_EQ(histogram.Mean(), 0.0);
+}
+
+TEST(HdrHistogramTest, BucketsCoverEveryValue) {
+  // buckets follow each other, without hole nor overlap
+  uint64_t expected_low = 0;
+  for (int index = 0; index < HdrHistogram::kBucketCount; ++index) {
+    ASSERT_EQ(HdrHistogram::BucketIndex(expected_low), index);
+    const uint64_t top = HdrHistogram::BucketTop(index);
+    ASSERT_EQ(HdrHistogram::BucketIndex(top), index);
+    expected_low = top + 1;
+  }
+  // wrapped after UINT64_MAX
+  EXPECT_EQ(expected_low, 0);
+}
+
+TEST(HdrHistogramTest, PercentilesWithinPrecision) {
+  HdrHistogram histogram;
+  for (uint64_t value = 1; value <= 100000; ++value) {
+    histogram.Record(value);
+  }
+
+  EXPECT_EQ(histogram.Count(), 100000);
+  EXPECT_EQ(histogram.Min(), 1);
+  EXPECT_EQ(histogram.Max(), 100000);
+  EXPECT_DOUBLE_EQ(histogram.Mean(), 50000.5);
+
+  const double precision = 2.0 / HdrHistogram::kSubBuckets;
+  for (double percent : {1.0, 50.0, 90.0, 99.0, 99.9}) {
+    const double exact = percent * 1000;
+    const double value =
+        static_cast<double>(histogram.ValueAtPercentile(percent));
+    EXPECT_GE(value, exact) << "p" << percent;
+    EXPECT_LE(value, exact * (1 + precision)) << "p" << percent;
+  }
+  EXPECT_EQ(histogram.ValueAtPercentile(100), 100000);
+}
+
+TEST(HdrHistogramTest, ConcurrentRecords) {
+  constexpr int kThreads = 8;
+  constexpr int kRecordsPerThread = 100000;
+
+  HdrHistogram histogram;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kThreads; ++t) {
+    threads.emplace_back([&histogram, t] {
+      for (int i = 0; i < kRecordsPerThread; ++i) {
+        histogram.Record(static_cast<uint64_t>(t * kRecordsPerThread + i));
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  EXPECT_EQ(histogram.Count(), kThreads * kRecordsPerThread);
+  EXPECT_EQ(histogram.Min(), 0);
+  EXPECT_EQ(histogram.Max(), kThreads * kRecordsPerThread - 1);
+}
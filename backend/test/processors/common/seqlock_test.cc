@@ -0,0 +1,75 @@
+#include <atomic>
+#include <gtest/gtest.h>
+#include <thread>
+
+#include "processors/common/seqlock.h"
+
+namespace {
+
+struct Pair {
+  long long first;
+  long long second;
+};
+
+} // namespace
+
+TEST(SeqLockTest, EmptySlot) {
+  SeqLock<Pair> slot;
+  Pair value{1, 1};
+
+  EXPECT_EQ(slot.Sequence(), 0);
+  EXPECT_EQ(slot.Load(value), 0);
+  EXPECT_EQ(value.first, 0);
+  EXPECT_EQ(value.second, 0);
+}
+
+TEST(SeqLockTest, SequenceCountsStores) {
+  SeqLock<Pair> slot;
+  Pair value{};
+
+  slot.Store({1, 2});
+  EXPECT_EQ(slot.Load(value), 2);
+  EXPECT_EQ(value.first, 1);
+  EXPECT_EQ(value.second, 2);
+
+  slot.Store({3, 4});
+  slot.Store({5, 6});
+  // two stores since the last load
+  EXPECT_EQ((slot.Load(value) - 2) / 2, 2);
+  EXPECT_EQ(value.first, 5);
+  EXPECT_EQ(value.second, 6);
+}
+
+// the writer keeps both halves equal, a torn read would see them differ
+TEST(SeqLockTest, ReaderNeverSeesTornValue) {
+  constexpr long long kStores = 200000;
+  SeqLock<Pair> slot;
+  std::atomic<bool> done{false};
+  bool torn = false;
+  uint64_t last_sequence = 0;
+  bool went_back = false;
+
+  std::thread reader([&] {
+    Pair value{};
+    while (!done) {
+      const uint64_t sequence = slot.Load(value);
+      if (value.first != value.second) {
+        torn = true;
+      }
+      if (sequence < last_sequence) {
+        went_back = true;
+      }
+      last_sequence = sequence;
+    }
+  });
+
+  for (long long i = 1; i <= kStores; ++i) {
+    slot.Store({i, i});
+  }
+  done = true;
+  reader.join();
+
+  EXPECT_FALSE(torn);
+  EXPECT_FALSE(went_back);
+  EXPECT_EQ(slot.Sequence(), 2 * kStores);
+}
@@ -0,0 +1,255 @@
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <gtest/gtest.h>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "processors/common/inplace_function.h"
+#include "processors/common/task_store.h"
+#include "processors/common/timers.h"
+
+using namespace std::chrono;
+
+// -----------------------------------------------------------------------------
+// every operator new of the test binary is counted
+// -----------------------------------------------------------------------------
+namespace {
+
+std::atomic<unsigned long long> allocation_count{0};
+
+} // namespace
+
+void *operator new(std::size_t size) {
+  allocation_count.fetch_add(1, std::memory_order_relaxed);
+  if (void *ptr = std::malloc(size == 0 ? 1 : size)) {
+    return ptr;
+  }
+  throw std::bad_alloc();
+}
+
+// out of line, inlined at a delete expression the free would be paired
+// with the operator new of its new expression
+[[gnu::noinline]] void operator delete(void *ptr) noexcept { std::free(ptr); }
+[[gnu::noinline]] void operator delete(void *ptr, std::size_t) noexcept {
+  std::free(ptr);
+}
+
+namespace {
+
+constexpr int kTimers = 200;
+constexpr int kRepeat = 5;
+
+// creates kTimers timers firing kRepeat times and waits for all of them
+void FireRound(TimerManager &manager, std::atomic<int> &fired) {
+  for (int i = 0; i < kTimers; ++i) {
+    manager.CreateTimer([&fired] { fired++; }, milliseconds(1 + i % 4),
+                        kRepeat);
+  }
+  manager.WaitTillLast(0);
+}
+
+unsigned long long AllocationsPerRound(const TimerConfig &config) {
+  TimerManager manager(config);
+  std::atomic<int> fired{0};
+
+  // warmup, the store, the queue and the executor grow here
+  FireRound(manager, fired);
+  FireRound(manager, fired);
+
+  const unsigned long long before = allocation_count.load();
+  FireRound(manager, fired);
+  const unsigned long long after = allocation_count.load();
+
+  EXPECT_EQ(fired.load(), 3 * kTimers * kRepeat);
+  return after - before;
+}
+
+} // namespace
+
+// -----------------------------------------------------------------------------
+// InplaceFunction
+// -----------------------------------------------------------------------------
+TEST(InplaceFunctionTest, SmallClosureDoesNotAllocate) {
+  int value = 0;
+  std::array<char, 40> payload{};
+
+  const unsigned long long before = allocation_count.load();
+  InplaceFunction<void(), 64> function([&value, payload]() mutable {
+    payload[0]++;
+    value += payload[0];
+  });
+  InplaceFunction<void(), 64> moved(std::move(function));
+  moved();
+  moved();
+  const unsigned long long after = allocation_count.load();
+
+  EXPECT_EQ(after - before, 0);
+  EXPECT_FALSE(function);
+  EXPECT_EQ(value, 3);
+}
+
+TEST(InplaceFunctionTest, BigClosureIsMovedToTheHeap) {
+  std::array<char, 128> payload{};
+  payload[0] = 7;
+
+  using Function = InplaceFunction<int(int), 32>;
+  EXPECT_FALSE(Function::StoredInline<decltype(payload)>());
+
+  const unsigned long long before = allocation_count.load();
+  Function function([payload](int add) { return payload[0] + add; });
+  EXPECT_EQ(allocation_count.load() - before, 1);
+
+  Function moved(std::move(function));
+  EXPECT_EQ(allocation_count.load() - before, 1);
+  EXPECT_EQ(moved(3), 10);
+}
+
+TEST(InplaceFunctionTest, DestroysTheClosure) {
+  auto counter = std::make_shared<int>(0);
+
+  {
+    InplaceFunction<void()> function([counter] { (*counter)++; });
+    function();
+    EXPECT_EQ(counter.use_count(), 2);
+
+    function = nullptr;
+    EXPECT_EQ(counter.use_count(), 1);
+  }
+
+  EXPECT_EQ(*counter, 1);
+}
+
+// -----------------------------------------------------------------------------
+// TaskStore
+// -----------------------------------------------------------------------------
+TEST(TaskStoreTest, RecyclesTasks) {
+  TaskStore store(4);
+
+  Task *first = store.Acquire();
+  EXPECT_EQ(store.Capacity(), 4);
+  EXPECT_EQ(store.InUse(), 1);
+
+  store.Release(first);
+  EXPECT_EQ(store.InUse(), 0);
+
+  // the last released task is given back first
+  EXPECT_EQ(store.Acquire(), first);
+}
+
+TEST(TaskStoreTest, GrowsByChunks) {
+  TaskStore store(4);
+  std::vector<Task *> tasks;
+
+  for (int i = 0; i < 9; ++i) {
+    tasks.push_back(store.Acquire());
+  }
+
+  EXPECT_EQ(store.Capacity(), 12);
+  EXPECT_EQ(store.InUse(), 9);
+
+  for (Task *task : tasks) {
+    store.Release(task);
+  }
+
+  const unsigned long long before = allocation_count.load();
+  for (int i = 0; i < 12; ++i) {
+    store.Acquire();
+  }
+  EXPECT_EQ(allocation_count.load() - before, 0);
+  EXPECT_EQ(store.Capacity(), 12);
+}
+
+TEST(TaskStoreTest, FindRejectsStaleIds) {
+  TaskStore store(4);
+
+  Task *task = store.Acquire();
+  const TimerId id = TaskStore::Id(task);
+  EXPECT_NE(id, kInvalidTimerId);
+  EXPECT_EQ(store.Find(id), task);
+
+  // same task, another generation
+  store.Release(task);
+  EXPECT_EQ(store.Acquire(), task);
+  EXPECT_EQ(store.Find(id), nullptr);
+  EXPECT_EQ(store.Find(TaskStore::Id(task)), task);
+
+  EXPECT_EQ(store.Find(kInvalidTimerId), nullptr);
+  EXPECT_EQ(store.Find(TaskStore::Id(task) + 100), nullptr);
+}
+
+TEST(TaskStoreTest, ReleaseDestroysTheCallable) {
+  TaskStore store;
+  auto counter = std::make_shared<int>(0);
+
+  Task *task = store.Acquire();
+  task->task = [counter] { (*counter)++; };
+  EXPECT_EQ(counter.use_count(), 2);
+
+  store.Release(task);
+  EXPECT_EQ(counter.use_count(), 1);
+}
+
+TEST(TaskStoreTest, ConcurrentAcquireRelease) {
+  constexpr int kThreads = 8;
+  constexpr int kLoops = 20000;
+
+  TaskStore store(16);
+  std::atomic<int> stolen{0};
+  std::vector<std::thread> threads;
+
+  for (int t = 0; t < kThreads; ++t) {
+    threads.emplace_back([&, t] {
+      Task *held[3];
+      for (int i = 0; i < kLoops; ++i) {
+        for (Task *&task : held) {
+          task = store.Acquire();
+          task->repeat = t;
+        }
+        // a task given to two threads at once would be overwritten
+        for (Task *task : held) {
+          if (task->repeat != t) {
+            stolen++;
+          }
+          store.Release(task);
+        }
+      }
+    });
+  }
+
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  EXPECT_EQ(stolen.load(), 0);
+  EXPECT_EQ(store.InUse(), 0);
+  EXPECT_LE(store.Capacity(), 16 * 7);
+}
+
+// -----------------------------------------------------------------------------
+// TimerManager: no operator new per fire once warmed up
+// -----------------------------------------------------------------------------
+TEST(TimerAllocationTest, HeapNoAllocationAfterWarmup) {
+  TimerConfig config;
+  config.backend = TimerBackend::Heap;
+
+  EXPECT_EQ(AllocationsPerRound(config), 0);
+}
+
+TEST(TimerAllocationTest, WheelNoAllocationAfterWarmup) {
+  TimerConfig config;
+  config.backend = TimerBackend::Wheel;
+
+  EXPECT_EQ(AllocationsPerRound(config), 0);
+}
+
+TEST(TimerAllocationTest, ExecutorNoAllocationAfterWarmup) {
+  TimerConfig config;
+  config.backend = TimerBackend::Wheel;
+  config.worker_threads = 4;
+
+  EXPECT_EQ(AllocationsPerRound(config), 0);
+}
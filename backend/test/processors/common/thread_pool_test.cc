@@ -0,0 +1,65 @@
+#include <atomic>
+#include <chrono>
+#include <gtest/gtest.h>
+#include <thread>
+
+#include "processors/common/thread_pool.h"
+
+using namespace std::chrono;
+
+TEST(ThreadPoolTest, RunsEveryJob) {
+  constexpr int kJobs = 10000;
+  std::atomic<int> done{0};
+
+  {
+    ThreadPool pool(4);
+    EXPECT_EQ(pool.Size(), 4);
+
+    for (int i = 0; i < kJobs; ++i) {
+      pool.Submit([&done] { done++; });
+    }
+  }
+
+  // the destructor runs what was submitted
+  EXPECT_EQ(done.load(), kJobs);
+}
+
+TEST(ThreadPoolTest, ZeroThreadsStillRuns) {
+  std::atomic<int> done{0};
+
+  {
+    ThreadPool pool(0);
+    EXPECT_EQ(pool.Size(), 1);
+    pool.Submit([&done] { done++; });
+  }
+
+  EXPECT_EQ(done.load(), 1);
+}
+
+// every job is submitted from the same worker, so they all land
+// in its queue, the other workers have to steal them
+TEST(ThreadPoolTest, IdleWorkersSteal) {
+  constexpr int kJobs = 8;
+  std::atomic<int> running{0};
+  std::atomic<int> max_running{0};
+
+  {
+    ThreadPool pool(4);
+
+    pool.Submit([&] {
+      for (int i = 0; i < kJobs; ++i) {
+        pool.Submit([&] {
+          const int now_running = ++running;
+          int expected = max_running.load();
+          while (now_running > expected &&
+                 !max_running.compare_exchange_weak(expected, now_running)) {
+          }
+          std::this_thread::sleep_for(milliseconds(20));
+          running--;
+        });
+      }
+    });
+  }
+
+  EXPECT_GT(max_running.load(), 1);
+}
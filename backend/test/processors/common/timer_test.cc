@@ -1,5 +1,8 @@
+#include <atomic>
 #include <chrono>
+#include <functional>
 #include <gtest/gtest.h>
+#include <thread>
 #include <vector>
 
 #include "processors/common/timers.h"
@@ -224,3 +227,592 @@ TEST(TimerTest, HeavyLoadManyTimers) {
         << make_msg(expected, actual, now, kLargeTolerance);
   }
 }
+
+// -----------------------------------------------------------------------------
+// Timing wheel backend: same scenarios, deadlines are rounded up to a tick
+// -----------------------------------------------------------------------------
+TEST(TimerTest, WheelBackendMultipleTimers) {
+  TimerConfig config;
+  config.backend = TimerBackend::Wheel;
+  const microseconds tolerance = kTolerance + config.wheel_tick;
+
+  TimerManager manager(config);
+  std::vector<std::vector<steady_clock::time_point>> result(kTimerCount);
+  const auto now = steady_clock::now();
+
+  manager.CreateTimer([&] { result[T0].push_back(steady_clock::now()); },
+                      kShortDelay, kTimer0Repeat);
+  manager.CreateTimer([&] { result[T1].push_back(steady_clock::now()); },
+                      kLongDelay, kTimer1Repeat);
+  manager.CreateTimer([&] { result[T2].push_back(steady_clock::now()); },
+                      kShortDelay, kTimer2Repeat);
+  manager.CreateTimer([&] { result[T3].push_back(steady_clock::now()); },
+                      kLongDelay, kTimer3Repeat);
+
+  EXPECT_EQ(manager.GetActiveTimerCount(), kTimerCount);
+
+  manager.WaitTillLast(1);
+
+  EXPECT_EQ(result[T0].size(), kTimer0Repeat);
+  EXPECT_EQ(result[T1].size(), kTimer1Repeat);
+  EXPECT_EQ(result[T2].size(), kTimer2Repeat);
+  EXPECT_EQ(result[T3].size(), 1);
+
+  auto validate = [&](int timerIndex, seconds delay, int repeats) {
+    for (int i = 0; i < repeats; ++i) {
+      auto expected = expected_fire_time(now, delay, i);
+      auto actual = result[timerIndex][i];
+      EXPECT_GE(actual, expected) << "Timer " << timerIndex << " fired early";
+      EXPECT_TRUE(almost_equal(actual, expected, tolerance))
+          << "Timer " << timerIndex << " index " << i << " fired incorrectly.\n"
+          << make_msg(expected, actual, now, tolerance);
+    }
+  };
+
+  validate(T0, kShortDelay, kTimer0Repeat);
+  validate(T1, kLongDelay, kTimer1Repeat);
+  validate(T2, kShortDelay, kTimer2Repeat);
+  validate(T3, kLongDelay, 1);
+
+  EXPECT_EQ(manager.GetActiveTimerCount(), 1);
+}
+
+TEST(TimerTest, WheelBackendManyShortTimers) {
+  constexpr int kNumTimers = 5000;
+  constexpr int kRepeats = 3;
+
+  TimerConfig config;
+  config.backend = TimerBackend::Wheel;
+
+  TimerManager manager(config);
+  std::vector<int> fired(kNumTimers, 0);
+
+  for (int i = 0; i < kNumTimers; ++i) {
+    manager.CreateTimer([&fired, i] { fired[i]++; }, milliseconds(1 + i % 50),
+                        kRepeats);
+  }
+
+  manager.WaitTillLast(0);
+
+  for (int i = 0; i < kNumTimers; ++i) {
+    EXPECT_EQ(fired[i], kRepeats) << "Timer " << i;
+  }
+}
+
+// -----------------------------------------------------------------------------
+// Executor: a slow timer must not delay the others
+// and a repeating timer never runs twice at the same time
+// -----------------------------------------------------------------------------
+TEST(TimerTest, ExecutorSlowTimerDoesNotDelayOthers) {
+  constexpr milliseconds kSlowDelay{10};
+  constexpr milliseconds kSlowDuration{200};
+  constexpr milliseconds kFastDelay{50};
+  constexpr int kFastRepeat = 5;
+
+  TimerConfig config;
+  config.worker_threads = 2;
+
+  TimerManager manager(config);
+  std::vector<steady_clock::time_point> fast_fires;
+
+  const auto now = steady_clock::now();
+  manager.CreateTimer([&] { std::this_thread::sleep_for(kSlowDuration); },
+                      kSlowDelay, 1);
+  manager.CreateTimer([&] { fast_fires.push_back(steady_clock::now()); },
+                      kFastDelay, kFastRepeat);
+
+  manager.WaitTillLast(0);
+
+  ASSERT_EQ(fast_fires.size(), kFastRepeat);
+  for (int i = 0; i < kFastRepeat; ++i) {
+    const auto expected = now + kFastDelay * (i + 1);
+    EXPECT_TRUE(almost_equal(fast_fires[i], expected, kLargeTolerance))
+        << "fast timer index " << i << " delayed by the slow one.\n"
+        << make_msg(expected, fast_fires[i], now, kLargeTolerance);
+  }
+}
+
+TEST(TimerTest, ExecutorRepeatingTimerNeverOverlaps) {
+  constexpr milliseconds kDelay{5};
+  constexpr milliseconds kDuration{20};
+  constexpr int kRepeat = 10;
+
+  TimerConfig config;
+  config.worker_threads = 4;
+
+  TimerManager manager(config);
+  std::atomic<int> running{0};
+  std::atomic<int> overlaps{0};
+  std::atomic<int> fired{0};
+
+  manager.CreateTimer(
+      [&] {
+        if (running.fetch_add(1) != 0) {
+          overlaps++;
+        }
+        std::this_thread::sleep_for(kDuration);
+        fired++;
+        running--;
+      },
+      kDelay, kRepeat);
+
+  manager.WaitTillLast(0);
+
+  EXPECT_EQ(fired.load(), kRepeat);
+  EXPECT_EQ(overlaps.load(), 0);
+  EXPECT_EQ(manager.GetActiveTimerCount(), 0);
+}
+
+TEST(TimerTest, ExecutorHeavyLoadManyTimers) {
+  constexpr int kNumTimers = 2000;
+  constexpr int kMaxRepeats = 3;
+
+  TimerConfig config;
+  config.backend = TimerBackend::Wheel;
+  config.worker_threads = 4;
+
+  TimerManager manager(config);
+  std::vector<std::atomic<int>> fired(kNumTimers);
+
+  for (int i = 0; i < kNumTimers; ++i) {
+    manager.CreateTimer([&fired, i] { fired[i]++; }, milliseconds(1 + i % 20),
+                        1 + i % kMaxRepeats);
+  }
+
+  manager.WaitTillLast(0);
+
+  for (int i = 0; i < kNumTimers; ++i) {
+    EXPECT_EQ(fired[i].load(), 1 + i % kMaxRepeats) << "Timer " << i;
+  }
+}
+
+// -----------------------------------------------------------------------------
+// Cancel and Reschedule, with every backend and with the executor
+// -----------------------------------------------------------------------------
+namespace {
+
+std::vector<TimerConfig> all_configs() {
+  TimerConfig heap;
+  TimerConfig wheel;
+  wheel.backend = TimerBackend::Wheel;
+  TimerConfig executor;
+  executor.backend = TimerBackend::Wheel;
+  executor.worker_threads = 2;
+  return {heap, wheel, executor};
+}
+
+} // namespace
+
+TEST(TimerTest, CancelStopsRepeatingTimer) {
+  constexpr milliseconds kDelay{10};
+
+  for (const auto &config : all_configs()) {
+    TimerManager manager(config);
+    std::atomic<int> fired{0};
+
+    const TimerId id = manager.CreateTimer([&] { fired++; }, kDelay, -1);
+    manager.CreateTimer([] {}, kDelay * 10, 1);
+
+    std::this_thread::sleep_for(kDelay * 3 + kDelay / 2);
+    EXPECT_TRUE(manager.Cancel(id));
+    EXPECT_EQ(manager.GetActiveTimerCount(), 1);
+
+    // the repeating timer alone would never let it return
+    manager.WaitTillLast(0);
+
+    const int fired_at_cancel = fired.load();
+    EXPECT_GE(fired_at_cancel, 2);
+    std::this_thread::sleep_for(kDelay * 3);
+    EXPECT_EQ(fired.load(), fired_at_cancel);
+
+    EXPECT_FALSE(manager.Cancel(id));
+    EXPECT_FALSE(manager.Reschedule(id, kDelay));
+  }
+}
+
+TEST(TimerTest, CancelBeforeFirstFire) {
+  for (const auto &config : all_configs()) {
+    TimerManager manager(config);
+    std::atomic<int> fired{0};
+
+    const TimerId id = manager.CreateTimer([&] { fired++; }, milliseconds(20), 1);
+    EXPECT_TRUE(manager.Cancel(id));
+    EXPECT_EQ(manager.GetActiveTimerCount(), 0);
+
+    manager.WaitTillLast(0);
+    std::this_thread::sleep_for(milliseconds(40));
+    EXPECT_EQ(fired.load(), 0);
+  }
+}
+
+TEST(TimerTest, CancelFinishedTimerFails) {
+  for (const auto &config : all_configs()) {
+    TimerManager manager(config);
+
+    const TimerId id = manager.CreateTimer([] {}, milliseconds(1), 1);
+    manager.WaitTillLast(0);
+    EXPECT_FALSE(manager.Cancel(id));
+
+    // the task of the finished timer is reused by the next one
+    // the old id must not cancel it
+    std::atomic<int> fired{0};
+    manager.CreateTimer([&] { fired++; }, milliseconds(5), 1);
+    EXPECT_FALSE(manager.Cancel(id));
+    manager.WaitTillLast(0);
+    EXPECT_EQ(fired.load(), 1);
+
+    EXPECT_FALSE(manager.Cancel(kInvalidTimerId));
+  }
+}
+
+TEST(TimerTest, CancelFromCallback) {
+  constexpr int kCancelAt = 3;
+
+  for (const auto &config : all_configs()) {
+    TimerManager manager(config);
+    std::atomic<int> fired{0};
+    std::atomic<TimerId> id{kInvalidTimerId};
+
+    id = manager.CreateTimer(
+        [&] {
+          if (++fired == kCancelAt) {
+            manager.Cancel(id);
+          }
+        },
+        milliseconds(2), -1);
+
+    manager.WaitTillLast(0);
+    std::this_thread::sleep_for(milliseconds(10));
+    EXPECT_EQ(fired.load(), kCancelAt);
+  }
+}
+
+TEST(TimerTest, ManyCancelledTimers) {
+  constexpr int kNumTimers = 1000;
+
+  for (const auto &config : all_configs()) {
+    TimerManager manager(config);
+    std::vector<std::atomic<int>> fired(kNumTimers);
+    std::vector<TimerId> ids;
+
+    for (int i = 0; i < kNumTimers; ++i) {
+      ids.push_back(manager.CreateTimer([&fired, i] { fired[i]++; },
+                                        milliseconds(20 + i % 20), 2));
+    }
+    for (int i = 0; i < kNumTimers; i += 2) {
+      EXPECT_TRUE(manager.Cancel(ids[i]));
+    }
+    EXPECT_EQ(manager.GetActiveTimerCount(), kNumTimers / 2);
+
+    manager.WaitTillLast(0);
+
+    for (int i = 0; i < kNumTimers; ++i) {
+      EXPECT_EQ(fired[i].load(), i % 2 == 0 ? 0 : 2) << "Timer " << i;
+    }
+  }
+}
+
+TEST(TimerTest, RescheduleMovesNextFire) {
+  constexpr milliseconds kDelay{200};
+  constexpr milliseconds kEarlier{20};
+  constexpr milliseconds kLater{300};
+
+  for (const auto &config : all_configs()) {
+    TimerManager manager(config);
+    std::vector<steady_clock::time_point> early_fires;
+    steady_clock::time_point late_fire;
+
+    const TimerId early =
+        manager.CreateTimer([&] { early_fires.push_back(steady_clock::now()); },
+                            kDelay, 2);
+    const TimerId late = manager.CreateTimer(
+        [&] { late_fire = steady_clock::now(); }, kDelay, 1);
+
+    const auto now = steady_clock::now();
+    EXPECT_TRUE(manager.Reschedule(early, kEarlier));
+    EXPECT_TRUE(manager.Reschedule(late, kLater));
+    EXPECT_EQ(manager.GetActiveTimerCount(), 2);
+
+    manager.WaitTillLast(0);
+
+    // the new delay is also the new interval
+    ASSERT_EQ(early_fires.size(), 2);
+    for (int i = 0; i < 2; ++i) {
+      const auto expected = now + kEarlier * (i + 1);
+      EXPECT_TRUE(almost_equal(early_fires[i], expected, kLargeTolerance))
+          << make_msg(expected, early_fires[i], now, kLargeTolerance);
+    }
+    EXPECT_TRUE(almost_equal(late_fire, now + kLater, kLargeTolerance))
+        << make_msg(now + kLater, late_fire, now, kLargeTolerance);
+
+    EXPECT_FALSE(manager.Reschedule(late, kDelay));
+  }
+}
+
+// -----------------------------------------------------------------------------
+// Many threads creating timers at the same time, through the intake
+// -----------------------------------------------------------------------------
+TEST(TimerTest, ConcurrentProducers) {
+  constexpr int kProducers = 8;
+  constexpr int kTimersPerProducer = 500;
+  constexpr int kRepeat = 2;
+
+  for (const auto &config : all_configs()) {
+    TimerManager manager(config);
+    std::vector<std::atomic<int>> fired(kProducers * kTimersPerProducer);
+    std::vector<std::thread> producers;
+
+    for (int p = 0; p < kProducers; ++p) {
+      producers.emplace_back([&, p] {
+        for (int i = 0; i < kTimersPerProducer; ++i) {
+          const int index = p * kTimersPerProducer + i;
+          manager.CreateTimer([&fired, index] { fired[index]++; },
+                              milliseconds(index % 7), kRepeat);
+        }
+      });
+    }
+
+    for (auto &producer : producers) {
+      producer.join();
+    }
+    EXPECT_GE(manager.GetTimerCount(), kProducers * kTimersPerProducer);
+
+    manager.WaitTillLast(0);
+
+    for (std::size_t i = 0; i < fired.size(); ++i) {
+      EXPECT_EQ(fired[i].load(), kRepeat) << "Timer " << i;
+    }
+  }
+}
+
+// timers created by the callbacks of other timers
+TEST(TimerTest, CreateTimerFromCallbacks) {
+  constexpr int kChains = 50;
+  constexpr int kLength = 20;
+
+  for (const auto &config : all_configs()) {
+    TimerManager manager(config);
+    std::atomic<int> fired{0};
+
+    std::function<void(int)> chain = [&](int left) {
+      fired++;
+      if (left > 1) {
+        manager.CreateTimer([&chain, left] { chain(left - 1); },
+                            milliseconds(1), 1);
+      }
+    };
+
+    for (int i = 0; i < kChains; ++i) {
+      manager.CreateTimer([&chain] { chain(kLength); }, milliseconds(1), 1);
+    }
+
+    manager.WaitTillLast(0);
+    EXPECT_EQ(fired.load(), kChains * kLength);
+  }
+}
+
+// -----------------------------------------------------------------------------
+// Hybrid wait, sleeps then spins before each deadline
+// -----------------------------------------------------------------------------
+TEST(TimerTest, HybridWaitSubMillisecondTimer) {
+  constexpr microseconds kDelay{500};
+  constexpr int kRepeat = 20;
+
+  TimerConfig config;
+  config.wait = TimerWait::Hybrid;
+  TimerManager manager(config);
+  std::vector<steady_clock::time_point> fires;
+
+  const auto now = steady_clock::now();
+  manager.CreateTimer([&] { fires.push_back(steady_clock::now()); }, kDelay,
+                      kRepeat);
+  manager.WaitTillLast(0);
+
+  ASSERT_EQ(fires.size(), kRepeat);
+  for (int i = 0; i < kRepeat; ++i) {
+    const auto expected = now + kDelay * (i + 1);
+    // never early, the spin ends at the deadline
+    EXPECT_GE(fires[i], expected) << "Fire " << i;
+    EXPECT_TRUE(almost_equal(fires[i], expected, kLargeTolerance))
+        << make_msg(expected, fires[i], now, kLargeTolerance);
+  }
+}
+
+// a timer moved earlier while the timer thread spins for another one
+TEST(TimerTest, HybridWaitRescheduleDuringSpin) {
+  constexpr milliseconds kDelay{50};
+  constexpr milliseconds kEarlier{5};
+
+  TimerConfig config;
+  config.wait = TimerWait::Hybrid;
+  config.spin_window = milliseconds(100);
+  TimerManager manager(config);
+  steady_clock::time_point first_fire;
+  steady_clock::time_point moved_fire;
+
+  manager.CreateTimer([&] { first_fire = steady_clock::now(); }, kDelay, 1);
+  const TimerId moved = manager.CreateTimer(
+      [&] { moved_fire = steady_clock::now(); }, kDelay * 2, 1);
+
+  // the deadline is in the spin window, the thread already spins
+  std::this_thread::sleep_for(milliseconds(1));
+  const auto now = steady_clock::now();
+  EXPECT_TRUE(manager.Reschedule(moved, kEarlier));
+
+  manager.WaitTillLast(0);
+
+  EXPECT_LT(moved_fire, first_fire);
+  EXPECT_TRUE(almost_equal(moved_fire, now + kEarlier, kLargeTolerance))
+      << make_msg(now + kEarlier, moved_fire, now, kLargeTolerance);
+}
+
+// -----------------------------------------------------------------------------
+// Simulated clock, the timer thread jumps to the deadlines
+// -----------------------------------------------------------------------------
+namespace {
+
+std::vector<TimerConfig> simulated_configs(SimulatedClock &clock) {
+  std::vector<TimerConfig> configs = all_configs();
+  for (auto &config : configs) {
+    config.clock = &clock;
+  }
+  return configs;
+}
+
+} // namespace
+
+TEST(TimerTest, SimulatedClockFiresAtExactDeadlines) {
+  constexpr hours kDelay{1};
+  constexpr int kRepeat = 24;
+
+  SimulatedClock clock;
+  for (const auto &config : simulated_configs(clock)) {
+    TimerManager manager(config);
+    std::vector<steady_clock::time_point> fires;
+
+    const auto start = clock.Now();
+    manager.CreateTimer([&] { fires.push_back(clock.Now()); }, kDelay,
+                        kRepeat);
+
+    const auto real_start = steady_clock::now();
+    manager.WaitTillLast(0);
+
+    // a day in much less than a second
+    EXPECT_LT(steady_clock::now() - real_start, seconds(1));
+
+    ASSERT_EQ(fires.size(), kRepeat);
+    for (int i = 0; i < kRepeat; ++i) {
+      // the wheel rounds up to its tick
+      EXPECT_TRUE(almost_equal(fires[i], start + kDelay * (i + 1),
+                               config.wheel_tick))
+          << "Fire " << i;
+      EXPECT_GE(fires[i], start + kDelay * (i + 1)) << "Fire " << i;
+    }
+  }
+}
+
+// the time doesn't move while timers are still being created
+TEST(TimerTest, SimulatedClockWaitsForWaitTillLast) {
+  SimulatedClock clock;
+  TimerConfig config;
+  config.clock = &clock;
+  TimerManager manager(config);
+  std::vector<steady_clock::time_point> fires;
+
+  const auto start = clock.Now();
+  manager.CreateTimer([&] { fires.push_back(clock.Now()); }, seconds(10), 1);
+  std::this_thread::sleep_for(milliseconds(20));
+  EXPECT_EQ(clock.Now(), start);
+
+  manager.CreateTimer([&] { fires.push_back(clock.Now()); }, seconds(10), 1);
+  manager.WaitTillLast(0);
+
+  ASSERT_EQ(fires.size(), 2);
+  EXPECT_EQ(fires[0], start + seconds(10));
+  EXPECT_EQ(fires[1], start + seconds(10));
+}
+
+// timers created by callbacks start from the time of the fire,
+// with the executor too
+TEST(TimerTest, SimulatedClockChainsAreDeterministic) {
+  constexpr int kChains = 20;
+  constexpr int kLength = 10;
+
+  SimulatedClock clock;
+  for (const auto &config : simulated_configs(clock)) {
+    TimerManager manager(config);
+    std::atomic<int> fired{0};
+    std::atomic<int> late{0};
+
+    std::function<void(int, steady_clock::time_point)> chain =
+        [&](int left, steady_clock::time_point due) {
+          fired++;
+          if (clock.Now() < due || clock.Now() > due + config.wheel_tick) {
+            late++;
+          }
+          if (left > 1) {
+            const auto next_due = clock.Now() + minutes(left);
+            manager.CreateTimer(
+                [&chain, left, next_due] { chain(left - 1, next_due); },
+                minutes(left), 1);
+          }
+        };
+
+    const auto start = clock.Now();
+    for (int i = 0; i < kChains; ++i) {
+      const auto due = start + seconds(i + 1);
+      manager.CreateTimer([&chain, due] { chain(kLength, due); },
+                          seconds(i + 1), 1);
+    }
+
+    manager.WaitTillLast(0);
+    EXPECT_EQ(fired.load(), kChains * kLength);
+    EXPECT_EQ(late.load(), 0);
+  }
+}
+
+// -----------------------------------------------------------------------------
+// Fire statistics
+// -----------------------------------------------------------------------------
+TEST(TimerTest, StatsRecordEveryFire) {
+  constexpr milliseconds kDelay{5};
+  constexpr milliseconds kRunTime{2};
+  constexpr int kRepeat = 5;
+  constexpr int kTimers = 3;
+
+  for (const auto &config : all_configs()) {
+    TimerManager manager(config);
+
+    for (int i = 0; i < kTimers; ++i) {
+      manager.CreateTimer([&] { std::this_thread::sleep_for(kRunTime); },
+                          kDelay, kRepeat);
+    }
+    manager.WaitTillLast(0);
+
+    const TimerStats &stats = manager.GetStats();
+    EXPECT_EQ(stats.lateness.Count(), kTimers * kRepeat);
+    EXPECT_EQ(stats.run_time.Count(), kTimers * kRepeat);
+    EXPECT_EQ(stats.queue_depth.Count(), kTimers * kRepeat);
+
+    EXPECT_GE(stats.run_time.Min(),
+              duration_cast<nanoseconds>(kRunTime).count());
+    // never more than the timers created
+    EXPECT_LE(stats.queue_depth.Max(), kTimers);
+
+    std::ostringstream os;
+    manager.DumpStats(os);
+    EXPECT_NE(os.str().find("lateness"), std::string::npos);
+  }
+}
+
+TEST(TimerTest, StatsCanBeDisabled) {
+  TimerConfig config;
+  config.record_stats = false;
+  TimerManager manager(config);
+
+  manager.CreateTimer([] {}, milliseconds(1), 3);
+  manager.WaitTillLast(0);
+
+  EXPECT_EQ(manager.GetStats().lateness.Count(), 0);
+  EXPECT_EQ(manager.GetStats().run_time.Count(), 0);
+}
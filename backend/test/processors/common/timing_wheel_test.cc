@@ -0,0 +1,167 @@
+#include <chrono>
+#include <gtest/gtest.h>
+#include <memory>
+#include <vector>
+
+#include "processors/common/timing_wheel.h"
+
+using namespace std::chrono;
+
+namespace {
+
+constexpr microseconds kTick{100};
+
+// the wheel doesn't own its tasks
+std::vector<std::unique_ptr<Task>> tasks;
+
+Task *make_task(steady_clock::time_point time_to_run) {
+  tasks.push_back(
+      std::make_unique<Task>(time_to_run, milliseconds(0), [] {}, 1));
+  return tasks.back().get();
+}
+
+} // namespace
+
+TEST(TimingWheelTest, EmptyWheel) {
+  const auto origin = steady_clock::now();
+  TimingWheel wheel(kTick, origin);
+
+  EXPECT_TRUE(wheel.Empty());
+  EXPECT_EQ(wheel.Size(), 0);
+  EXPECT_EQ(wheel.NextDeadline(), steady_clock::time_point::max());
+
+  std::vector<Task *> expired;
+  wheel.PopExpired(origin + seconds(10), expired);
+  EXPECT_TRUE(expired.empty());
+}
+
+TEST(TimingWheelTest, DeadlineRoundedUpToTick) {
+  const auto origin = steady_clock::now();
+  TimingWheel wheel(kTick, origin);
+
+  wheel.Push(make_task(origin + microseconds(250)));
+
+  EXPECT_EQ(wheel.Size(), 1);
+  EXPECT_EQ(wheel.NextDeadline(), origin + microseconds(300));
+
+  std::vector<Task *> expired;
+  wheel.PopExpired(origin + microseconds(299), expired);
+  EXPECT_TRUE(expired.empty());
+
+  wheel.PopExpired(origin + microseconds(300), expired);
+  EXPECT_EQ(expired.size(), 1);
+  EXPECT_TRUE(wheel.Empty());
+}
+
+TEST(TimingWheelTest, TasksSharingATickFireTogether) {
+  const auto origin = steady_clock::now();
+  TimingWheel wheel(kTick, origin);
+
+  for (int i = 0; i < 10; ++i) {
+    wheel.Push(make_task(origin + microseconds(1001 + i * 9)));
+  }
+
+  std::vector<Task *> expired;
+  wheel.PopExpired(origin + microseconds(1100), expired);
+  EXPECT_EQ(expired.size(), 10);
+}
+
+// every deadline is spread on several levels
+// so the tasks have to be cascaded down before firing
+TEST(TimingWheelTest, CascadesKeepDeadlineOrder) {
+  const auto origin = steady_clock::now();
+  TimingWheel wheel(kTick, origin);
+
+  const std::vector<microseconds> delays = {
+      microseconds(100),       microseconds(6'400),
+      microseconds(6'500),     microseconds(409'600),
+      microseconds(1'000'000), seconds(30),
+      minutes(10),             hours(30)};
+
+  for (auto it = delays.rbegin(); it != delays.rend(); ++it) {
+    wheel.Push(make_task(origin + *it));
+  }
+
+  std::vector<Task *> expired;
+  for (const auto &delay : delays) {
+    EXPECT_EQ(wheel.NextDeadline() <= origin + delay, true);
+
+    wheel.PopExpired(origin + delay - microseconds(1), expired);
+    EXPECT_TRUE(expired.empty()) << "fired early for " << delay.count();
+
+    wheel.PopExpired(origin + delay, expired);
+    ASSERT_EQ(expired.size(), 1) << "not fired for " << delay.count();
+    EXPECT_EQ(expired.front()->time_to_run, origin + delay);
+    expired.clear();
+  }
+
+  EXPECT_TRUE(wheel.Empty());
+}
+
+TEST(TimingWheelTest, PushAfterAdvance) {
+  const auto origin = steady_clock::now();
+  TimingWheel wheel(kTick, origin);
+  std::vector<Task *> expired;
+
+  wheel.PopExpired(origin + seconds(5), expired);
+
+  // already late, fires on the next check
+  wheel.Push(make_task(origin + seconds(1)));
+  EXPECT_LE(wheel.NextDeadline(), origin + seconds(5));
+  wheel.PopExpired(origin + seconds(5), expired);
+  EXPECT_EQ(expired.size(), 1);
+
+  wheel.Push(make_task(origin + seconds(7)));
+  wheel.PopExpired(origin + seconds(6), expired);
+  EXPECT_EQ(expired.size(), 1);
+  wheel.PopExpired(origin + seconds(7), expired);
+  EXPECT_EQ(expired.size(), 2);
+}
+
+// further than what the wheel can hold (2^36 ticks of 1ns here)
+// the task waits for the next rotations and must not fire early
+TEST(TimingWheelTest, BeyondRotationNeverFiresEarly) {
+  const auto origin = steady_clock::now();
+  TimingWheel wheel(nanoseconds(1), origin);
+
+  const auto far = origin + seconds(200);
+  wheel.Push(make_task(far));
+
+  std::vector<Task *> expired;
+  auto now = origin;
+  while (expired.empty()) {
+    now = std::min(wheel.NextDeadline(), far);
+    wheel.PopExpired(now, expired);
+  }
+
+  EXPECT_EQ(now, far);
+  EXPECT_TRUE(wheel.Empty());
+}
+
+TEST(TimingWheelTest, RemoveUnlinksTask) {
+  const auto origin = steady_clock::now();
+  TimingWheel wheel(kTick, origin);
+
+  // same slot, so the task removed is in the middle of the list
+  Task *first = make_task(origin + microseconds(500));
+  Task *removed = make_task(origin + microseconds(500));
+  Task *last = make_task(origin + microseconds(500));
+  Task *alone = make_task(origin + seconds(10));
+  wheel.Push(first);
+  wheel.Push(removed);
+  wheel.Push(last);
+  wheel.Push(alone);
+
+  wheel.Remove(removed);
+  wheel.Remove(alone);
+  EXPECT_EQ(wheel.Size(), 2);
+  EXPECT_EQ(wheel.NextDeadline(), origin + microseconds(500));
+
+  std::vector<Task *> expired;
+  wheel.PopExpired(origin + seconds(20), expired);
+  ASSERT_EQ(expired.size(), 2);
+  EXPECT_EQ(expired[0], first);
+  EXPECT_EQ(expired[1], last);
+  EXPECT_TRUE(wheel.Empty());
+  EXPECT_EQ(wheel.NextDeadline(), steady_clock::time_point::max());
+}
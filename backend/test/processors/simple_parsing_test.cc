@@ -17,6 +17,20 @@ constexpr std::string_view kScheduleWrongArgNumber =
     "Schedule(Start, 3s, another, another) {}";
 constexpr std::string_view kScheduleNotProperlyWritten =
     "Shcedule(Start, 3s, 3) {}";
+constexpr std::string_view kScheduleNamed = "Schedule(Start, 3s, 3, refresh) {"
+                                            "Print(\"hello world !\")"
+                                            "}\n"
+                                            "Reschedule(refresh, 5s)\n"
+                                            "Cancel(refresh)";
+constexpr std::string_view kScheduleSubSecond =
+    "Schedule(Start, 500ms, 3, refresh) {"
+    "Print(\"hello world !\")"
+    "}\n"
+    "Reschedule(refresh, 250us)";
+constexpr std::string_view kScheduleUnknownUnit = "Schedule(Start, 3h, 3) {"
+                                                  "Print(\"hello world !\")"
+                                                  "}";
+constexpr std::string_view kCancelUnknownTimer = "Cancel(refresh)";
 constexpr std::string_view kCorrectPrint = "Print(\"hello world 123\")";
 constexpr std::string_view kIncorrectPrint = "Print(hello world\")";
 constexpr std::string_view kPrintWithNumericLiteral = "Print(356)";
@@ -52,6 +66,10 @@ TEST(ScriptSubmit, TableDrivenValidation) {
       {"ScheduleWrongArgType", kScheduleWrongArgType, false},
       {"ScheduleWrongArgNumber", kScheduleWrongArgNumber, false},
       {"MisspelledScheduleKeyword", kScheduleNotProperlyWritten, false},
+      {"NamedSchedule", kScheduleNamed, true},
+      {"CancelUnknownTimer", kCancelUnknownTimer, false},
+      {"SubSecondSchedule", kScheduleSubSecond, true},
+      {"ScheduleUnknownUnit", kScheduleUnknownUnit, false},
   };
 
   for (const auto &tc : cases) {
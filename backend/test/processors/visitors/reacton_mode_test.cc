@@ -0,0 +1,60 @@
+#include <gtest/gtest.h>
+#include <iostream>
+
+#include "processors/visitors/concrete_fiscript_visitor.h"
+#include "processors/visitors/file_maker.h"
+
+TEST(ReactOnModeTest, ConflateMode) {
+  ConcreteFiScriptVisitor visitor;
+
+  std::string code =
+    "ReactOn(\"AAPL\", 20, conflate) {\n"
+    "    Print(\"latest\")\n"
+    "}\n";
+
+  EXPECT_TRUE(visitor.Compile(code));
+
+  const auto &commands = visitor.get_commands_list();
+  ASSERT_EQ(1, commands.size());
+
+  FileMaker maker(commands, "test_user", "test_script");
+  EXPECT_TRUE(maker.Compiled());
+
+  std::string generated = maker.GetCode();
+  std::cout << "Generated code for a conflating ReactOn:\n" << generated << std::endl;
+
+  EXPECT_NE(generated.find("RegisterReaction(\"AAPL\", 20, "), std::string::npos);
+  EXPECT_NE(generated.find("}, ReactionMode::Conflate);"), std::string::npos);
+}
+
+TEST(ReactOnModeTest, QueueModeIsTheDefault) {
+  ConcreteFiScriptVisitor visitor;
+
+  std::string code =
+    "ReactOn(\"AAPL\", 5, queue) {\n"
+    "    Print(\"every tick\")\n"
+    "}\n";
+
+  EXPECT_TRUE(visitor.Compile(code));
+
+  FileMaker maker(visitor.get_commands_list(), "test_user", "test_script");
+  EXPECT_TRUE(maker.Compiled());
+
+  std::string generated = maker.GetCode();
+  EXPECT_NE(generated.find("RegisterReaction(\"AAPL\", 5,"), std::string::npos);
+  EXPECT_EQ(generated.find("ReactionMode::Conflate"), std::string::npos);
+}
+
+TEST(ReactOnModeTest, UnknownMode) {
+  ConcreteFiScriptVisitor visitor;
+
+  std::string code =
+    "ReactOn(\"AAPL\", 5, latest) {\n"
+    "    Print(\"never\")\n"
+    "}\n";
+
+  EXPECT_TRUE(visitor.Compile(code));
+
+  FileMaker maker(visitor.get_commands_list(), "test_user", "test_script");
+  EXPECT_FALSE(maker.Compiled());
+}
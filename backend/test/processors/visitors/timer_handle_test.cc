@@ -0,0 +1,142 @@
+#include <gtest/gtest.h>
+#include <iostream>
+
+#include "processors/visitors/concrete_fiscript_visitor.h"
+#include "processors/visitors/file_maker.h"
+
+TEST(TimerHandleTest, CancelNamedTimer) {
+  ConcreteFiScriptVisitor visitor;
+
+  std::string code =
+    "Schedule(Start, 1s, 50, refresh) {\n"
+    "    Print(\"refreshing\")\n"
+    "}\n"
+    "Schedule(Start, 10s, 1) {\n"
+    "    Cancel(refresh)\n"
+    "}\n";
+
+  EXPECT_TRUE(visitor.Compile(code));
+
+  const auto &commands = visitor.get_commands_list();
+  ASSERT_EQ(2, commands.size());
+  ASSERT_EQ(1, commands[1].in_scope.size());
+  EXPECT_EQ(Command::CommandType::Cancel, commands[1].in_scope[0].type);
+
+  FileMaker maker(commands, "test_user", "test_script");
+  EXPECT_TRUE(maker.Compiled());
+
+  std::string generated = maker.GetCode();
+  std::cout << "Generated code for cancel:\n" << generated << std::endl;
+
+  size_t declaration =
+      generated.find("std::atomic<TimerId> refresh{kInvalidTimerId};");
+  size_t creation = generated.find(
+      "refresh = timer_manager.CreateTimer([=, &refresh]() mutable {");
+  EXPECT_NE(declaration, std::string::npos);
+  EXPECT_NE(creation, std::string::npos);
+  EXPECT_LT(declaration, creation);
+
+  EXPECT_NE(generated.find("CreateTimer([=, &timer_manager, &refresh]()"),
+            std::string::npos);
+  EXPECT_NE(generated.find("timer_manager.Cancel(refresh);"),
+            std::string::npos);
+}
+
+TEST(TimerHandleTest, RescheduleFromReactOn) {
+  ConcreteFiScriptVisitor visitor;
+
+  std::string code =
+    "ReactOn(\"AAPL\", 5) {\n"
+    "    Schedule(Start, 3s, 1, order_timer) {\n"
+    "        SendOrder(\"AAPL\", 100, 182.5)\n"
+    "    }\n"
+    "    Reschedule(order_timer, 5s)\n"
+    "}\n";
+
+  EXPECT_TRUE(visitor.Compile(code));
+
+  const auto &commands = visitor.get_commands_list();
+  ASSERT_EQ(1, commands.size());
+  ASSERT_EQ(2, commands[0].in_scope.size());
+  EXPECT_EQ(Command::CommandType::Reschedule, commands[0].in_scope[1].type);
+
+  FileMaker maker(commands, "test_user", "test_script");
+  EXPECT_TRUE(maker.Compiled());
+
+  std::string generated = maker.GetCode();
+  std::cout << "Generated code for reschedule:\n" << generated << std::endl;
+
+  // declared in main, before the reaction using it
+  size_t declaration =
+      generated.find("std::atomic<TimerId> order_timer{kInvalidTimerId};");
+  size_t reaction = generated.find("RegisterReaction(\"AAPL\", 5, [=, "
+                                   "&timer_manager, &order_timer, "
+                                   "&script_alert_service]");
+  EXPECT_NE(declaration, std::string::npos);
+  EXPECT_NE(reaction, std::string::npos);
+  EXPECT_LT(declaration, reaction);
+
+  EXPECT_NE(generated.find("order_timer = timer_manager.CreateTimer("),
+            std::string::npos);
+  EXPECT_NE(generated.find("timer_manager.Reschedule(order_timer, "
+                           "std::chrono::seconds(5));"),
+            std::string::npos);
+}
+
+TEST(TimerHandleTest, UnknownTimerName) {
+  ConcreteFiScriptVisitor visitor;
+
+  std::string code =
+    "Schedule(Start, 1s, 1) {\n"
+    "    Print(\"hello\")\n"
+    "}\n"
+    "Cancel(unknown)\n";
+
+  EXPECT_TRUE(visitor.Compile(code));
+
+  FileMaker maker(visitor.get_commands_list(), "test_user", "test_script");
+  EXPECT_FALSE(maker.Compiled());
+}
+
+TEST(TimerHandleTest, InvalidTimerName) {
+  ConcreteFiScriptVisitor visitor;
+
+  std::string code =
+    "Schedule(Start, 1s, 1, quote.price) {\n"
+    "    Print(\"hello\")\n"
+    "}\n";
+
+  EXPECT_TRUE(visitor.Compile(code));
+
+  FileMaker maker(visitor.get_commands_list(), "test_user", "test_script");
+  EXPECT_FALSE(maker.Compiled());
+}
+
+TEST(TimerHandleTest, SubSecondIntervals) {
+  ConcreteFiScriptVisitor visitor;
+
+  std::string code =
+    "Schedule(Start, 500ms, 10, fast) {\n"
+    "    Print(\"tick\")\n"
+    "}\n"
+    "Schedule(Start, 2s, 1) {\n"
+    "    Reschedule(fast, 250us)\n"
+    "}\n";
+
+  EXPECT_TRUE(visitor.Compile(code));
+
+  FileMaker maker(visitor.get_commands_list(), "test_user", "test_script");
+  EXPECT_TRUE(maker.Compiled());
+
+  std::string generated = maker.GetCode();
+  std::cout << "Generated code for sub second intervals:\n"
+            << generated << std::endl;
+
+  EXPECT_NE(generated.find("}, std::chrono::milliseconds(500), 10);"),
+            std::string::npos);
+  EXPECT_NE(generated.find("}, std::chrono::seconds(2), 1);"),
+            std::string::npos);
+  EXPECT_NE(generated.find("timer_manager.Reschedule(fast, "
+                           "std::chrono::microseconds(250));"),
+            std::string::npos);
+}
@@ -0,0 +1,137 @@
+#include "services/market_data_ring.h"
+
+#include <atomic>
+#include <cstring>
+#include <gtest/gtest.h>
+#include <string>
+#include <thread>
+#include <unistd.h>
+
+namespace {
+
+// not the name used by the distributor, a test must not replace its ring
+std::string TestRingName() {
+  return "/fiscript_market_data_test_" + std::to_string(getpid());
+}
+
+MarketDataRecord make_record(const char *instrument_id, int64_t quantity) {
+  MarketDataRecord record{};
+  record.price = 100.0 + static_cast<double>(quantity);
+  record.quantity = quantity;
+  std::strncpy(record.instrument_id, instrument_id,
+               sizeof(record.instrument_id) - 1);
+  return record;
+}
+
+} // namespace
+
+TEST(MarketDataRingTest, NoRing) {
+  MarketDataRingReader reader;
+  EXPECT_FALSE(reader.Open(TestRingName()));
+}
+
+TEST(MarketDataRingTest, ReadsWhatIsPublishedAfterOpen) {
+  MarketDataRingWriter writer;
+  ASSERT_TRUE(writer.Create(TestRingName(), 8));
+
+  // before the reader opens, not seen
+  writer.Publish(make_record("OLD", 0));
+
+  MarketDataRingReader reader;
+  ASSERT_TRUE(reader.Open(TestRingName()));
+  EXPECT_TRUE(reader.WriterAlive());
+
+  MarketDataRecord record;
+  EXPECT_FALSE(reader.Poll(record));
+
+  writer.Publish(make_record("AAPL", 1));
+  writer.Publish(make_record("MSFT", 2));
+
+  ASSERT_TRUE(reader.Poll(record));
+  EXPECT_STREQ(record.instrument_id, "AAPL");
+  EXPECT_EQ(record.quantity, 1);
+  ASSERT_TRUE(reader.Poll(record));
+  EXPECT_STREQ(record.instrument_id, "MSFT");
+  EXPECT_DOUBLE_EQ(record.price, 102.0);
+  EXPECT_FALSE(reader.Poll(record));
+  EXPECT_EQ(reader.LostCount(), 0);
+}
+
+TEST(MarketDataRingTest, LappedReaderJumpsToTheNewest) {
+  MarketDataRingWriter writer;
+  ASSERT_TRUE(writer.Create(TestRingName(), 8));
+
+  MarketDataRingReader reader;
+  ASSERT_TRUE(reader.Open(TestRingName()));
+
+  for (int i = 0; i < 20; ++i) {
+    writer.Publish(make_record("AAPL", i));
+  }
+
+  MarketDataRecord record;
+  EXPECT_FALSE(reader.Poll(record));
+  EXPECT_EQ(reader.LostCount(), 20);
+
+  writer.Publish(make_record("AAPL", 20));
+  ASSERT_TRUE(reader.Poll(record));
+  EXPECT_EQ(record.quantity, 20);
+}
+
+TEST(MarketDataRingTest, ClosedWhenTheWriterIsDestroyed) {
+  MarketDataRingReader reader;
+
+  {
+    MarketDataRingWriter writer;
+    ASSERT_TRUE(writer.Create(TestRingName(), 8));
+    ASSERT_TRUE(reader.Open(TestRingName()));
+  }
+
+  EXPECT_FALSE(reader.WriterAlive());
+
+  MarketDataRingReader late_reader;
+  EXPECT_FALSE(late_reader.Open(TestRingName()));
+}
+
+TEST(MarketDataRingTest, ConcurrentReaderSeesEveryRecordInOrder) {
+  constexpr int64_t kRecords = 100000;
+  MarketDataRingWriter writer;
+  ASSERT_TRUE(writer.Create(TestRingName(), 1 << 10));
+
+  MarketDataRingReader reader;
+  ASSERT_TRUE(reader.Open(TestRingName()));
+
+  std::atomic<bool> done{false};
+  int64_t expected = 0;
+  int64_t consumed = 0;
+  bool out_of_order = false;
+
+  std::thread consumer([&] {
+    MarketDataRecord record;
+    auto consume = [&](const MarketDataRecord &read) {
+      // a lapped reader skips records, but never goes back
+      if (read.quantity < expected) {
+        out_of_order = true;
+      }
+      expected = read.quantity + 1;
+      consumed++;
+    };
+
+    while (!done) {
+      if (reader.Poll(record)) {
+        consume(record);
+      }
+    }
+    while (reader.Poll(record)) {
+      consume(record);
+    }
+  });
+
+  for (int64_t i = 0; i < kRecords; ++i) {
+    writer.Publish(make_record("AAPL", i));
+  }
+  done = true;
+  consumer.join();
+
+  EXPECT_FALSE(out_of_order);
+  EXPECT_EQ(consumed + static_cast<int64_t>(reader.LostCount()), kRecords);
+}
@@ -0,0 +1,135 @@
+#include "services/reaction_executor.h"
+
+#include <atomic>
+#include <chrono>
+#include <gtest/gtest.h>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "services/reacton_service.h"
+
+using namespace std::chrono;
+
+namespace {
+
+internal::PriceUpdate make_update(const std::string &instrument_id,
+                                  int64_t quantity) {
+  internal::PriceUpdate update;
+  update.set_instrument_id(instrument_id);
+  update.set_quantity(quantity);
+  return update;
+}
+
+} // namespace
+
+TEST(ReactionExecutorTest, KeepsTheOrderOfAReaction) {
+  constexpr int kTicks = 1000;
+  std::vector<int64_t> seen;
+  std::atomic<int> running{0};
+  bool overlapped = false;
+
+  Reaction reaction("AAPL", -1, [&](const internal::PriceUpdate &update) {
+    if (running++ != 0) {
+      overlapped = true;
+    }
+    seen.push_back(update.quantity());
+    running--;
+  });
+
+  std::atomic<int> ran{0};
+  ReactionExecutor executor(4, [&ran](Reaction &) { ran++; });
+
+  for (int i = 0; i < kTicks; ++i) {
+    executor.Post(reaction, make_update("AAPL", i));
+  }
+  executor.WaitIdle();
+
+  EXPECT_EQ(ran.load(), kTicks);
+  EXPECT_FALSE(overlapped);
+  ASSERT_EQ(seen.size(), kTicks);
+  for (int i = 0; i < kTicks; ++i) {
+    EXPECT_EQ(seen[i], i);
+  }
+}
+
+TEST(ReactionExecutorTest, SlowReactionDoesNotBlockOthers) {
+  std::atomic<bool> release{false};
+  std::atomic<int> fast_count{0};
+
+  Reaction slow("SLOW", -1, [&release](const internal::PriceUpdate &) {
+    while (!release) {
+      std::this_thread::sleep_for(milliseconds(1));
+    }
+  });
+  Reaction fast("FAST", -1,
+                [&fast_count](const internal::PriceUpdate &) { fast_count++; });
+
+  ReactionExecutor executor(2, [](Reaction &) {});
+
+  executor.Post(slow, make_update("SLOW", 0));
+  for (int i = 0; i < 100; ++i) {
+    executor.Post(fast, make_update("FAST", i));
+  }
+
+  const auto deadline = steady_clock::now() + seconds(5);
+  while (fast_count < 100 && steady_clock::now() < deadline) {
+    std::this_thread::sleep_for(milliseconds(1));
+  }
+  EXPECT_EQ(fast_count.load(), 100);
+
+  release = true;
+  executor.WaitIdle();
+}
+
+TEST(ReactionExecutorTest, DestructorRunsPostedTicks) {
+  std::atomic<int> count{0};
+  Reaction reaction("AAPL", -1,
+                    [&count](const internal::PriceUpdate &) { count++; });
+
+  {
+    ReactionExecutor executor(2, [](Reaction &) {});
+    for (int i = 0; i < 100; ++i) {
+      executor.Post(reaction, make_update("AAPL", i));
+    }
+  }
+
+  EXPECT_EQ(count.load(), 100);
+}
+
+TEST(ReactionExecutorTest, ConflatingReactionSeesTheLatestTick) {
+  std::atomic<bool> release{false};
+  std::atomic<bool> started{false};
+  std::vector<int64_t> seen;
+
+  Reaction reaction(
+      "AAPL", -1,
+      [&](const internal::PriceUpdate &update) {
+        seen.push_back(update.quantity());
+        EXPECT_EQ(update.instrument_id(), "AAPL");
+        started = true;
+        while (!release) {
+          std::this_thread::sleep_for(milliseconds(1));
+        }
+      },
+      ReactionMode::Conflate);
+
+  ReactionExecutor executor(2, [](Reaction &) {});
+
+  executor.Post(reaction, make_update("AAPL", 0));
+  while (!started) {
+    std::this_thread::sleep_for(milliseconds(1));
+  }
+
+  // the callback is busy with the first tick
+  for (int i = 1; i <= 10; ++i) {
+    executor.Post(reaction, make_update("AAPL", i));
+  }
+  release = true;
+  executor.WaitIdle();
+
+  ASSERT_EQ(seen.size(), 2);
+  EXPECT_EQ(seen[0], 0);
+  EXPECT_EQ(seen[1], 10);
+  EXPECT_EQ(reaction.conflated_count.load(), 9);
+}
@@ -0,0 +1,70 @@
+#include "services/reaction_index.h"
+
+#include <gtest/gtest.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "services/reacton_service.h"
+
+namespace {
+
+std::shared_ptr<Reaction> make_reaction(const std::string &instrument_id) {
+  return std::make_shared<Reaction>(instrument_id, 1,
+                                    [](const internal::PriceUpdate &) {});
+}
+
+std::vector<Reaction *> to_vector(ReactionIndex::Range range) {
+  return std::vector<Reaction *>(range.begin(), range.end());
+}
+
+} // namespace
+
+TEST(ReactionIndexTest, EmptyIndex) {
+  ReactionIndex index;
+
+  EXPECT_EQ(index.InstrumentCount(), 0);
+  EXPECT_TRUE(index.Find("AAPL").empty());
+}
+
+TEST(ReactionIndexTest, FindsReactionsInRegistrationOrder) {
+  std::vector<std::shared_ptr<Reaction>> reactions = {
+      make_reaction("AAPL"), make_reaction("GOOGL"), make_reaction("AAPL"),
+      make_reaction("MSFT"), make_reaction("AAPL")};
+
+  ReactionIndex index(reactions);
+  EXPECT_EQ(index.InstrumentCount(), 3);
+
+  const std::vector<Reaction *> apple = to_vector(index.Find("AAPL"));
+  ASSERT_EQ(apple.size(), 3);
+  EXPECT_EQ(apple[0], reactions[0].get());
+  EXPECT_EQ(apple[1], reactions[2].get());
+  EXPECT_EQ(apple[2], reactions[4].get());
+
+  ASSERT_EQ(to_vector(index.Find("GOOGL")).size(), 1);
+  EXPECT_EQ(to_vector(index.Find("MSFT"))[0], reactions[3].get());
+  EXPECT_TRUE(index.Find("TSLA").empty());
+
+  const std::vector<std::string> expected_ids = {"AAPL", "GOOGL", "MSFT"};
+  EXPECT_EQ(index.InstrumentIds(), expected_ids);
+}
+
+TEST(ReactionIndexTest, ManyInstruments) {
+  constexpr int kInstruments = 5000;
+
+  std::vector<std::shared_ptr<Reaction>> reactions;
+  for (int i = 0; i < kInstruments; ++i) {
+    reactions.push_back(make_reaction("SYM" + std::to_string(i)));
+  }
+
+  ReactionIndex index(reactions);
+  EXPECT_EQ(index.InstrumentCount(), kInstruments);
+
+  for (int i = 0; i < kInstruments; ++i) {
+    const std::vector<Reaction *> found =
+        to_vector(index.Find("SYM" + std::to_string(i)));
+    ASSERT_EQ(found.size(), 1) << i;
+    EXPECT_EQ(found[0], reactions[i].get());
+  }
+  EXPECT_TRUE(index.Find("SYM" + std::to_string(kInstruments)).empty());
+}
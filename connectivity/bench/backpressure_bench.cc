@@ -0,0 +1,112 @@
+// cost of the backpressure policies for the feed and for the streams
+//
+// the gateway broadcasts kTicks points of 8 instruments to a
+// subscription that reads a batch of 64 points every kReadEvery points
+// so it falls behind its capacity, and to 15 subscriptions that keep up
+// "feed" is the time Broadcast took per point, what the socket reader
+// thread pays, "read" the time the slow subscription spent in Poll
+
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "python_api_gtw.h"
+
+using namespace std::chrono;
+
+namespace {
+
+constexpr int kTicks = 1000000;
+constexpr int kReadEvery = 128;
+constexpr int kReadBatch = 64;
+constexpr int kFastSubscribers = 15;
+
+const char *const kInstruments[] = {"AAPL", "MSFT", "GOOG", "AMZN",
+                                    "NVDA", "META", "TSLA", "NFLX"};
+
+void Run(std::ostream &out, const std::string &name,
+         BackpressurePolicy policy) {
+  PythonApiGtw gateway;
+
+  SubscriptionOptions options;
+  options.policy = policy;
+  options.capacity = 256;
+  // the slow subscription is read by this thread, so it never makes
+  // room while the feed waits
+  options.block_timeout = microseconds(1);
+  auto slow = gateway.Subscribe({}, {}, options);
+
+  std::vector<std::shared_ptr<MarketDataSubscription>> fast;
+  for (int i = 0; i < kFastSubscribers; ++i) {
+    fast.push_back(gateway.Subscribe());
+  }
+
+  std::vector<MarketDataPoint> points(8);
+  for (int i = 0; i < 8; ++i) {
+    points[i].set_instrument_id(kInstruments[i]);
+  }
+
+  nanoseconds feed{0};
+  nanoseconds read{0};
+  uint64_t delivered = 0;
+  MarketDataPoint point;
+
+  for (int i = 0; i < kTicks; ++i) {
+    points[i % 8].price = i;
+
+    auto start = steady_clock::now();
+    gateway.Broadcast(points[i % 8]);
+    feed += steady_clock::now() - start;
+
+    for (auto &subscription : fast) {
+      subscription->Poll(point);
+    }
+
+    if (i % kReadEvery == 0) {
+      start = steady_clock::now();
+      for (int n = 0; n < kReadBatch && slow->active.load(); ++n) {
+        if (!slow->Poll(point)) {
+          break;
+        }
+        ++delivered;
+      }
+      read += steady_clock::now() - start;
+    }
+  }
+
+  out << std::left << std::setw(12) << name << std::right << std::fixed
+      << std::setprecision(1) << std::setw(8)
+      << static_cast<double>(feed.count()) / kTicks << " ns feed"
+      << std::setw(8) << static_cast<double>(read.count()) / delivered
+      << " ns read" << std::setw(10) << delivered << " delivered"
+      << std::setw(10) << slow->dropped.load() << " dropped" << std::setw(8)
+      << slow->block_timeouts.load() << " timeouts" << std::endl;
+
+  for (auto &subscription : fast) {
+    gateway.Unsubscribe(subscription);
+  }
+  gateway.Unsubscribe(slow);
+}
+
+} // namespace
+
+int main() {
+  std::ostream out(std::cout.rdbuf());
+  // the subscribe and unsubscribe lines of the gateway
+  std::cout.rdbuf(nullptr);
+
+  out << kTicks << " points, the slow subscription reads " << kReadBatch
+      << " every " << kReadEvery << std::endl;
+
+  Run(out, "drop newest", BackpressurePolicy::DropNewest);
+  Run(out, "drop oldest", BackpressurePolicy::DropOldest);
+  Run(out, "conflate", BackpressurePolicy::ConflatePerInstrument);
+  Run(out, "block", BackpressurePolicy::BlockWithTimeout);
+  Run(out, "disconnect", BackpressurePolicy::DisconnectSlowConsumer);
+
+  return 0;
+}
@@ -0,0 +1,103 @@
+// wake up latency of a stream thread waiting on an empty queue
+//
+// a producer pushes a point every 200us into a subscription, the
+// consumer records the time between the push and its pop
+// "poll" is the previous loop of MarketDataService, sleeping 100us
+// between pops, "park" sleeps on the doorbell, "spin" spins 50us first
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "market_data_subscription.h"
+
+using namespace std::chrono;
+
+namespace {
+
+constexpr int kTicks = 5000;
+constexpr microseconds kTickInterval{200};
+
+enum class WaitMode { Poll, Park, Spin };
+
+long long NowNs() {
+  return duration_cast<nanoseconds>(steady_clock::now().time_since_epoch())
+      .count();
+}
+
+double Percentile(const std::vector<long long> &sorted, double percent) {
+  const std::size_t index = static_cast<std::size_t>(
+      percent / 100.0 * static_cast<double>(sorted.size() - 1));
+  return static_cast<double>(sorted[index]);
+}
+
+void Run(const std::string &name, WaitMode mode) {
+  auto ring = std::make_shared<BroadcastRing>();
+  MarketDataSubscription subscription(ring);
+  std::vector<long long> latencies;
+  latencies.reserve(kTicks);
+
+  std::thread consumer([&] {
+    while (latencies.size() < static_cast<std::size_t>(kTicks)) {
+      MarketDataPoint point;
+      const uint64_t rings = subscription.doorbell.Rings();
+
+      if (subscription.Poll(point)) {
+        // the push time travels in the timestamp
+        latencies.push_back(NowNs() - point.timestamp_seconds);
+        continue;
+      }
+
+      switch (mode) {
+      case WaitMode::Poll:
+        std::this_thread::sleep_for(microseconds(100));
+        break;
+      case WaitMode::Park:
+        subscription.doorbell.Wait(rings, nanoseconds(0), milliseconds(10));
+        break;
+      case WaitMode::Spin:
+        subscription.doorbell.Wait(rings, microseconds(50), milliseconds(10));
+        break;
+      }
+    }
+  });
+
+  auto next = steady_clock::now();
+  for (int i = 0; i < kTicks; ++i) {
+    next += kTickInterval;
+    std::this_thread::sleep_until(next);
+
+    MarketDataPoint point;
+    point.timestamp_seconds = NowNs();
+    ring->Publish(point);
+    subscription.doorbell.Ring();
+  }
+
+  consumer.join();
+
+  std::sort(latencies.begin(), latencies.end());
+  std::cout << std::left << std::setw(8) << name << std::right << std::fixed
+            << std::setprecision(1) << " p50 " << std::setw(8)
+            << Percentile(latencies, 50) / 1000.0 << "us  p99 "
+            << std::setw(8) << Percentile(latencies, 99) / 1000.0 << "us"
+            << std::endl;
+}
+
+} // namespace
+
+int main() {
+  std::cout << kTicks << " ticks, one every " << kTickInterval.count()
+            << "us" << std::endl;
+
+  Run("poll", WaitMode::Poll);
+  Run("park", WaitMode::Park);
+  Run("spin", WaitMode::Spin);
+
+  return 0;
+}
@@ -0,0 +1,126 @@
+// cost of turning the feed into MarketDataPoints, json against binary
+//
+// both formats hold the same ticks in one buffer, decoded the way the
+// socket reader does it, the broadcast is left out
+// one thread, so ticks/s is also per core
+// "json dom" is the nlohmann path alone, "json" goes through
+// DecodeJsonTick as the socket reader does
+
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <string_view>
+
+#include "feed_protocol.h"
+
+using namespace std::chrono;
+
+namespace {
+
+constexpr int kTicks = 1000000;
+
+const char *const kInstruments[] = {"AAPL", "MSFT", "GOOG", "AMZN",
+                                    "NVDA", "META", "TSLA", "NFLX"};
+
+std::string JsonFeed() {
+  std::string feed;
+  for (int i = 0; i < kTicks; ++i) {
+    feed += "{\"instrument_id\": \"";
+    feed += kInstruments[i % 8];
+    feed += "\", \"price\": " + std::to_string(100.0 + i % 100 * 0.25) +
+            ", \"quantity\": " + std::to_string(i % 1000) + "}\n";
+  }
+  return feed;
+}
+
+std::string BinaryFeed() {
+  std::string feed;
+  for (int i = 0; i < kTicks; ++i) {
+    const std::string symbol = kInstruments[i % 8];
+    const uint16_t length =
+        static_cast<uint16_t>(kBinaryRecordHeaderSize + symbol.size());
+    const uint8_t symbol_length = static_cast<uint8_t>(symbol.size());
+    const double price = 100.0 + i % 100 * 0.25;
+    const int64_t quantity = i % 1000;
+    const int64_t timestamp_ns = 1700000000000000000 + i;
+
+    std::string record(length, '\0');
+    std::memcpy(&record[0], &length, sizeof(length));
+    std::memcpy(&record[2], &symbol_length, sizeof(symbol_length));
+    std::memcpy(&record[4], &price, sizeof(price));
+    std::memcpy(&record[12], &quantity, sizeof(quantity));
+    std::memcpy(&record[20], &timestamp_ns, sizeof(timestamp_ns));
+    std::memcpy(&record[kBinaryRecordHeaderSize], symbol.data(),
+                symbol.size());
+    feed += record;
+  }
+  return feed;
+}
+
+void Print(const std::string &name, std::size_t bytes, double seconds,
+           double checksum) {
+  std::cout << std::left << std::setw(10) << name << std::right << std::fixed
+            << std::setprecision(1) << std::setw(8)
+            << static_cast<double>(bytes) / kTicks << " bytes/tick"
+            << std::setw(9) << seconds * 1e9 / kTicks << " ns/tick"
+            << std::setprecision(2) << std::setw(8)
+            << kTicks / seconds / 1e6 << " M ticks/s"
+            << "  (checksum " << std::setprecision(0) << checksum << ")"
+            << std::endl;
+}
+
+} // namespace
+
+int main() {
+  const std::string json_feed = JsonFeed();
+  const std::string binary_feed = BinaryFeed();
+
+  const auto run_json = [&json_feed](const std::string &name, auto parse) {
+    double checksum = 0.0;
+    const auto start = steady_clock::now();
+
+    std::string_view rest(json_feed);
+    std::size_t newline_pos;
+    while ((newline_pos = rest.find('\n')) != std::string_view::npos) {
+      MarketDataPoint point;
+      parse(rest.substr(0, newline_pos), point);
+      checksum += point.price;
+      rest.remove_prefix(newline_pos + 1);
+    }
+
+    Print(name, json_feed.size(),
+          duration<double>(steady_clock::now() - start).count(), checksum);
+  };
+
+  run_json("json dom", [](std::string_view line, MarketDataPoint &point) {
+    ParseJsonTickDom(line, point);
+    StampNow(point);
+  });
+  run_json("json", ParseJsonTick);
+
+  {
+    double checksum = 0.0;
+    const auto start = steady_clock::now();
+
+    std::size_t offset = 0;
+    while (offset < binary_feed.size()) {
+      MarketDataPoint point;
+      std::size_t consumed = 0;
+      if (DecodeBinaryRecord(binary_feed.data() + offset,
+                             binary_feed.size() - offset, point,
+                             consumed) != DecodeStatus::Ok) {
+        break;
+      }
+      checksum += point.price;
+      offset += consumed;
+    }
+
+    Print("binary", binary_feed.size(),
+          duration<double>(steady_clock::now() - start).count(), checksum);
+  }
+
+  return 0;
+}
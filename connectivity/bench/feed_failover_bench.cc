@@ -0,0 +1,180 @@
+// failover of an A/B feed when one line fails
+//
+// a stand-in for the python feed sends the same ticks on two local
+// connections, every kInterval, and injects a fault on line A halfway:
+// it stops writing (stall) or closes the connection (drop)
+// "gap" is the longest time between two points read by a subscription,
+// before the fault and after it, the difference is what the failover
+// cost the streams; "missing" are ticks the subscription never got
+// numbered ticks are arbitrated by sequence, json ticks by stall timeout
+
+#include <algorithm>
+#include <atomic>
+#include <boost/asio.hpp>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "arbitrated_feed_gateway.h"
+#include "python_api_gtw.h"
+#include "socket_feed_gateway.h"
+
+using boost::asio::ip::tcp;
+using namespace std::chrono;
+
+namespace {
+
+constexpr int kTicks = 4000;
+constexpr int kFaultAt = kTicks / 2;
+constexpr microseconds kInterval{250};
+constexpr milliseconds kStallTimeout{20};
+
+enum class Fault { Stall, Drop };
+
+std::string Record(uint64_t sequence) {
+  const std::string symbol = "FAILOVER";
+  std::string record(kBinaryRecordHeaderSize + symbol.size() + 8, '\0');
+  const uint16_t length = static_cast<uint16_t>(record.size());
+  const uint8_t symbol_length = static_cast<uint8_t>(symbol.size());
+  const double price = static_cast<double>(sequence);
+  const int64_t quantity = 1;
+  const int64_t timestamp_ns = 1700000000000000000;
+
+  std::memcpy(&record[0], &length, sizeof(length));
+  std::memcpy(&record[2], &symbol_length, sizeof(symbol_length));
+  std::memcpy(&record[4], &price, sizeof(price));
+  std::memcpy(&record[12], &quantity, sizeof(quantity));
+  std::memcpy(&record[20], &timestamp_ns, sizeof(timestamp_ns));
+  std::memcpy(&record[kBinaryRecordHeaderSize], symbol.data(), symbol.size());
+  std::memcpy(&record[kBinaryRecordHeaderSize + symbol.size()], &sequence,
+              sizeof(sequence));
+  return record;
+}
+
+std::string JsonLine(uint64_t sequence) {
+  return "{\"instrument_id\": \"FAILOVER\", \"price\": " +
+         std::to_string(sequence) + ", \"quantity\": 1}\n";
+}
+
+// the python feed on two lines, with a fault on line A
+class FaultyFeed {
+public:
+  FaultyFeed()
+      : acceptor_a_(ios_, tcp::endpoint(tcp::v4(), 0)),
+        acceptor_b_(ios_, tcp::endpoint(tcp::v4(), 0)) {}
+
+  uint16_t PortA() const { return acceptor_a_.local_endpoint().port(); }
+  uint16_t PortB() const { return acceptor_b_.local_endpoint().port(); }
+
+  void Run(Fault fault, bool numbered) {
+    acceptor_a_.accept(line_a_);
+    acceptor_b_.accept(line_b_);
+
+    if (numbered) {
+      const char handshake = static_cast<char>(kBinaryFeedHandshake);
+      boost::asio::write(line_a_, boost::asio::buffer(&handshake, 1));
+      boost::asio::write(line_b_, boost::asio::buffer(&handshake, 1));
+    }
+
+    auto next = steady_clock::now();
+    for (uint64_t sequence = 1; sequence <= kTicks; ++sequence) {
+      const std::string tick =
+          numbered ? Record(sequence) : JsonLine(sequence);
+
+      if (sequence == kFaultAt && fault == Fault::Drop) {
+        line_a_.close();
+      }
+      // a stalled line keeps its connection and sends nothing
+      if (sequence < kFaultAt) {
+        boost::asio::write(line_a_, boost::asio::buffer(tick));
+      }
+      boost::asio::write(line_b_, boost::asio::buffer(tick));
+
+      next += kInterval;
+      std::this_thread::sleep_until(next);
+    }
+
+    line_a_.close();
+    line_b_.close();
+  }
+
+private:
+  boost::asio::io_service ios_;
+  tcp::acceptor acceptor_a_;
+  tcp::acceptor acceptor_b_;
+  tcp::socket line_a_{ios_};
+  tcp::socket line_b_{ios_};
+};
+
+void Run(std::ostream &out, const std::string &name, Fault fault,
+         bool numbered) {
+  FaultyFeed feed;
+
+  PythonApiGtw gateway;
+  auto arbitrated = std::make_unique<ArbitratedFeedGateway>(
+      std::make_unique<SocketFeedGateway>("127.0.0.1", feed.PortA()),
+      std::make_unique<SocketFeedGateway>("127.0.0.1", feed.PortB()),
+      kStallTimeout);
+  ArbitratedFeedGateway &lines = *arbitrated;
+  gateway.AddFeed(std::move(arbitrated));
+
+  auto subscription = gateway.Subscribe();
+
+  std::thread sender([&] { feed.Run(fault, numbered); });
+  gateway.Start();
+
+  std::vector<steady_clock::time_point> received;
+  std::vector<int> prices;
+  MarketDataPoint point;
+  while (subscription->active.load() || subscription->HasPending()) {
+    if (subscription->Poll(point)) {
+      received.push_back(steady_clock::now());
+      prices.push_back(static_cast<int>(point.price));
+    } else {
+      std::this_thread::yield();
+    }
+  }
+  sender.join();
+
+  nanoseconds before{0};
+  nanoseconds after{0};
+  for (std::size_t i = 1; i < received.size(); ++i) {
+    nanoseconds &gap = prices[i] < kFaultAt ? before : after;
+    gap = std::max<nanoseconds>(gap, received[i] - received[i - 1]);
+  }
+
+  out << std::left << std::setw(14) << name << std::right << std::fixed
+      << std::setprecision(2) << std::setw(9)
+      << duration<double, std::milli>(before).count() << " ms gap before"
+      << std::setw(9) << duration<double, std::milli>(after).count()
+      << " ms gap after" << std::setw(6) << kTicks - received.size()
+      << " missing" << std::setw(4) << lines.FailoverCount() << " failovers"
+      << std::setw(6) << lines.DuplicateCount(ArbitratedFeedGateway::kLineB)
+      << " B copies dropped" << std::endl;
+
+  gateway.Unsubscribe(subscription);
+}
+
+} // namespace
+
+int main() {
+  std::ostream out(std::cout.rdbuf());
+  // the connection and feed lines of the gateway
+  std::cout.rdbuf(nullptr);
+
+  out << kTicks << " ticks every " << kInterval.count()
+      << " us, line A fails at tick " << kFaultAt << ", stall timeout "
+      << kStallTimeout.count() << " ms" << std::endl;
+
+  Run(out, "stall", Fault::Stall, true);
+  Run(out, "drop", Fault::Drop, true);
+  Run(out, "json stall", Fault::Stall, false);
+  Run(out, "json drop", Fault::Drop, false);
+  return 0;
+}
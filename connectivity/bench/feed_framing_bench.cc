@@ -0,0 +1,99 @@
+// cost of cutting the json feed into lines, before any parsing
+//
+// "string" is the previous socket reader loop: every read appended to
+// a std::string, a substr and an erase(0, n) per line
+// "buffer" is FeedBuffer, lines handed out in place
+// the feed is replayed from memory in reads of kReadSize bytes, or of
+// whatever the buffer has free, as a burst coming out of the socket
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <string_view>
+
+#include "feed_buffer.h"
+
+using namespace std::chrono;
+
+namespace {
+
+constexpr int kTicks = 2000000;
+constexpr std::size_t kReadSize = 4096;
+
+std::string JsonFeed() {
+  std::string feed;
+  for (int i = 0; i < kTicks; ++i) {
+    feed += "{\"instrument_id\": \"AAPL\", \"price\": " +
+            std::to_string(100.0 + i % 100 * 0.25) +
+            ", \"quantity\": " + std::to_string(i % 1000) + "}\n";
+  }
+  return feed;
+}
+
+void Print(const std::string &name, std::size_t lines, double seconds) {
+  std::cout << std::left << std::setw(18) << name << std::right << std::fixed
+            << std::setprecision(1) << std::setw(8)
+            << seconds * 1e9 / kTicks << " ns/line" << std::setw(10)
+            << lines << " lines" << std::endl;
+}
+
+void RunString(const std::string &feed) {
+  const auto start = steady_clock::now();
+  std::size_t lines = 0;
+  std::string accumulated_data;
+
+  for (std::size_t offset = 0; offset < feed.size(); offset += kReadSize) {
+    accumulated_data.append(feed.data() + offset,
+                            std::min(kReadSize, feed.size() - offset));
+
+    size_t newline_pos;
+    while ((newline_pos = accumulated_data.find('\n')) != std::string::npos) {
+      std::string json_line = accumulated_data.substr(0, newline_pos);
+      accumulated_data.erase(0, newline_pos + 1);
+      lines += !json_line.empty();
+    }
+  }
+
+  Print("string", lines, duration<double>(steady_clock::now() - start).count());
+}
+
+void RunBuffer(const std::string &name, const std::string &feed,
+               std::size_t max_read) {
+  const auto start = steady_clock::now();
+  std::size_t lines = 0;
+  FeedBuffer buffer;
+
+  std::string_view rest(feed);
+  while (!rest.empty()) {
+    char *data = buffer.WriteData();
+    const std::size_t n =
+        std::min({buffer.WriteSpace(), max_read, rest.size()});
+    std::memcpy(data, rest.data(), n);
+    buffer.Commit(n);
+    rest.remove_prefix(n);
+
+    std::string_view line;
+    while (buffer.NextLine(line)) {
+      lines += !line.empty();
+    }
+  }
+
+  Print(name, lines, duration<double>(steady_clock::now() - start).count());
+}
+
+} // namespace
+
+int main() {
+  const std::string feed = JsonFeed();
+  std::cout << kTicks << " lines, " << feed.size() / kTicks << " bytes each"
+            << std::endl;
+
+  RunString(feed);
+  RunBuffer("buffer", feed, kReadSize);
+  RunBuffer("buffer, full reads", feed, FeedBuffer::kDefaultCapacity);
+
+  return 0;
+}
@@ -0,0 +1,165 @@
+// throughput of the gateway with the instruments split between feeds
+//
+// kPoints binary records of 64 instruments are split between 1, 2, 4
+// and 8 feeds, each feed decodes its records on its own thread and
+// hands them to the gateway, which publishes one point at a time
+// "points/s" is every point published over the time until the last
+// feed closed, with 4 subscriptions reading every point
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "feed_protocol.h"
+#include "python_api_gtw.h"
+
+using namespace std::chrono;
+
+namespace {
+
+constexpr int kPoints = 2000000;
+constexpr int kInstruments = 64;
+constexpr int kSubscribers = 4;
+
+std::string Record(const std::string &symbol, double price) {
+  std::string record(kBinaryRecordHeaderSize + symbol.size(), '\0');
+  const uint16_t length = static_cast<uint16_t>(record.size());
+  const uint8_t symbol_length = static_cast<uint8_t>(symbol.size());
+  const int64_t quantity = 100;
+  const int64_t timestamp_ns = 1700000000000000000;
+
+  std::memcpy(&record[0], &length, sizeof(length));
+  std::memcpy(&record[2], &symbol_length, sizeof(symbol_length));
+  std::memcpy(&record[4], &price, sizeof(price));
+  std::memcpy(&record[12], &quantity, sizeof(quantity));
+  std::memcpy(&record[20], &timestamp_ns, sizeof(timestamp_ns));
+  std::memcpy(&record[kBinaryRecordHeaderSize], symbol.data(), symbol.size());
+  return record;
+}
+
+// what a socket feed does with the records once they are read
+class RecordFeed : public FeedGateway {
+public:
+  explicit RecordFeed(std::string records) : records_(std::move(records)) {}
+  ~RecordFeed() override { Stop(); }
+
+  std::string Name() const override { return "records"; }
+
+  void Start(FeedSink &sink, std::size_t feed) override {
+    running_.store(true);
+    thread_ = std::thread([this, &sink, feed] {
+      std::size_t offset = 0;
+      while (offset < records_.size()) {
+        MarketDataPoint point;
+        std::size_t consumed = 0;
+        DecodeBinaryRecord(records_.data() + offset, records_.size() - offset,
+                           point, consumed);
+        sink.OnPoint(feed, point, kNoSequence);
+        offset += consumed;
+      }
+      running_.store(false);
+      sink.OnFeedClosed(feed);
+    });
+  }
+
+  void Stop() override {
+    if (thread_.joinable()) {
+      thread_.join();
+    }
+  }
+
+  bool IsRunning() const override { return running_.load(); }
+
+private:
+  const std::string records_;
+  std::atomic<bool> running_{false};
+  std::thread thread_;
+};
+
+void Run(std::ostream &out, int feeds) {
+  // instrument i goes to feed i % feeds
+  std::vector<std::string> records(feeds);
+  for (int i = 0; i < kPoints; ++i) {
+    const int instrument = i % kInstruments;
+    records[instrument % feeds] +=
+        Record("MERGE" + std::to_string(instrument), i);
+  }
+
+  PythonApiGtw gateway(1 << 20);
+  for (auto &feed_records : records) {
+    gateway.AddFeed(std::make_unique<RecordFeed>(std::move(feed_records)));
+  }
+
+  std::vector<std::shared_ptr<MarketDataSubscription>> subscriptions;
+  std::vector<std::thread> readers;
+  std::vector<uint64_t> read(kSubscribers);
+  for (int i = 0; i < kSubscribers; ++i) {
+    SubscriptionOptions options;
+    options.policy = BackpressurePolicy::DropOldest;
+    options.capacity = 1 << 19;
+    subscriptions.push_back(gateway.Subscribe({}, {}, options));
+  }
+  for (int i = 0; i < kSubscribers; ++i) {
+    readers.emplace_back([&, i] {
+      auto &subscription = *subscriptions[i];
+      MarketDataPoint point;
+      while (subscription.active.load() || subscription.HasPending()) {
+        if (subscription.Poll(point)) {
+          ++read[i];
+        } else {
+          std::this_thread::yield();
+        }
+      }
+    });
+  }
+
+  const auto start = steady_clock::now();
+  gateway.Start();
+  while (gateway.IsRunning()) {
+    std::this_thread::sleep_for(microseconds(100));
+  }
+  const auto elapsed = steady_clock::now() - start;
+
+  for (auto &reader : readers) {
+    reader.join();
+  }
+
+  uint64_t published = 0;
+  for (int feed = 0; feed < feeds; ++feed) {
+    published += gateway.PublishedCount(feed);
+  }
+
+  out << std::setw(2) << feeds << " feeds" << std::fixed
+      << std::setprecision(2) << std::setw(10)
+      << published / duration<double>(elapsed).count() / 1e6
+      << " M points/s" << std::setw(10) << read[0] << " read" << std::endl;
+
+  for (auto &subscription : subscriptions) {
+    gateway.Unsubscribe(subscription);
+  }
+}
+
+} // namespace
+
+int main() {
+  std::ostream out(std::cout.rdbuf());
+  // the feed and subscription lines of the gateway
+  std::cout.rdbuf(nullptr);
+
+  out << kPoints << " points of " << kInstruments << " instruments, "
+      << kSubscribers << " subscriptions, " << std::thread::hardware_concurrency()
+      << " cores" << std::endl;
+
+  for (int feeds : {1, 2, 4, 8}) {
+    Run(out, feeds);
+  }
+  return 0;
+}
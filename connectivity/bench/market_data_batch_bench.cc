@@ -0,0 +1,186 @@
+// throughput of StreamPrices against StreamPriceBatches
+//
+// an in process gRPC server runs the write loops of MarketDataService
+// on a subscription fed as fast as it drains, a client on the loopback
+// counts the updates it reads until it has them all
+// the gateway is left out, the producer publishes to the ring of the
+// subscription and holds back while the stream lags kMaxLag behind
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include <grpcpp/grpcpp.h>
+
+#include "services/market_data_service.h"
+
+using namespace std::chrono;
+
+namespace {
+
+constexpr int kTicks = 500000;
+// the capacity of the subscriber queues this bench was written with
+constexpr uint64_t kMaxLag = 1024;
+
+const char *const kInstruments[] = {"AAPL", "MSFT", "GOOG", "AMZN",
+                                    "NVDA", "META", "TSLA", "NFLX"};
+
+class BenchService final : public internal::MarketDataService::Service {
+public:
+  grpc::Status
+  StreamPrices(grpc::ServerContext *context,
+               const internal::MarketDataRequest *request,
+               grpc::ServerWriter<internal::PriceUpdate> *writer) override {
+    auto ring = std::make_shared<BroadcastRing>();
+    MarketDataSubscription subscription(ring);
+    std::thread producer = Produce(context, *ring, subscription);
+
+    MarketDataService::WritePoints(context, subscription,
+                                   MarketDataService::OptionsFrom(*request),
+                                   writer);
+
+    subscription.active = false;
+    producer.join();
+    return grpc::Status::OK;
+  }
+
+  grpc::Status StreamPriceBatches(
+      grpc::ServerContext *context, const internal::MarketDataRequest *request,
+      grpc::ServerWriter<internal::PriceUpdateBatch> *writer) override {
+    auto ring = std::make_shared<BroadcastRing>();
+    MarketDataSubscription subscription(ring);
+    std::thread producer = Produce(context, *ring, subscription);
+
+    MarketDataService::WriteBatches(context, subscription,
+                                    MarketDataService::OptionsFrom(*request),
+                                    writer);
+
+    subscription.active = false;
+    producer.join();
+    return grpc::Status::OK;
+  }
+
+private:
+  // plays the socket reader of the gateway
+  static std::thread Produce(grpc::ServerContext *context,
+                             BroadcastRing &ring,
+                             MarketDataSubscription &subscription) {
+    return std::thread([context, &ring, &subscription] {
+      MarketDataPoint point;
+      point.quantity = 100;
+
+      for (int i = 0; i < kTicks; ++i) {
+        point.price = 100.0 + i % 100;
+        point.set_instrument_id(kInstruments[i % 8]);
+
+        while (subscription.reader.Lag() >= kMaxLag) {
+          if (!subscription.active.load() || context->IsCancelled()) {
+            return;
+          }
+          std::this_thread::yield();
+        }
+        ring.Publish(point);
+        subscription.doorbell.Ring();
+      }
+    });
+  }
+};
+
+struct Result {
+  double seconds = 0.0;
+  long long updates = 0;
+  long long messages = 0;
+};
+
+template <typename Read>
+Result Consume(Read read) {
+  Result result;
+  const auto start = steady_clock::now();
+  read(result);
+  result.seconds =
+      duration_cast<duration<double>>(steady_clock::now() - start).count();
+  return result;
+}
+
+Result RunPerTick(internal::MarketDataService::Stub &stub) {
+  return Consume([&stub](Result &result) {
+    grpc::ClientContext context;
+    internal::MarketDataRequest request;
+    auto reader = stub.StreamPrices(&context, request);
+
+    internal::PriceUpdate update;
+    while (result.updates < kTicks && reader->Read(&update)) {
+      ++result.updates;
+      ++result.messages;
+    }
+
+    context.TryCancel();
+    reader->Finish();
+  });
+}
+
+Result RunBatched(internal::MarketDataService::Stub &stub,
+                  unsigned max_batch_delay_us) {
+  return Consume([&stub, max_batch_delay_us](Result &result) {
+    grpc::ClientContext context;
+    internal::MarketDataRequest request;
+    request.set_max_batch_delay_us(max_batch_delay_us);
+    auto reader = stub.StreamPriceBatches(&context, request);
+
+    internal::PriceUpdateBatch batch;
+    while (result.updates < kTicks && reader->Read(&batch)) {
+      result.updates += batch.updates_size();
+      ++result.messages;
+    }
+
+    context.TryCancel();
+    reader->Finish();
+  });
+}
+
+void Print(const std::string &name, const Result &result) {
+  std::cout << std::left << std::setw(24) << name << std::right
+            << std::setw(12) << std::fixed << std::setprecision(0)
+            << result.updates / result.seconds << " updates/s"
+            << std::setw(10) << result.messages << " messages"
+            << std::setw(10) << std::setprecision(1)
+            << static_cast<double>(result.updates) / result.messages
+            << " updates/message" << std::endl;
+}
+
+} // namespace
+
+int main() {
+  BenchService service;
+  int port = 0;
+
+  grpc::ServerBuilder builder;
+  builder.AddListeningPort("127.0.0.1:0", grpc::InsecureServerCredentials(),
+                           &port);
+  builder.RegisterService(&service);
+  std::unique_ptr<grpc::Server> server = builder.BuildAndStart();
+
+  if (!server || port == 0) {
+    std::cerr << "could not start the bench server" << std::endl;
+    return 1;
+  }
+
+  auto channel = grpc::CreateChannel("127.0.0.1:" + std::to_string(port),
+                                     grpc::InsecureChannelCredentials());
+  auto stub = internal::MarketDataService::NewStub(channel);
+
+  std::cout << kTicks << " updates over the loopback" << std::endl;
+
+  Print("per tick", RunPerTick(*stub));
+  Print("batched", RunBatched(*stub, 0));
+  Print("batched, 100us delay", RunBatched(*stub, 100));
+  Print("batched, 1000us delay", RunBatched(*stub, 1000));
+
+  server->Shutdown();
+  return 0;
+}
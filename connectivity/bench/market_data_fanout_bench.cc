@@ -0,0 +1,166 @@
+// cost of handing a point to every subscriber and draining them
+//
+// "name" is the previous MarketDataPoint, a char[32] instrument_id in
+// a 64 byte record, routed through a map keyed by the name
+// "symbol id" is the 32 byte point with a SymbolTable id, routed by an
+// index into a vector, still copied into a queue per subscriber
+// "ring" is the BroadcastRing of the gateway, the point is written once
+// and each subscriber reads it through its cursor
+// every subscriber asks for every instrument, the subscribers are
+// drained by the same thread after each round, as the streams do it
+
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include <boost/lockfree/spsc_queue.hpp>
+
+#include "market_data_subscription.h"
+
+using namespace std::chrono;
+
+namespace {
+
+constexpr int kTicks = 2000000;
+constexpr int kInstruments = 64;
+constexpr std::size_t kQueueSize = 1024;
+
+struct NamedPoint {
+  double price;
+  int64_t quantity;
+  int64_t timestamp_seconds;
+  int32_t timestamp_nanos;
+  char instrument_id[32];
+};
+
+template <typename Point>
+using Queue =
+    boost::lockfree::spsc_queue<Point, boost::lockfree::capacity<kQueueSize>>;
+
+std::string Name(int instrument) {
+  return "INSTRUMENT_" + std::to_string(instrument);
+}
+
+void Print(const std::string &name, int subscribers, std::size_t size,
+           double checksum, double seconds) {
+  std::cout << std::left << std::setw(12) << name << std::right
+            << std::setw(5) << subscribers << " subscribers" << std::setw(4)
+            << size << " bytes" << std::fixed
+            << std::setprecision(1) << std::setw(8)
+            << seconds * 1e9 / kTicks << " ns/point" << std::setw(16)
+            << std::setprecision(0) << checksum << std::endl;
+}
+
+template <typename Point, typename Route>
+void Run(const std::string &name, int subscribers,
+         const std::vector<Point> &points, Route route) {
+  std::vector<Queue<Point>> queues(subscribers);
+  double checksum = 0;
+
+  const auto start = steady_clock::now();
+  for (int i = 0; i < kTicks; ++i) {
+    for (int subscriber : route(points[i % points.size()])) {
+      queues[subscriber].push(points[i % points.size()]);
+    }
+
+    if (i % (kQueueSize / 2) == 0) {
+      for (auto &queue : queues) {
+        queue.consume_all([&checksum](const Point &p) { checksum += p.price; });
+      }
+    }
+  }
+  for (auto &queue : queues) {
+    queue.consume_all([&checksum](const Point &p) { checksum += p.price; });
+  }
+
+  Print(name, subscribers, sizeof(Point), checksum,
+        duration<double>(steady_clock::now() - start).count());
+}
+
+void RunRing(int subscribers, const std::vector<MarketDataPoint> &points) {
+  auto ring = std::make_shared<BroadcastRing>();
+  std::vector<std::unique_ptr<MarketDataSubscription>> readers;
+  for (int s = 0; s < subscribers; ++s) {
+    readers.push_back(std::make_unique<MarketDataSubscription>(ring));
+  }
+  double checksum = 0;
+
+  auto drain = [&readers, &checksum] {
+    MarketDataPoint point;
+    for (auto &reader : readers) {
+      while (reader->Poll(point)) {
+        checksum += point.price;
+      }
+    }
+  };
+
+  const auto start = steady_clock::now();
+  for (int i = 0; i < kTicks; ++i) {
+    ring->Publish(points[i % points.size()]);
+
+    if (i % (kQueueSize / 2) == 0) {
+      drain();
+    }
+  }
+  drain();
+
+  Print("ring", subscribers, sizeof(MarketDataPoint), checksum,
+        duration<double>(steady_clock::now() - start).count());
+}
+
+} // namespace
+
+int main() {
+  std::vector<NamedPoint> named(kInstruments);
+  std::vector<MarketDataPoint> interned(kInstruments);
+  std::vector<std::string> names;
+  for (int i = 0; i < kInstruments; ++i) {
+    names.push_back(Name(i));
+    named[i] = NamedPoint{100.0 + i, i, 0, 0, {}};
+    std::strncpy(named[i].instrument_id, names[i].c_str(),
+                 sizeof(named[i].instrument_id) - 1);
+    interned[i].price = 100.0 + i;
+    interned[i].quantity = i;
+    interned[i].set_instrument_id(names[i]);
+  }
+
+  std::cout << kTicks << " points, " << kInstruments << " instruments"
+            << std::endl;
+
+  for (int subscribers : {16, 256}) {
+    std::vector<int> everyone;
+    for (int s = 0; s < subscribers; ++s) {
+      everyone.push_back(s);
+    }
+
+    std::unordered_map<std::string_view, std::vector<int>> name_routes;
+    std::vector<std::vector<int>> id_routes;
+    for (int i = 0; i < kInstruments; ++i) {
+      name_routes[names[i]] = everyone;
+      if (interned[i].symbol_id >= id_routes.size()) {
+        id_routes.resize(interned[i].symbol_id + 1);
+      }
+      id_routes[interned[i].symbol_id] = everyone;
+    }
+
+    Run("name", subscribers, named,
+        [&name_routes](const NamedPoint &point) -> auto & {
+          return name_routes.find(std::string_view(point.instrument_id))
+              ->second;
+        });
+    Run("symbol id", subscribers, interned,
+        [&id_routes](const MarketDataPoint &point) -> auto & {
+          return id_routes[point.symbol_id];
+        });
+    RunRing(subscribers, interned);
+  }
+
+  return 0;
+}
@@ -0,0 +1,236 @@
+// resource use of the sync and callback MarketDataService against the
+// number of subscribers
+//
+// every subscriber streams StreamPriceBatches for all instruments from
+// an in process server, the feed broadcasts kTickRate ticks a second
+// the clients use the gRPC callback api, so they add the same few
+// threads in both modes, the thread count and the memory are the
+// whole process, the cpu time is per second of the run
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <sys/resource.h>
+#include <thread>
+#include <vector>
+
+#include <grpcpp/grpcpp.h>
+
+#include "services/market_data_callback_service.h"
+#include "services/market_data_service.h"
+
+using namespace std::chrono;
+
+namespace {
+
+constexpr int kTickRate = 10;
+constexpr seconds kMeasure{3};
+// streams sharing one connection
+constexpr int kStreamsPerChannel = 500;
+constexpr std::size_t kSamplesPerReader = 64;
+
+long long NowNs() {
+  return duration_cast<nanoseconds>(steady_clock::now().time_since_epoch())
+      .count();
+}
+
+// Threads and VmRSS of /proc/self/status
+long ProcStatus(const std::string &key) {
+  std::ifstream status("/proc/self/status");
+  std::string line;
+  while (std::getline(status, line)) {
+    if (line.compare(0, key.size(), key) == 0 && line[key.size()] == ':') {
+      return std::stol(line.substr(key.size() + 1));
+    }
+  }
+  return 0;
+}
+
+double CpuSeconds() {
+  rusage usage{};
+  getrusage(RUSAGE_SELF, &usage);
+  return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec +
+         (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e6;
+}
+
+struct Shared {
+  std::atomic<int> ready{0};
+  std::atomic<int> done{0};
+  std::atomic<long long> updates{0};
+  std::atomic<bool> measuring{false};
+};
+
+class Reader final
+    : public grpc::ClientReadReactor<internal::PriceUpdateBatch> {
+public:
+  Reader(internal::MarketDataService::Stub &stub, Shared &shared)
+      : shared_(shared) {
+    samples_.reserve(kSamplesPerReader);
+    stub.async()->StreamPriceBatches(&context_, &request_, this);
+    StartRead(&batch_);
+    StartCall();
+  }
+
+  void OnReadDone(bool ok) override {
+    if (!ok) {
+      return;
+    }
+
+    if (!ready_) {
+      ready_ = true;
+      shared_.ready++;
+    }
+
+    if (shared_.measuring.load(std::memory_order_relaxed)) {
+      shared_.updates += batch_.updates_size();
+      if (samples_.size() < kSamplesPerReader) {
+        // the feed sends its clock in the timestamp
+        samples_.push_back(NowNs() - batch_.updates(0).timestamp().seconds());
+      }
+    }
+
+    StartRead(&batch_);
+  }
+
+  void OnDone(const grpc::Status & /*status*/) override { shared_.done++; }
+
+  void Cancel() { context_.TryCancel(); }
+
+  const std::vector<long long> &Samples() const { return samples_; }
+
+private:
+  Shared &shared_;
+  grpc::ClientContext context_;
+  internal::MarketDataRequest request_;
+  internal::PriceUpdateBatch batch_;
+  bool ready_ = false;
+  std::vector<long long> samples_;
+};
+
+template <typename Service>
+void Run(std::ostream &out, const std::string &name, int subscribers) {
+  auto gateway = std::make_shared<PythonApiGtw>();
+  Service service(gateway);
+
+  const long threads_before = ProcStatus("Threads");
+
+  int port = 0;
+  grpc::ServerBuilder builder;
+  builder.AddListeningPort("127.0.0.1:0", grpc::InsecureServerCredentials(),
+                           &port);
+  builder.RegisterService(&service);
+  std::unique_ptr<grpc::Server> server = builder.BuildAndStart();
+
+  std::vector<std::unique_ptr<internal::MarketDataService::Stub>> stubs;
+  for (int i = 0; i < subscribers; i += kStreamsPerChannel) {
+    grpc::ChannelArguments args;
+    // one connection per channel instead of a shared one
+    args.SetInt(GRPC_ARG_USE_LOCAL_SUBCHANNEL_POOL, 1);
+    stubs.push_back(internal::MarketDataService::NewStub(
+        grpc::CreateCustomChannel("127.0.0.1:" + std::to_string(port),
+                                  grpc::InsecureChannelCredentials(), args)));
+  }
+
+  Shared shared;
+  std::vector<std::unique_ptr<Reader>> readers;
+  for (int i = 0; i < subscribers; ++i) {
+    readers.push_back(
+        std::make_unique<Reader>(*stubs[i / kStreamsPerChannel], shared));
+  }
+
+  std::atomic<bool> stop_feed{false};
+  std::thread feed([&] {
+    MarketDataPoint point;
+    point.quantity = 100;
+    point.set_instrument_id("AAPL");
+
+    auto next = steady_clock::now();
+    while (!stop_feed.load()) {
+      next += microseconds(1000000 / kTickRate);
+      std::this_thread::sleep_until(next);
+      point.timestamp_seconds = NowNs();
+      gateway->Broadcast(point);
+    }
+  });
+
+  // every subscriber got a tick
+  const auto connect_deadline = steady_clock::now() + seconds(60);
+  while (shared.ready.load() < subscribers &&
+         steady_clock::now() < connect_deadline) {
+    std::this_thread::sleep_for(milliseconds(10));
+  }
+
+  const double cpu_start = CpuSeconds();
+  shared.measuring = true;
+  std::this_thread::sleep_for(kMeasure);
+  shared.measuring = false;
+  const double cpu = (CpuSeconds() - cpu_start) / kMeasure.count();
+
+  const long threads = ProcStatus("Threads") - threads_before;
+  const long rss_mb = ProcStatus("VmRSS") / 1024;
+
+  stop_feed = true;
+  feed.join();
+
+  for (auto &reader : readers) {
+    reader->Cancel();
+  }
+  while (shared.done.load() < subscribers) {
+    std::this_thread::sleep_for(milliseconds(1));
+  }
+  server->Shutdown();
+
+  std::vector<long long> latencies;
+  for (const auto &reader : readers) {
+    latencies.insert(latencies.end(), reader->Samples().begin(),
+                     reader->Samples().end());
+  }
+  std::sort(latencies.begin(), latencies.end());
+  const auto percentile = [&latencies](double percent) {
+    if (latencies.empty()) {
+      return 0.0;
+    }
+    return latencies[static_cast<std::size_t>(
+               percent / 100.0 * (latencies.size() - 1))] /
+           1000.0;
+  };
+
+  const double expected =
+      static_cast<double>(subscribers) * kTickRate * kMeasure.count();
+
+  out << std::left << std::setw(10) << name << std::right
+            << std::setw(6) << subscribers << std::setw(8) << threads
+            << std::setw(9) << rss_mb << std::fixed << std::setprecision(2)
+            << std::setw(8) << cpu << std::setprecision(1) << std::setw(9)
+            << 100.0 * shared.updates.load() / expected << "%"
+            << std::setprecision(0) << std::setw(10) << percentile(50)
+            << std::setw(10) << percentile(99) << std::endl;
+}
+
+} // namespace
+
+int main() {
+  // the services log every subscriber, only the results are printed
+  std::ostream out(std::cout.rdbuf());
+  std::cout.rdbuf(nullptr);
+  std::cerr.rdbuf(nullptr);
+
+  out << kTickRate << " ticks/s to every subscriber, " << kMeasure.count()
+            << "s per run\n"
+            << "mode        subs threads  rss MB  cpu/s delivered  p50 us"
+               "    p99 us"
+            << std::endl;
+
+  for (int subscribers : {10, 100, 1000, 5000}) {
+    Run<MarketDataService>(out, "sync", subscribers);
+    Run<MarketDataCallbackService>(out, "callback", subscribers);
+  }
+
+  return 0;
+}
@@ -0,0 +1,153 @@
+// replay of a recording through the gateway
+//
+// "max" replays kPoints records of kInstruments instruments with no
+// pacing, to 0 and to kSubscribers subscriptions each read by its own
+// thread, "points/s" is every point published over the replay
+// "paced" replays kPacedPoints records kPacedInterval apart at several
+// speeds, "late" is the worst delay behind the pace of the recording
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "feed_protocol.h"
+#include "python_api_gtw.h"
+#include "replay_feed_gateway.h"
+
+using namespace std::chrono;
+
+namespace {
+
+constexpr int kPoints = 2000000;
+constexpr int kInstruments = 256;
+constexpr int kSubscribers = 4;
+constexpr int kPacedPoints = 20000;
+constexpr nanoseconds kPacedInterval = microseconds(100);
+
+std::string Record(const std::string &symbol, double price,
+                   int64_t timestamp_ns, uint64_t sequence) {
+  std::string record(kBinaryRecordHeaderSize + symbol.size() + 8, '\0');
+  const uint16_t length = static_cast<uint16_t>(record.size());
+  const uint8_t symbol_length = static_cast<uint8_t>(symbol.size());
+  const int64_t quantity = 100;
+
+  std::memcpy(&record[0], &length, sizeof(length));
+  std::memcpy(&record[2], &symbol_length, sizeof(symbol_length));
+  std::memcpy(&record[4], &price, sizeof(price));
+  std::memcpy(&record[12], &quantity, sizeof(quantity));
+  std::memcpy(&record[20], &timestamp_ns, sizeof(timestamp_ns));
+  std::memcpy(&record[kBinaryRecordHeaderSize], symbol.data(), symbol.size());
+  std::memcpy(&record[kBinaryRecordHeaderSize + symbol.size()], &sequence,
+              sizeof(sequence));
+  return record;
+}
+
+std::string WriteRecording(int points, nanoseconds interval) {
+  char path[] = "/tmp/replay_benchXXXXXX";
+  const int fd = mkstemp(path);
+  close(fd);
+
+  std::ofstream recording(path, std::ios::binary);
+  recording << static_cast<char>(kBinaryFeedHandshake);
+  const int64_t start = 1700000000000000000;
+  for (int i = 0; i < points; ++i) {
+    recording << Record("REPLAY" + std::to_string(i % kInstruments), i,
+                        start + i * interval.count(), i + 1);
+  }
+  return path;
+}
+
+struct Result {
+  uint64_t points;
+  nanoseconds elapsed;
+  nanoseconds late;
+};
+
+Result Replay(const std::string &path, double speed, int subscribers) {
+  PythonApiGtw gateway(1 << 20);
+  auto replay = std::make_unique<ReplayFeedGateway>(path, speed);
+  ReplayFeedGateway &feed = *replay;
+  gateway.AddFeed(std::move(replay));
+
+  std::vector<std::shared_ptr<MarketDataSubscription>> subscriptions;
+  std::vector<std::thread> readers;
+  for (int i = 0; i < subscribers; ++i) {
+    SubscriptionOptions options;
+    options.policy = BackpressurePolicy::DropOldest;
+    options.capacity = 1 << 19;
+    subscriptions.push_back(gateway.Subscribe({}, {}, options));
+  }
+  for (auto &subscription : subscriptions) {
+    readers.emplace_back([&subscription] {
+      MarketDataPoint point;
+      while (subscription->active.load() || subscription->HasPending()) {
+        if (!subscription->Poll(point)) {
+          std::this_thread::yield();
+        }
+      }
+    });
+  }
+
+  const auto start = steady_clock::now();
+  gateway.Start();
+  while (gateway.IsRunning()) {
+    std::this_thread::sleep_for(microseconds(100));
+  }
+  const auto elapsed = steady_clock::now() - start;
+
+  for (auto &reader : readers) {
+    reader.join();
+  }
+  for (auto &subscription : subscriptions) {
+    gateway.Unsubscribe(subscription);
+  }
+  return {feed.ReplayedCount(), elapsed, feed.MaxLateness()};
+}
+
+} // namespace
+
+int main() {
+  std::ostream out(std::cout.rdbuf());
+  // the feed and subscription lines of the gateway
+  std::cout.rdbuf(nullptr);
+
+  const std::string recording = WriteRecording(kPoints, microseconds(1));
+  out << kPoints << " records of " << kInstruments << " instruments"
+      << std::endl;
+
+  for (int subscribers : {0, kSubscribers}) {
+    const Result result =
+        Replay(recording, ReplayFeedGateway::kAsFastAsPossible, subscribers);
+    out << "max, " << subscribers << " subscriptions" << std::fixed
+        << std::setprecision(2) << std::setw(10)
+        << result.points / duration<double>(result.elapsed).count() / 1e6
+        << " M points/s" << std::endl;
+  }
+  std::remove(recording.c_str());
+
+  const std::string paced = WriteRecording(kPacedPoints, kPacedInterval);
+  out << kPacedPoints << " records " << kPacedInterval.count() / 1000
+      << " us apart" << std::endl;
+
+  for (double speed : {1.0, 10.0, 100.0}) {
+    const Result result = Replay(paced, speed, kSubscribers);
+    out << "paced x" << std::setw(3) << static_cast<int>(speed) << std::fixed
+        << std::setprecision(1) << std::setw(10)
+        << duration<double, std::milli>(result.elapsed).count() << " ms"
+        << std::setw(10)
+        << duration<double, std::micro>(result.late).count() << " us late"
+        << std::endl;
+  }
+  std::remove(paced.c_str());
+  return 0;
+}
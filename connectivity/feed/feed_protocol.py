@@ -0,0 +1,45 @@
+"""Encoder for the feed the Distributor reads on port 9000.
+
+Send HANDSHAKE once, right after the Distributor connected, then one
+encode_tick() per tick. A feed that never sends HANDSHAKE is read as
+newline delimited json, see encode_json_tick().
+
+The record layout is described in connectivity/includes/feed_protocol.h
+"""
+
+import json
+import struct
+
+HANDSHAKE = b'\xfb'
+
+# length, symbol length, reserved, price, quantity, timestamp ns
+_HEADER = struct.Struct('<HBxdqq')
+# after the symbol, optional
+_SEQUENCE = struct.Struct('<Q')
+
+# the Distributor keeps 31 characters of an instrument id
+MAX_SYMBOL_LENGTH = 31
+
+
+def encode_tick(instrument_id, price, quantity, timestamp_ns=0, sequence=0):
+    """One binary record, timestamp_ns 0 lets the Distributor stamp it.
+
+    A feed sent on two lines numbers its ticks from 1 with sequence, the
+    same number on both, so the Distributor keeps the first copy.
+    """
+    symbol = instrument_id.encode('ascii')
+    if len(symbol) > MAX_SYMBOL_LENGTH:
+        raise ValueError(f"instrument id longer than {MAX_SYMBOL_LENGTH}: {instrument_id}")
+
+    trailer = _SEQUENCE.pack(sequence) if sequence else b''
+    length = _HEADER.size + len(symbol) + len(trailer)
+    return _HEADER.pack(length, len(symbol), price, quantity, timestamp_ns) + symbol + trailer
+
+
+def encode_json_tick(instrument_id, price, quantity):
+    """The json line older feeds send, kept for compatibility."""
+    return (json.dumps({
+        'instrument_id': instrument_id,
+        'price': price,
+        'quantity': quantity,
+    }) + '\n').encode('utf-8')
@@ -0,0 +1,52 @@
+"""Writes a recording the Distributor replays with --replay.
+
+Reads the price files of the Kaggle "Daily and Intraday Stock Price
+Data" dataset, one instrument per file (aapl.us.txt is AAPL), with
+either of the headers
+    Date,Open,High,Low,Close,Volume,OpenInt
+    Date,Time,Open,High,Low,Close,Volume,OpenInt
+and writes one binary record per bar, its close and volume, the files
+merged in time order and numbered from 1.
+
+    python3 record_ticks.py intraday.ticks 5min/aapl.us.txt 5min/msft.us.txt
+
+The times of the dataset are read as UTC.
+"""
+
+import csv
+import heapq
+import os
+import sys
+from datetime import datetime, timezone
+
+import feed_protocol
+
+
+def read_bars(path):
+    """(timestamp ns, instrument id, close, volume) of each bar of path."""
+    instrument_id = os.path.basename(path).split('.')[0].upper()
+
+    with open(path, newline='') as prices:
+        for row in csv.DictReader(prices):
+            when = row['Date'] + ' ' + row.get('Time', '00:00:00')
+            moment = datetime.strptime(when, '%Y-%m-%d %H:%M:%S')
+            timestamp_ns = int(moment.replace(tzinfo=timezone.utc).timestamp()) * 1_000_000_000
+            yield timestamp_ns, instrument_id, float(row['Close']), int(float(row['Volume']))
+
+
+def main(output, inputs):
+    count = 0
+    with open(output, 'wb') as recording:
+        recording.write(feed_protocol.HANDSHAKE)
+        # each file is in time order already
+        for timestamp_ns, instrument_id, price, volume in heapq.merge(*(read_bars(path) for path in inputs)):
+            count += 1
+            recording.write(feed_protocol.encode_tick(instrument_id, price, volume, timestamp_ns, sequence=count))
+
+    print(f"{count} ticks of {len(inputs)} instruments written to {output}")
+
+
+if __name__ == '__main__':
+    if len(sys.argv) < 3:
+        sys.exit(f"usage: {sys.argv[0]} output.ticks prices.txt...")
+    main(sys.argv[1], sys.argv[2:])
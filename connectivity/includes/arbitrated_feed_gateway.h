@@ -0,0 +1,119 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <bitset>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "feed_gateway.h"
+
+// the same feed received on two lines, A and B, read as one feed
+//
+// a point the feed numbered, a binary record with a sequence, is taken
+// from the line it arrives on first, its copy on the other line is
+// dropped, so a line which stalls or drops costs nothing while the
+// other one still delivers
+// the sequences taken are kept for the newest kSequenceWindow, a line
+// behind the other one fills in what the other one skipped
+// a line whose sequence goes back, in a session or over a reconnect, is
+// a feed which numbers again from there, the other line follows once
+// it goes back too or reconnects
+// a point without a sequence, a json line, is only taken from the
+// active line, the other one takes over once the active line sent
+// nothing for stall_timeout or closed
+// the feed closes once both lines did, lines which reconnect keep the
+// streams of the subscriptions open while one of them is down
+class ArbitratedFeedGateway : public FeedGateway, public FeedSink {
+public:
+    static constexpr std::size_t kLineA = 0;
+    static constexpr std::size_t kLineB = 1;
+    static constexpr std::chrono::milliseconds kDefaultStallTimeout{50};
+    // sequences this far behind the newest one are given up on
+    static constexpr uint64_t kSequenceWindow = 1 << 12;
+
+    ArbitratedFeedGateway(
+        std::unique_ptr<FeedGateway> line_a,
+        std::unique_ptr<FeedGateway> line_b,
+        std::chrono::milliseconds stall_timeout = kDefaultStallTimeout);
+    ~ArbitratedFeedGateway() override;
+
+    ArbitratedFeedGateway(const ArbitratedFeedGateway&) = delete;
+    ArbitratedFeedGateway& operator=(const ArbitratedFeedGateway&) = delete;
+
+    std::string Name() const override;
+
+    void Start(FeedSink& sink, std::size_t feed) override;
+    void Stop() override;
+
+    bool IsRunning() const override;
+
+    // the threads of the lines
+    void OnPoint(std::size_t line,
+                 const MarketDataPoint& point,
+                 uint64_t sequence) override;
+    void OnFeedClosed(std::size_t line) override;
+    void OnFeedSession(std::size_t line) override;
+
+    // counters, any thread
+    // points of line handed to the gateway
+    uint64_t WonCount(std::size_t line) const { return won_[line].load(); }
+    // copies of line dropped, points of the standby line, or of a
+    // numbering the feed left
+    uint64_t DuplicateCount(std::size_t line) const {
+        return duplicates_[line].load();
+    }
+    // sequences which arrived on neither line before they left the
+    // window
+    uint64_t GapCount() const { return gaps_.load(); }
+    // times the active line stalled or closed and the other one took over
+    uint64_t FailoverCount() const { return failovers_.load(); }
+    std::size_t ActiveLine() const { return active_.load(); }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    // must be called with mutex_ held
+    bool Stalled(std::size_t line, Clock::time_point now) const;
+    // false when sequence of line is one of a numbering the feed left,
+    // starts a new numbering when line went back
+    // must be called with mutex_ held
+    bool FollowsNumbering(std::size_t line, uint64_t sequence);
+    // false when sequence was taken already or left the window
+    // must be called with mutex_ held
+    bool Take(uint64_t sequence);
+
+    std::array<std::unique_ptr<FeedGateway>, 2> lines_;
+    const std::chrono::milliseconds stall_timeout_;
+
+    FeedSink* sink_ = nullptr;
+    std::size_t feed_ = 0;
+    std::atomic<bool> running_{false};
+
+    // held while a point is arbitrated and handed over, so the points
+    // leave in the order they were taken
+    std::mutex mutex_;
+    // the oldest sequence of the window, 0 before the first one
+    uint64_t window_start_ = 0;
+    // by sequence % kSequenceWindow, the sequences of the window taken
+    std::bitset<kSequenceWindow> taken_;
+    // one more each time the feed restarted its numbering
+    uint64_t numbering_ = 0;
+    // by line, the numbering its sequences follow, its last sequence,
+    // kept over reconnects, and whether it reconnected since
+    std::array<uint64_t, 2> line_numbering_{};
+    std::array<uint64_t, 2> line_sequence_{};
+    std::array<bool, 2> new_session_{};
+    std::array<Clock::time_point, 2> last_arrival_{};
+    std::array<bool, 2> closed_{};
+
+    std::atomic<std::size_t> active_{kLineA};
+    std::array<std::atomic<uint64_t>, 2> won_{};
+    std::array<std::atomic<uint64_t>, 2> duplicates_{};
+    std::atomic<uint64_t> gaps_{0};
+    std::atomic<uint64_t> failovers_{0};
+};
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+#include "market_data_point.h"
+
+// in-process broadcast of the feed to the subscriptions
+//
+// the gateway writes each point once, every subscription
+// reads it through its own BroadcastReader, a cursor, so a point costs
+// the same whatever the number of subscriptions
+// one writer, readers never slow it down: a reader which is lapped
+// goes on from the oldest point still in the ring and counts the ones
+// it lost
+// the slots are the seqlocks of the shared memory MarketDataRing
+class BroadcastRing {
+public:
+    static constexpr uint32_t kDefaultCapacity = 1 << 16;
+
+    enum class ReadStatus { Ok, NotPublished, Overwritten };
+
+    // capacity is rounded up to a power of 2
+    explicit BroadcastRing(uint32_t capacity = kDefaultCapacity);
+
+    BroadcastRing(const BroadcastRing&) = delete;
+    BroadcastRing& operator=(const BroadcastRing&) = delete;
+
+    // only one thread at a time can publish
+    void Publish(const MarketDataPoint& point);
+
+    // sequence of the next point published
+    uint64_t Published() const;
+
+    uint64_t Capacity() const { return mask_ + 1; }
+
+    // copies point number sequence, any thread
+    ReadStatus Read(uint64_t sequence, MarketDataPoint& point) const;
+
+private:
+    struct alignas(64) Slot {
+        // 2 * (n + 1) once point n is written, odd while it is written
+        std::atomic<uint64_t> sequence{0};
+        MarketDataPoint point;
+    };
+
+    uint64_t mask_;
+    std::unique_ptr<Slot[]> slots_;
+
+    alignas(64) std::atomic<uint64_t> published_{0};
+};
+
+// a cursor in a BroadcastRing, one thread at a time reads through it
+class BroadcastReader {
+public:
+    // reading starts at the next point published
+    explicit BroadcastReader(std::shared_ptr<const BroadcastRing> ring);
+
+    BroadcastReader(const BroadcastReader&) = delete;
+    BroadcastReader& operator=(const BroadcastReader&) = delete;
+
+    // copies the next point, false when none was published yet
+    bool Poll(MarketDataPoint& point);
+
+    const BroadcastRing& Ring() const { return *ring_; }
+
+    // moves the cursor forward to sequence, the points in between are
+    // not counted as lost
+    void SkipTo(uint64_t sequence);
+
+    // sequence of the next point read, any thread
+    uint64_t Next() const { return next_.load(std::memory_order_acquire); }
+
+    // points published and not read yet, any thread
+    uint64_t Lag() const;
+
+    // points overwritten before this reader got to them, any thread
+    uint64_t LostCount() const { return lost_.load(std::memory_order_relaxed); }
+
+private:
+    // after a lap, reading goes on from the oldest point still kept
+    void Resync();
+
+    std::shared_ptr<const BroadcastRing> ring_;
+    std::atomic<uint64_t> next_;
+    std::atomic<uint64_t> lost_{0};
+};
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+
+// wakes one consumer thread when a producer has something for it
+//
+// Ring() is an atomic increment, plus a notify only while the consumer
+// is parked, so a busy stream costs the producer no syscall
+// the consumer reads Rings() before looking for data, then waits for
+// that count to move, a ring in between is never lost
+class Doorbell {
+public:
+    void Ring();
+
+    uint64_t Rings() const;
+
+    // returns true once Rings() is no longer seen
+    // spins for spin first, then parks until timeout
+    bool Wait(uint64_t seen,
+              std::chrono::nanoseconds spin,
+              std::chrono::nanoseconds timeout);
+
+private:
+    std::atomic<uint64_t> rings_{0};
+    std::atomic<bool> parked_{false};
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+};
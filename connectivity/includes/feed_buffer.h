@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string_view>
+
+// fixed buffer between the feed socket and the decoders
+//
+// the socket reads straight into the free space at the back, complete
+// lines or records are handed out in place as string_views, only the
+// partial one left at the end of a read is moved to the front
+// it never grows and never clears what it holds: when it is full the
+// socket is not read, and tcp slows the feed down
+class FeedBuffer {
+public:
+    static constexpr std::size_t kDefaultCapacity = 64 * 1024;
+
+    explicit FeedBuffer(std::size_t capacity = kDefaultCapacity);
+
+    FeedBuffer(const FeedBuffer&) = delete;
+    FeedBuffer& operator=(const FeedBuffer&) = delete;
+
+    // where the next read goes, moves the unread bytes to the front
+    // first when less than half the buffer is free at the back
+    char* WriteData();
+    std::size_t WriteSpace() const;
+    // n bytes were written at WriteData()
+    void Commit(std::size_t n);
+
+    // bytes written and not consumed
+    std::string_view Data() const;
+    void Consume(std::size_t n);
+
+    // the next complete line, without its '\n', valid until the next
+    // WriteData()
+    // a line longer than the buffer can never complete, it is
+    // dropped up to its '\n' and counted in DroppedLines()
+    bool NextLine(std::string_view& line);
+
+    std::size_t Capacity() const { return capacity_; }
+    std::size_t DroppedLines() const { return dropped_lines_; }
+
+private:
+    void Compact();
+
+    std::unique_ptr<char[]> data_;
+    std::size_t capacity_;
+    // unread bytes are [read_, write_)
+    std::size_t read_ = 0;
+    std::size_t write_ = 0;
+
+    // inside a line too long for the buffer
+    bool dropping_line_ = false;
+    std::size_t dropped_lines_ = 0;
+};
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "feed_protocol.h"
+#include "market_data_point.h"
+
+// where a feed hands its points, the PythonApiGtw which sequences them
+// into the one stream of the subscriptions
+// every feed calls it from its own ingest thread, at the same time
+class FeedSink {
+public:
+    virtual ~FeedSink() = default;
+
+    // feed is the index the feed was started with, sequence the one
+    // of the record, kNoSequence for the feeds which do not number them
+    virtual void OnPoint(std::size_t feed,
+                         const MarketDataPoint& point,
+                         uint64_t sequence) = 0;
+    // once per Start(), after the last OnPoint() of the feed
+    virtual void OnFeedClosed(std::size_t feed) = 0;
+    // before the points of each connection of a feed which reconnects,
+    // the sequences of a new session follow the numbering of the feed
+    // at that time, which may have started again from 1
+    virtual void OnFeedSession(std::size_t /*feed*/) {}
+};
+
+// a source of market data with its own ingest thread
+// reading and decoding run there, so several feeds decode in parallel
+class FeedGateway {
+public:
+    virtual ~FeedGateway() = default;
+
+    // for the logs
+    virtual std::string Name() const = 0;
+
+    // starts the ingest thread, which hands every point to sink until
+    // Stop() or the end of the feed
+    virtual void Start(FeedSink& sink, std::size_t feed) = 0;
+    // returns once the ingest thread is joined
+    virtual void Stop() = 0;
+
+    virtual bool IsRunning() const = 0;
+};
+
+// which points of an instrument are published when several feeds send it
+enum class FeedConflictRule {
+    // every point, for feeds which split the instruments between them
+    AcceptAll,
+    // the points of the first feed added among those which sent the
+    // instrument, until it closes
+    FeedPriority,
+    // a point older than the last one published for its instrument is
+    // dropped, so each instrument moves forward in time
+    NewestTimestamp,
+};
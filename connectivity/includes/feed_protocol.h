@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+#include "market_data_point.h"
+
+// what the python feed sends on port 9000
+//
+// a feed starting with kBinaryFeedHandshake sends binary records,
+// anything else is read as newline delimited json, one tick per line
+// {"instrument_id": "AAPL", "price": 1.5, "quantity": 10}
+//
+// a binary record, little endian and unaligned
+//   uint16  length         whole record, symbol included
+//   uint8   symbol_length
+//   uint8   reserved       0
+//   double  price
+//   int64   quantity
+//   int64   timestamp_ns   since the epoch, 0 stamps it on receipt
+//   char    symbol[symbol_length], not null terminated
+//   uint64  sequence       optional, from 1, the same on the A and B
+//                          lines of a feed, see arbitrated_feed_gateway.h
+// a length longer than the record is skipped, later versions can add
+// fields after the sequence, up to kBinaryRecordMaxSize
+// connectivity/feed/feed_protocol.py encodes it
+
+constexpr uint8_t kBinaryFeedHandshake = 0xFB;
+constexpr std::size_t kBinaryRecordHeaderSize = 28;
+// anything longer is a stream that lost its framing
+constexpr std::size_t kBinaryRecordMaxSize = 512;
+// a record without the optional sequence
+constexpr uint64_t kNoSequence = 0;
+
+enum class FeedFormat {
+    // nothing read yet
+    Unknown,
+    Json,
+    Binary,
+};
+
+enum class DecodeStatus {
+    Ok,
+    // the record is not complete in the buffer
+    NeedMore,
+    // the stream is not binary records, framing is lost
+    Invalid,
+};
+
+// decodes the record at the front of data, consumed is its length
+DecodeStatus DecodeBinaryRecord(const char* data,
+                                std::size_t size,
+                                MarketDataPoint& point,
+                                std::size_t& consumed);
+// and its sequence, kNoSequence when it has none
+DecodeStatus DecodeBinaryRecord(const char* data,
+                                std::size_t size,
+                                MarketDataPoint& point,
+                                std::size_t& consumed,
+                                uint64_t& sequence);
+
+// fills and stamps point from a json line, DecodeJsonTick first
+// then nlohmann for the shapes it does not take
+// throws what nlohmann::json throws
+void ParseJsonTick(std::string_view line, MarketDataPoint& point);
+
+// the nlohmann part of ParseJsonTick, no timestamp
+void ParseJsonTickDom(std::string_view line, MarketDataPoint& point);
+
+// system clock, for the ticks the feed did not stamp
+void StampNow(MarketDataPoint& point);
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <string_view>
+
+#include "market_data_point.h"
+
+// decoder for the json ticks of the feed, no DOM and no allocation
+//
+// it only takes a flat object whose keys are among price, quantity and
+// instrument_id, with numbers and an unescaped string as values, in any
+// order, with any whitespace
+// {"instrument_id": "AAPL", "price": 1.5, "quantity": 10}
+// the quotes are found 16 bytes at a time with SSE2 where available
+//
+// returns false on anything else, point is then left as it was and
+// the line goes to nlohmann (ParseJsonTick does both)
+// the timestamp is not set
+bool DecodeJsonTick(std::string_view line, MarketDataPoint& point);
@@ -1,18 +1,23 @@
 #pragma once
 
 #include <cstdint>
-#include <cstring>
+#include <string_view>
+#include <type_traits>
+
+#include "symbol_table.h"
 
 // Plain Old Data struct for passing market data between threads
-// Must be trivially copyable for use with boost::lockfree::spsc_queue
-// It is added because we want to pass a simple data structure to the queue
-// so that pushing to the queue is fast
+// Must be trivially copyable, the BroadcastRing copies it with memcpy
+// It is added because we want to pass a simple data structure to the ring
+// so that publishing to the ring is fast
+// the instrument is an id of the SymbolTable, its name is only looked up
+// when the point leaves the process
 struct MarketDataPoint {
     double price;
     int64_t quantity;
     int64_t timestamp_seconds;
     int32_t timestamp_nanos;
-    char instrument_id[32];  // Fixed size for trivial copyability
+    uint32_t symbol_id;
 
     // Default constructor
     MarketDataPoint()
@@ -20,14 +25,19 @@ struct MarketDataPoint {
         , quantity(0)
         , timestamp_seconds(0)
         , timestamp_nanos(0)
-        , instrument_id{0} {}
+        , symbol_id(SymbolTable::kEmptyId) {}
+
+    // interns id, truncated to SymbolTable::kMaxNameLength
+    void set_instrument_id(std::string_view id) {
+        symbol_id = SymbolTable::GetInstance().Intern(id);
+    }
 
-    // Helper to set instrument_id safely
-    void set_instrument_id(const char* id) {
-        std::strncpy(instrument_id, id, sizeof(instrument_id) - 1);
-        instrument_id[sizeof(instrument_id) - 1] = '\0';  // Ensure null termination
+    std::string_view instrument_id() const {
+        return SymbolTable::GetInstance().Name(symbol_id);
     }
 };
 
 static_assert(std::is_trivially_copyable<MarketDataPoint>::value,
-              "MarketDataPoint must be trivially copyable for lock-free queue");
+              "MarketDataPoint must be trivially copyable for the broadcast ring");
+static_assert(sizeof(MarketDataPoint) == 32,
+              "a point and its sequence fit a cache line of the broadcast ring");
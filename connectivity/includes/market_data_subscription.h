@@ -1,12 +1,163 @@
 #pragma once
 
 #include <atomic>
-#include <boost/lockfree/spsc_queue.hpp>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include "broadcast_ring.h"
+#include "doorbell.h"
 #include "market_data_point.h"
 
+// what a subscription does once it lags capacity of its points behind
+// the feed
+enum class BackpressurePolicy {
+    // the points published while it is full are skipped
+    DropNewest,
+    // the oldest points are skipped, the newest capacity are kept
+    DropOldest,
+    // the backlog is replaced by the latest point of each instrument
+    ConflatePerInstrument,
+    // Broadcast waits up to block_timeout for the subscription to read,
+    // then the oldest points are skipped
+    BlockWithTimeout,
+    // Broadcast closes the subscription
+    DisconnectSlowConsumer,
+};
+
+struct SubscriptionOptions {
+    static constexpr uint64_t kDefaultCapacity = 1024;
+
+    BackpressurePolicy policy = BackpressurePolicy::DropNewest;
+    // points of the subscription it can lag behind, the points of the
+    // other instruments do not count, the gateway keeps it under half of
+    // its ring
+    uint64_t capacity = kDefaultCapacity;
+    std::chrono::microseconds block_timeout{1000};
+};
+
 struct MarketDataSubscription {
-    using Queue = boost::lockfree::spsc_queue<MarketDataPoint, boost::lockfree::capacity<1024>>;
+    // reading starts at the next point published in ring, or at the
+    // next point pushed once it has instruments
+    MarketDataSubscription(std::shared_ptr<const BroadcastRing> ring,
+                           const SubscriptionOptions& options = {});
+
+    // cursor of this subscription in the ring of the gateway, when it
+    // reads every instrument, only the stream moves it
+    BroadcastReader reader;
+    const SubscriptionOptions options;
 
-    Queue queue;
     std::atomic<bool> active{true};
+    // set before active goes false when the policy closed it
+    std::atomic<bool> disconnected{false};
+    // rung after each point of the subscription and when it ends
+    Doorbell doorbell;
+
+    // instruments read by this subscription, every instrument when empty
+    // not modified after Subscribe()
+    std::vector<std::string> instrument_ids;
+    // the SymbolTable ids of instrument_ids, which the routes use
+    std::vector<uint32_t> symbol_ids;
+
+    // called after each point of the subscription and by Close(),
+    // for a stream with no thread of its own to wake,
+    // not modified after Subscribe()
+    std::function<void()> on_push;
+
+    // counters, read from any thread
+    // points of the subscription skipped or conflated by the policy
+    std::atomic<uint64_t> dropped{0};
+    // highest lag seen by Broadcast
+    std::atomic<uint64_t> max_lag{0};
+    // times Broadcast gave up waiting, BlockWithTimeout only
+    std::atomic<uint64_t> block_timeouts{0};
+
+    // points of the subscription published and not read yet
+    uint64_t Lag() const;
+    // points of the subscription overwritten before they were read,
+    // on top of dropped
+    uint64_t LostCount() const {
+        return reader.LostCount() + lost_.load(std::memory_order_relaxed);
+    }
+
+    // interns ids, before the subscription is handed to the gateway
+    void SetInstruments(std::vector<std::string> ids);
+
+    // with instruments, the gateway hands over each point of the
+    // subscription once it is in the ring, at sequence
+    // only the thread publishing to the ring calls it
+    void Push(uint64_t sequence);
+
+    bool Wants(uint32_t symbol_id) const {
+        return instrument_ids.empty() ||
+               (symbol_id < wanted_.size() && wanted_[symbol_id]);
+    }
+
+    // copies the next point of the subscription, the points of the
+    // other instruments are skipped
+    // applies the policy first when the subscription lags too far
+    bool Poll(MarketDataPoint& point);
+
+    // true when Poll() has a point to return
+    // does not move the cursor, so any thread can ask
+    bool HasPending() const;
+
+    // wakes the stream so it sees active is false
+    void Close();
+
+private:
+    // a point of a subscription with instruments, a seqlock like the
+    // slots of the ring
+    struct PendingPoint {
+        // 2 * (position + 1) once pushed, odd while it is pushed
+        std::atomic<uint64_t> position{0};
+        // in the ring
+        std::atomic<uint64_t> sequence{0};
+    };
+
+    // the policies count in positions among the points of the
+    // subscription: the sequence in the ring when every instrument is
+    // read, the number of points pushed before it otherwise
+    uint64_t Next() const;
+    // position of the next point published
+    uint64_t End() const;
+    // copies the point at position
+    BroadcastRing::ReadStatus Read(uint64_t position,
+                                   MarketDataPoint& point) const;
+    void MoveTo(uint64_t position);
+
+    void ApplyPolicy();
+    // moves the cursor to position, counting the points in between as
+    // dropped
+    void SkipTo(uint64_t position);
+    // fills conflated_ with the latest point of each instrument up to
+    // position end and moves the cursor there
+    void Conflate(uint64_t end);
+
+    // indexed by symbol id, empty when every instrument is read
+    std::vector<bool> wanted_;
+
+    // with instruments, the newest 2 * capacity points pushed
+    std::unique_ptr<PendingPoint[]> pending_;
+    uint64_t pending_mask_ = 0;
+    std::atomic<uint64_t> pushed_{0};
+    std::atomic<uint64_t> next_{0};
+    std::atomic<uint64_t> lost_{0};
+
+    // DropNewest, once full, the points up to keep_until_ are read
+    // then reading goes on at resume_at_
+    bool holding_ = false;
+    uint64_t keep_until_ = 0;
+    uint64_t resume_at_ = 0;
+
+    // ConflatePerInstrument, returned by Poll() before the ring
+    std::vector<MarketDataPoint> conflated_;
+    std::size_t conflated_next_ = 0;
+    // 1 + index in conflated_, by symbol id, while it is filled
+    std::vector<uint32_t> conflated_index_;
+    // for HasPending()
+    std::atomic<std::size_t> conflated_left_{0};
 };
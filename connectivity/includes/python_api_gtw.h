@@ -1,36 +1,121 @@
 #pragma once
 
 #include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
 #include <memory>
+#include <mutex>
 #include <shared_mutex>
-#include <thread>
+#include <string>
 #include <vector>
 
+#include "broadcast_ring.h"
+#include "feed_gateway.h"
 #include "market_data_subscription.h"
+#include "services/market_data_ring.h"
 
-class PythonApiGtw {
+// sequences the points of its feeds into one stream, read by the
+// subscriptions and by the scripts of this host
+// each feed reads and decodes on its own thread, only publishing
+// is done one point at a time
+class PythonApiGtw : public FeedSink {
 public:
-    PythonApiGtw();
-    ~PythonApiGtw();
+    // ring_capacity points of the feed are kept for the subscriptions
+    explicit PythonApiGtw(
+        uint32_t ring_capacity = BroadcastRing::kDefaultCapacity);
+    ~PythonApiGtw() override;
 
     PythonApiGtw(const PythonApiGtw&) = delete;
     PythonApiGtw& operator=(const PythonApiGtw&) = delete;
 
+    // before Start(), the feeds are numbered in the order they are added
+    void AddFeed(std::unique_ptr<FeedGateway> feed);
+    // before Start(), AcceptAll by default
+    void SetConflictRule(FeedConflictRule rule);
+
+    // starts every feed, or a SocketFeedGateway on 127.0.0.1:9000
+    // when none was added
     void Start();
 
-    std::shared_ptr<MarketDataSubscription> Subscribe();
+    // the subscription only receives the points of instrument_ids
+    // or every point when instrument_ids is empty
+    // on_push runs on the thread of the feed after each push
+    // the capacity of options is kept between 1 and half the ring
+    std::shared_ptr<MarketDataSubscription> Subscribe(
+        std::vector<std::string> instrument_ids = {},
+        std::function<void()> on_push = {},
+        const SubscriptionOptions& options = {});
+    // once it returns, on_push of the subscription is no longer called
     void Unsubscribe(const std::shared_ptr<MarketDataSubscription>& subscription);
 
+    // true while one of the feeds is
     bool IsRunning() const;
 
-private:
-    void SocketReaderThread();
+    // publishes point once for every subscription, and wakes the
+    // subscriptions of its instrument
+    // waits first for the BlockWithTimeout ones that are full, and
+    // closes the DisconnectSlowConsumer ones that lag too far
+    // any thread, the points are published one at a time
+    // the conflict rule only applies to the points of the feeds
     void Broadcast(const MarketDataPoint& point);
 
-    std::atomic<bool> should_stop_{false};
+    // the feed threads, Broadcast() once the conflict rule accepts point
+    // the sequence is only used by an ArbitratedFeedGateway
+    void OnPoint(std::size_t feed,
+                 const MarketDataPoint& point,
+                 uint64_t sequence) override;
+    // the subscriptions end when the last feed closes
+    void OnFeedClosed(std::size_t feed) override;
+
+    std::size_t FeedCount() const { return feeds_.size(); }
+    // points of feed published, and dropped by the conflict rule
+    uint64_t PublishedCount(std::size_t feed) const;
+    uint64_t ConflictCount(std::size_t feed) const;
+
+private:
+    struct Feed {
+        std::unique_ptr<FeedGateway> gateway;
+        std::atomic<uint64_t> published{0};
+        std::atomic<uint64_t> conflicts{0};
+    };
+
+    // must be called with publish_mutex_ held
+    bool Accept(std::size_t feed, const MarketDataPoint& point);
+    void Publish(const MarketDataPoint& point);
+    // must be called with subscribers_mutex_ held exclusively
+    void RebuildRoutes();
+    void CloseSubscribers();
+
+    // not modified once started
+    std::vector<std::unique_ptr<Feed>> feeds_;
+    FeedConflictRule conflict_rule_ = FeedConflictRule::AcceptAll;
+    std::atomic<std::size_t> open_feeds_{0};
     std::atomic<bool> running_{false};
-    std::thread socket_reader_thread_;
+
+    // held by the thread publishing a point, the rings have one writer
+    std::mutex publish_mutex_;
+    // by symbol id, under publish_mutex_
+    // FeedPriority, 1 + the feed the instrument is taken from, 0 for none
+    std::vector<uint32_t> owners_;
+    // NewestTimestamp, the last point published, in ns since the epoch
+    std::vector<int64_t> newest_;
+
+    // read by every subscription through its own cursor
+    // shared with them, a subscription may outlive the gateway
+    std::shared_ptr<BroadcastRing> points_;
 
     std::shared_mutex subscribers_mutex_;
     std::vector<std::shared_ptr<MarketDataSubscription>> subscribers_;
+
+    // built from subscribers_, indexed by the symbol_id of the points
+    // an instrument interned after the last rebuild has no subscriber
+    std::vector<std::vector<MarketDataSubscription*>> routes_;
+    std::vector<MarketDataSubscription*> all_instruments_subscribers_;
+    // with BlockWithTimeout, Broadcast only looks for room when there is one
+    std::size_t blocking_subscribers_ = 0;
+
+    // every point is also published there for the scripts of this host
+    // under publish_mutex_
+    MarketDataRingWriter ring_;
 };
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "feed_gateway.h"
+
+// replays a recording of the binary feed, the records of
+// feed_protocol.h one after the other, with or without the handshake
+// byte first, connectivity/feed/record_ticks.py writes one
+//
+// the file is memory mapped and decoded in place, so the feed costs
+// no read and no copy, and the points go through the same Broadcast
+// as the live ones with their recorded timestamps and sequences
+// the feed closes at the end of the file
+class ReplayFeedGateway : public FeedGateway {
+public:
+    // the pace of the recording
+    static constexpr double kRealTime = 1.0;
+    // no wait between the records
+    static constexpr double kAsFastAsPossible = 0.0;
+
+    // speed 10 replays the recording ten times faster than it was
+    // recorded, records with no timestamp are not waited for
+    explicit ReplayFeedGateway(std::string path, double speed = kRealTime);
+    ~ReplayFeedGateway() override;
+
+    ReplayFeedGateway(const ReplayFeedGateway&) = delete;
+    ReplayFeedGateway& operator=(const ReplayFeedGateway&) = delete;
+
+    std::string Name() const override;
+
+    void Start(FeedSink& sink, std::size_t feed) override;
+    // also interrupts the wait for the next record
+    void Stop() override;
+
+    bool IsRunning() const override;
+
+    // counters, any thread
+    uint64_t ReplayedCount() const { return replayed_.load(); }
+    // how far behind the pace of the recording a record was handed
+    // over at worst, 0 when replayed as fast as possible
+    std::chrono::nanoseconds MaxLateness() const {
+        return std::chrono::nanoseconds(max_lateness_ns_.load());
+    }
+
+private:
+    void ReplayThread();
+    // hands the records of the mapped file to the sink
+    void Replay(const char* data, std::size_t size);
+    // false when Stop() came first
+    bool WaitUntil(std::chrono::steady_clock::time_point due);
+
+    const std::string path_;
+    const double speed_;
+
+    FeedSink* sink_ = nullptr;
+    std::size_t feed_ = 0;
+
+    std::atomic<bool> should_stop_{false};
+    std::atomic<bool> running_{false};
+    std::thread replay_thread_;
+
+    std::mutex wait_mutex_;
+    std::condition_variable stopped_;
+
+    std::atomic<uint64_t> replayed_{0};
+    std::atomic<int64_t> max_lateness_ns_{0};
+};
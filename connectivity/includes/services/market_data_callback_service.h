@@ -0,0 +1,59 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <grpcpp/grpcpp.h>
+#include <grpcpp/support/server_callback.h>
+
+#include "messages/market_data_request.pb.h"
+#include "messages/price_update.pb.h"
+#include "processors/common/thread_pool.h"
+#include "python_api_gtw.h"
+#include "services/marketdata.grpc.pb.h"
+
+// MarketDataService on the gRPC callback api
+//
+// a stream holds no thread, the gateway wakes it with on_push and a
+// pump thread fills its next message and starts the write
+// a stream has at most one write in flight, the points published while
+// it is on the wire go out in the next one, so a slow client gets
+// bigger batches instead of an ever growing backlog
+// max_batch_delay_us and wait_spin_us of the request are not used,
+// the write in flight already does the batching
+class MarketDataCallbackService final
+    : public internal::MarketDataService::CallbackService {
+public:
+  static constexpr std::size_t kDefaultPumpThreads = 2;
+
+  // starts its own gateway
+  explicit MarketDataCallbackService(
+      std::size_t pump_threads = kDefaultPumpThreads);
+  // gateway is started by the caller, or fed with Broadcast
+  explicit MarketDataCallbackService(
+      std::shared_ptr<PythonApiGtw> gateway,
+      std::size_t pump_threads = kDefaultPumpThreads);
+
+  grpc::ServerWriteReactor<internal::PriceUpdate>* StreamPrices(
+      grpc::CallbackServerContext* context,
+      const internal::MarketDataRequest* request) override;
+
+  grpc::ServerWriteReactor<internal::PriceUpdateBatch>* StreamPriceBatches(
+      grpc::CallbackServerContext* context,
+      const internal::MarketDataRequest* request) override;
+
+  // streams not yet done
+  std::size_t OpenStreams() const { return open_streams_.load(); }
+
+private:
+  template <typename Message>
+  friend class PriceStreamReactor;
+
+  std::shared_ptr<PythonApiGtw> gateway_;
+
+  std::atomic<long long> call_count_{0};
+  std::atomic<std::size_t> open_streams_{0};
+
+  // the reactors submit their pump jobs there
+  ThreadPool pump_;
+};
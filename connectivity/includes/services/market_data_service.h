@@ -1,27 +1,155 @@
 #pragma once
 
+#include <chrono>
+#include <cstdint>
+#include <iostream>
 #include <memory>
 #include <grpcpp/grpcpp.h>
 #include <grpcpp/support/status.h>
 
-#include "google/protobuf/empty.pb.h"
 #include "services/marketdata.grpc.pb.h"
+#include "messages/market_data_request.pb.h"
 #include "messages/price_update.pb.h"
 #include "python_api_gtw.h"
 
+// how a stream waits for the points of its subscription
+struct StreamOptions {
+  // a batch waits that long after its first point for more
+  std::chrono::microseconds max_batch_delay{0};
+  // spin on an empty subscription before sleeping on the doorbell
+  std::chrono::microseconds spin{0};
+};
+
 class MarketDataService final : public internal::MarketDataService::Service {
 public:
+  // bounds the size of a message for a stream far behind the feed
+  static constexpr int kMaxBatchSize = 1024;
+  // a sleeping stream thread still checks this often
+  // whether its client left
+  static constexpr std::chrono::milliseconds kParkTimeout{10};
+
+  // starts its own gateway
   MarketDataService();
+  // gateway is started by the caller, or fed with Broadcast
+  explicit MarketDataService(std::shared_ptr<PythonApiGtw> gateway);
   ~MarketDataService() = default;
 
   grpc::Status StreamPrices(
       grpc::ServerContext* context,
-      const google::protobuf::Empty* request,
+      const internal::MarketDataRequest* request,
       grpc::ServerWriter<internal::PriceUpdate>* writer) override;
 
+  grpc::Status StreamPriceBatches(
+      grpc::ServerContext* context,
+      const internal::MarketDataRequest* request,
+      grpc::ServerWriter<internal::PriceUpdateBatch>* writer) override;
+
+  // write the points of subscription, one message each, until the
+  // client leaves or the subscription ends
+  // Writer is a grpc::ServerWriter, or anything with the same Write
+  template <typename Writer>
+  static void WritePoints(grpc::ServerContext* context,
+                          MarketDataSubscription& subscription,
+                          const StreamOptions& options,
+                          Writer* writer);
+
+  // write the points of subscription, everything pending at once
+  template <typename Writer>
+  static void WriteBatches(grpc::ServerContext* context,
+                           MarketDataSubscription& subscription,
+                           const StreamOptions& options,
+                           Writer* writer);
+
+  static StreamOptions OptionsFrom(const internal::MarketDataRequest& request);
+
+  static SubscriptionOptions SubscriptionOptionsFrom(
+      const internal::MarketDataRequest& request);
+
+  // for a stream the DisconnectSlowConsumer policy closed
+  static grpc::Status SlowConsumerStatus();
+
+  static void FillPriceUpdate(const MarketDataPoint& data_point,
+                              internal::PriceUpdate& price_update);
+
 private:
+  std::shared_ptr<MarketDataSubscription> Subscribe(
+      const char* rpc_name, const internal::MarketDataRequest& request);
+
   std::shared_ptr<PythonApiGtw> gateway_;
 
   long long call_count_ = 0;
   long long failed_call_count_ = 0;
 };
+
+template <typename Writer>
+void MarketDataService::WritePoints(grpc::ServerContext* context,
+                                    MarketDataSubscription& subscription,
+                                    const StreamOptions& options,
+                                    Writer* writer) {
+  internal::PriceUpdate price_update;
+
+  while (!context->IsCancelled() && subscription.active.load()) {
+    MarketDataPoint data_point;
+    const uint64_t rings = subscription.doorbell.Rings();
+
+    if (!subscription.Poll(data_point)) {
+      subscription.doorbell.Wait(rings, options.spin, kParkTimeout);
+      continue;
+    }
+
+    FillPriceUpdate(data_point, price_update);
+
+    if (!writer->Write(price_update)) {
+      std::cerr << "Failed to write to gRPC stream (client disconnected)"
+                << std::endl;
+      break;
+    }
+  }
+}
+
+template <typename Writer>
+void MarketDataService::WriteBatches(grpc::ServerContext* context,
+                                     MarketDataSubscription& subscription,
+                                     const StreamOptions& options,
+                                     Writer* writer) {
+  // cleared updates stay allocated, later batches reuse them
+  internal::PriceUpdateBatch batch;
+
+  while (!context->IsCancelled() && subscription.active.load()) {
+    MarketDataPoint data_point;
+    uint64_t rings = subscription.doorbell.Rings();
+
+    if (!subscription.Poll(data_point)) {
+      subscription.doorbell.Wait(rings, options.spin, kParkTimeout);
+      continue;
+    }
+
+    batch.clear_updates();
+    FillPriceUpdate(data_point, *batch.add_updates());
+
+    const auto deadline =
+        std::chrono::steady_clock::now() + options.max_batch_delay;
+
+    while (batch.updates_size() < kMaxBatchSize) {
+      rings = subscription.doorbell.Rings();
+
+      if (subscription.Poll(data_point)) {
+        FillPriceUpdate(data_point, *batch.add_updates());
+        continue;
+      }
+
+      const auto now = std::chrono::steady_clock::now();
+      if (now >= deadline || !subscription.active.load()) {
+        break;
+      }
+
+      subscription.doorbell.Wait(rings, options.spin, deadline - now);
+    }
+
+    if (!writer->Write(batch)) {
+      std::cerr << "Failed to write to gRPC stream (client disconnected)"
+                << std::endl;
+      break;
+    }
+  }
+}
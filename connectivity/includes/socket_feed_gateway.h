@@ -0,0 +1,71 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "feed_buffer.h"
+#include "feed_gateway.h"
+
+// a python feed over TCP, json lines or binary records, see feed_protocol.h
+class SocketFeedGateway : public FeedGateway {
+public:
+    static constexpr const char* kDefaultHost = "127.0.0.1";
+    static constexpr uint16_t kDefaultPort = 9000;
+
+    // with a reconnect_delay, a connection which fails or drops is
+    // tried again after it, and the feed only closes with Stop()
+    explicit SocketFeedGateway(
+        std::string host = kDefaultHost,
+        uint16_t port = kDefaultPort,
+        std::chrono::milliseconds reconnect_delay = std::chrono::milliseconds(0));
+    ~SocketFeedGateway() override;
+
+    SocketFeedGateway(const SocketFeedGateway&) = delete;
+    SocketFeedGateway& operator=(const SocketFeedGateway&) = delete;
+
+    std::string Name() const override;
+
+    void Start(FeedSink& sink, std::size_t feed) override;
+    // shuts the connection down, so a feed with nothing to send
+    // does not hold the join
+    void Stop() override;
+
+    bool IsRunning() const override;
+
+    // connections which succeeded, any thread
+    uint64_t ConnectCount() const { return connects_.load(); }
+
+private:
+    void SocketReaderThread();
+    // until the connection fails, drops or Stop()
+    void ReadConnection();
+    // hand the complete records or lines of feed to the sink and
+    // consume them, a partial one waits for the next read
+    // false once the binary framing is lost
+    bool ConsumeBinary(FeedBuffer& feed);
+    void ConsumeJson(FeedBuffer& feed);
+
+    const std::string host_;
+    const uint16_t port_;
+    const std::chrono::milliseconds reconnect_delay_;
+
+    FeedSink* sink_ = nullptr;
+    std::size_t feed_ = 0;
+
+    std::atomic<bool> should_stop_{false};
+    std::atomic<bool> running_{false};
+    std::thread socket_reader_thread_;
+    std::atomic<uint64_t> connects_{0};
+
+    // the connected socket, -1 otherwise, for Stop()
+    std::mutex socket_mutex_;
+    int socket_fd_ = -1;
+    // Stop() wakes the wait before a reconnect
+    std::condition_variable stopped_;
+};
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+// process-wide dense ids for the instrument names of the feed
+//
+// a name is interned once at ingress, then the points only carry its id
+// ids start at 1 and are never reused, 0 is the empty name
+// Name() takes no lock, the names are stored in chunks that never move,
+// Intern() takes a shared lock for a known name, exclusive for a new one
+class SymbolTable {
+public:
+    // the names fit the instrument_id of the shared memory ring record
+    static constexpr std::size_t kMaxNameLength = 31;
+    static constexpr uint32_t kEmptyId = 0;
+
+    static SymbolTable& GetInstance() {
+        static SymbolTable instance;
+        return instance;
+    }
+
+    SymbolTable(const SymbolTable&) = delete;
+    SymbolTable& operator=(const SymbolTable&) = delete;
+    SymbolTable(SymbolTable&&) = delete;
+    SymbolTable& operator=(SymbolTable&&) = delete;
+
+    // name is truncated to kMaxNameLength
+    // returns kEmptyId once the table is full
+    uint32_t Intern(std::string_view name);
+
+    // empty for an id not returned by Intern()
+    std::string_view Name(uint32_t id) const;
+
+    // ids in use, including kEmptyId
+    std::size_t Size() const;
+
+private:
+    static constexpr std::size_t kChunkBits = 10;
+    static constexpr std::size_t kChunkSize = std::size_t{1} << kChunkBits;
+    static constexpr std::size_t kMaxChunks = 1024;
+
+    struct Chunk {
+        std::array<std::string, kChunkSize> names;
+    };
+
+    SymbolTable();
+    ~SymbolTable();
+
+    mutable std::shared_mutex mutex_;
+    // the keys point into the chunks
+    std::unordered_map<std::string_view, uint32_t> ids_;
+
+    // published with release once the name of the id is written
+    std::atomic<uint32_t> size_{0};
+    std::array<std::atomic<Chunk*>, kMaxChunks> chunks_{};
+};
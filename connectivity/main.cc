@@ -1,23 +1,162 @@
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
 #include <memory>
+#include <string>
+#include <utility>
+#include <vector>
 #include <grpcpp/grpcpp.h>
 
+#include "arbitrated_feed_gateway.h"
+#include "python_api_gtw.h"
+#include "replay_feed_gateway.h"
+#include "services/market_data_callback_service.h"
 #include "services/market_data_service.h"
+#include "socket_feed_gateway.h"
 
-void RunServer() {
+namespace {
+
+// a line of an A/B feed comes back on its own, the other one carries
+// the feed meanwhile
+constexpr std::chrono::milliseconds kLineReconnectDelay{1000};
+
+void Usage(const char *program) {
+  std::cerr << "usage: " << program
+            << " [--sync] [--feed host:port[,host:port]]..."
+               " [--feed-conflict accept-all|priority|newest]"
+               " [--replay file]... [--replay-speed n|max]"
+            << std::endl;
+}
+
+bool ParseConflictRule(const std::string &name, FeedConflictRule &rule) {
+  if (name == "accept-all") {
+    rule = FeedConflictRule::AcceptAll;
+  } else if (name == "priority") {
+    rule = FeedConflictRule::FeedPriority;
+  } else if (name == "newest") {
+    rule = FeedConflictRule::NewestTimestamp;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+std::unique_ptr<SocketFeedGateway>
+ParseSocketFeed(const std::string &address,
+                std::chrono::milliseconds reconnect_delay) {
+  const auto colon = address.rfind(':');
+  if (colon == std::string::npos || colon == 0) {
+    return nullptr;
+  }
+  const int port = std::atoi(address.c_str() + colon + 1);
+  if (port <= 0 || port > 65535) {
+    return nullptr;
+  }
+  return std::make_unique<SocketFeedGateway>(address.substr(0, colon),
+                                             static_cast<uint16_t>(port),
+                                             reconnect_delay);
+}
+
+// 1 for the pace of the recording, n times faster, or max
+bool ParseReplaySpeed(const std::string &text, double &speed) {
+  if (text == "max") {
+    speed = ReplayFeedGateway::kAsFastAsPossible;
+    return true;
+  }
+  char *end = nullptr;
+  speed = std::strtod(text.c_str(), &end);
+  return end != text.c_str() && *end == '\0' && speed > 0;
+}
+
+// host:port, or the A and B lines of one feed, host:port,host:port
+bool AddSocketFeed(const std::string &addresses, PythonApiGtw &gateway) {
+  const auto comma = addresses.find(',');
+  if (comma == std::string::npos) {
+    auto feed = ParseSocketFeed(addresses, std::chrono::milliseconds(0));
+    if (!feed) {
+      return false;
+    }
+    gateway.AddFeed(std::move(feed));
+    return true;
+  }
+
+  auto line_a =
+      ParseSocketFeed(addresses.substr(0, comma), kLineReconnectDelay);
+  auto line_b =
+      ParseSocketFeed(addresses.substr(comma + 1), kLineReconnectDelay);
+  if (!line_a || !line_b) {
+    return false;
+  }
+  gateway.AddFeed(std::make_unique<ArbitratedFeedGateway>(std::move(line_a),
+                                                          std::move(line_b)));
+  return true;
+}
+
+} // namespace
+
+// the callback service drives every stream from a few threads
+// --sync serves with one thread per stream instead
+void RunServer(bool sync, std::shared_ptr<PythonApiGtw> gateway) {
   const std::string server_address("0.0.0.0:50052");
-  MarketDataService market_data_service;
+  std::unique_ptr<grpc::Service> market_data_service;
+  if (sync) {
+    market_data_service = std::make_unique<MarketDataService>(gateway);
+  } else {
+    market_data_service = std::make_unique<MarketDataCallbackService>(gateway);
+  }
 
   grpc::ServerBuilder builder;
   builder.AddListeningPort(server_address, grpc::InsecureServerCredentials());
-  builder.RegisterService(&market_data_service);
+  builder.RegisterService(market_data_service.get());
 
   std::unique_ptr<grpc::Server> server(builder.BuildAndStart());
   std::cout << "Market data server listening on " << server_address << std::endl;
   server->Wait();
 }
 
-int main() {
-  RunServer();
+// every --feed is read by its own thread, the python feed on
+// 127.0.0.1:9000 when there is none
+// a feed given with two addresses is read on both, see
+// arbitrated_feed_gateway.h
+// a --replay file is a feed too, with --replay-speed for every one
+int main(int argc, char **argv) {
+  bool sync = false;
+  auto gateway = std::make_shared<PythonApiGtw>();
+  std::vector<std::string> replays;
+  double replay_speed = ReplayFeedGateway::kRealTime;
+
+  for (int i = 1; i < argc; ++i) {
+    if (std::strcmp(argv[i], "--sync") == 0) {
+      sync = true;
+    } else if (std::strcmp(argv[i], "--feed") == 0 && i + 1 < argc &&
+               AddSocketFeed(argv[i + 1], *gateway)) {
+      ++i;
+    } else if (std::strcmp(argv[i], "--feed-conflict") == 0 && i + 1 < argc) {
+      FeedConflictRule rule;
+      if (!ParseConflictRule(argv[++i], rule)) {
+        Usage(argv[0]);
+        return 1;
+      }
+      gateway->SetConflictRule(rule);
+    } else if (std::strcmp(argv[i], "--replay") == 0 && i + 1 < argc) {
+      replays.push_back(argv[++i]);
+    } else if (std::strcmp(argv[i], "--replay-speed") == 0 && i + 1 < argc) {
+      if (!ParseReplaySpeed(argv[++i], replay_speed)) {
+        Usage(argv[0]);
+        return 1;
+      }
+    } else {
+      Usage(argv[0]);
+      return 1;
+    }
+  }
+
+  for (const auto &path : replays) {
+    gateway->AddFeed(std::make_unique<ReplayFeedGateway>(path, replay_speed));
+  }
+
+  gateway->Start();
+  RunServer(sync, gateway);
   return 0;
-}
\ No newline at end of file
+}
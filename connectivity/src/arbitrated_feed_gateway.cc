@@ -0,0 +1,184 @@
+#include "arbitrated_feed_gateway.h"
+
+#include <algorithm>
+#include <iostream>
+#include <utility>
+
+namespace {
+
+const char kLineNames[] = "AB";
+
+} // namespace
+
+ArbitratedFeedGateway::ArbitratedFeedGateway(
+    std::unique_ptr<FeedGateway> line_a, std::unique_ptr<FeedGateway> line_b,
+    std::chrono::milliseconds stall_timeout)
+    : lines_{std::move(line_a), std::move(line_b)},
+      stall_timeout_(stall_timeout) {}
+
+ArbitratedFeedGateway::~ArbitratedFeedGateway() { Stop(); }
+
+std::string ArbitratedFeedGateway::Name() const {
+  return lines_[kLineA]->Name() + " | " + lines_[kLineB]->Name();
+}
+
+void ArbitratedFeedGateway::Start(FeedSink &sink, std::size_t feed) {
+  if (running_.load()) {
+    return;
+  }
+
+  sink_ = &sink;
+  feed_ = feed;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    window_start_ = 0;
+    taken_.reset();
+    numbering_ = 0;
+    line_numbering_ = {};
+    line_sequence_ = {};
+    new_session_ = {};
+    last_arrival_ = {};
+    closed_ = {};
+  }
+  active_.store(kLineA);
+  running_.store(true);
+
+  lines_[kLineA]->Start(*this, kLineA);
+  lines_[kLineB]->Start(*this, kLineB);
+}
+
+void ArbitratedFeedGateway::Stop() {
+  lines_[kLineA]->Stop();
+  lines_[kLineB]->Stop();
+}
+
+bool ArbitratedFeedGateway::IsRunning() const { return running_.load(); }
+
+bool ArbitratedFeedGateway::Stalled(std::size_t line,
+                                    Clock::time_point now) const {
+  return closed_[line] || now - last_arrival_[line] >= stall_timeout_;
+}
+
+bool ArbitratedFeedGateway::FollowsNumbering(std::size_t line,
+                                             uint64_t sequence) {
+  const uint64_t last = line_sequence_[line];
+  const bool new_session = new_session_[line];
+  line_sequence_[line] = sequence;
+  new_session_[line] = false;
+
+  if (last != kNoSequence && sequence <= last) {
+    // the first line to go back starts the new numbering
+    if (line_numbering_[line] == numbering_) {
+      ++numbering_;
+      window_start_ = 0;
+      taken_.reset();
+      std::cout << "Feed " << Name() << " restarted at sequence " << sequence
+                << " on line " << kLineNames[line] << std::endl;
+    }
+    line_numbering_[line] = numbering_;
+    return true;
+  }
+
+  if (line_numbering_[line] != numbering_) {
+    // still in the session it had before the restart
+    if (!new_session) {
+      return false;
+    }
+    line_numbering_[line] = numbering_;
+  }
+  return true;
+}
+
+bool ArbitratedFeedGateway::Take(uint64_t sequence) {
+  if (window_start_ == 0) {
+    window_start_ = sequence;
+  }
+  if (sequence < window_start_) {
+    return false;
+  }
+
+  if (sequence - window_start_ >= kSequenceWindow) {
+    // the window moves up to sequence, what it leaves never arrived
+    const uint64_t start = sequence - kSequenceWindow + 1;
+    const uint64_t left = std::min(start - window_start_, kSequenceWindow);
+    // past the whole window, the sequences in between never came in
+    uint64_t gaps = start - window_start_ - left;
+
+    for (uint64_t i = 0; i < left; ++i) {
+      const std::size_t bit = (window_start_ + i) % kSequenceWindow;
+      if (!taken_[bit]) {
+        ++gaps;
+      }
+      taken_[bit] = false;
+    }
+    window_start_ = start;
+    gaps_.fetch_add(gaps, std::memory_order_relaxed);
+  }
+
+  const std::size_t bit = sequence % kSequenceWindow;
+  if (taken_[bit]) {
+    return false;
+  }
+  taken_[bit] = true;
+  return true;
+}
+
+void ArbitratedFeedGateway::OnPoint(std::size_t line,
+                                    const MarketDataPoint &point,
+                                    uint64_t sequence) {
+  const Clock::time_point now = Clock::now();
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  const std::size_t active = active_.load(std::memory_order_relaxed);
+  // checked before this point counts as an arrival of line
+  const bool active_stalled = line != active && Stalled(active, now);
+  last_arrival_[line] = now;
+
+  if (sequence != kNoSequence) {
+    if (!FollowsNumbering(line, sequence) || !Take(sequence)) {
+      duplicates_[line].fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
+  } else if (line != active && !active_stalled) {
+    // the standby copy
+    duplicates_[line].fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+
+  // a numbered point of the other line only wins a race, the active
+  // line changes once it stalled
+  if (active_stalled) {
+    active_.store(line, std::memory_order_relaxed);
+    // the first point of the feed is no failover
+    if (last_arrival_[active] != Clock::time_point{} || closed_[active]) {
+      failovers_.fetch_add(1, std::memory_order_relaxed);
+      std::cout << "Feed " << Name() << " fails over to line "
+                << kLineNames[line] << std::endl;
+    }
+  }
+
+  won_[line].fetch_add(1, std::memory_order_relaxed);
+  sink_->OnPoint(feed_, point, sequence);
+}
+
+void ArbitratedFeedGateway::OnFeedSession(std::size_t line) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  new_session_[line] = true;
+}
+
+void ArbitratedFeedGateway::OnFeedClosed(std::size_t line) {
+  bool both_closed;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    closed_[line] = true;
+    both_closed = closed_[kLineA] && closed_[kLineB];
+  }
+
+  std::cout << "Line " << kLineNames[line] << " of feed " << Name()
+            << " closed" << std::endl;
+
+  if (both_closed) {
+    running_.store(false);
+    sink_->OnFeedClosed(feed_);
+  }
+}
@@ -0,0 +1,108 @@
+#include "broadcast_ring.h"
+
+#include <cstring>
+#include <utility>
+
+namespace {
+
+uint64_t RoundUp(uint32_t capacity) {
+    uint64_t rounded = 1;
+    while (rounded < capacity) {
+        rounded *= 2;
+    }
+    return rounded;
+}
+
+} // namespace
+
+BroadcastRing::BroadcastRing(uint32_t capacity)
+    : mask_(RoundUp(capacity) - 1), slots_(new Slot[mask_ + 1]) {}
+
+void BroadcastRing::Publish(const MarketDataPoint& point) {
+    const uint64_t next = published_.load(std::memory_order_relaxed);
+    Slot& slot = slots_[next & mask_];
+
+    slot.sequence.store(2 * next + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    std::memcpy(&slot.point, &point, sizeof(MarketDataPoint));
+
+    slot.sequence.store(2 * next + 2, std::memory_order_release);
+    published_.store(next + 1, std::memory_order_release);
+}
+
+uint64_t BroadcastRing::Published() const {
+    return published_.load(std::memory_order_acquire);
+}
+
+BroadcastRing::ReadStatus BroadcastRing::Read(uint64_t sequence,
+                                              MarketDataPoint& point) const {
+    const Slot& slot = slots_[sequence & mask_];
+    const uint64_t published = 2 * sequence + 2;
+
+    const uint64_t before = slot.sequence.load(std::memory_order_acquire);
+    if (before < published) {
+        // not written yet (or being written)
+        return ReadStatus::NotPublished;
+    }
+    if (before > published) {
+        return ReadStatus::Overwritten;
+    }
+
+    std::memcpy(&point, &slot.point, sizeof(MarketDataPoint));
+    std::atomic_thread_fence(std::memory_order_acquire);
+
+    // rewritten by the writer during the copy
+    if (slot.sequence.load(std::memory_order_relaxed) != before) {
+        return ReadStatus::Overwritten;
+    }
+    return ReadStatus::Ok;
+}
+
+BroadcastReader::BroadcastReader(std::shared_ptr<const BroadcastRing> ring)
+    : ring_(std::move(ring)), next_(ring_->Published()) {}
+
+bool BroadcastReader::Poll(MarketDataPoint& point) {
+    while (true) {
+        const uint64_t next = next_.load(std::memory_order_relaxed);
+
+        switch (ring_->Read(next, point)) {
+        case BroadcastRing::ReadStatus::Ok:
+            next_.store(next + 1, std::memory_order_release);
+            return true;
+        case BroadcastRing::ReadStatus::Overwritten:
+            Resync();
+            break;
+        case BroadcastRing::ReadStatus::NotPublished:
+            return false;
+        }
+    }
+}
+
+void BroadcastReader::SkipTo(uint64_t sequence) {
+    if (sequence > next_.load(std::memory_order_relaxed)) {
+        next_.store(sequence, std::memory_order_release);
+    }
+}
+
+uint64_t BroadcastReader::Lag() const {
+    // the cursor first, so the difference never goes below 0
+    const uint64_t next = Next();
+    return ring_->Published() - next;
+}
+
+void BroadcastReader::Resync() {
+    const uint64_t next = next_.load(std::memory_order_relaxed);
+    const uint64_t published = ring_->Published();
+    // the slot the writer fills next still holds the oldest point, a
+    // reader lapped again while it reads resyncs again
+    const uint64_t oldest = published > ring_->Capacity()
+                                ? published - ring_->Capacity()
+                                : 0;
+    if (oldest <= next) {
+        // overwritten during the copy, the slot is read again
+        return;
+    }
+    lost_.fetch_add(oldest - next, std::memory_order_relaxed);
+    next_.store(oldest, std::memory_order_release);
+}
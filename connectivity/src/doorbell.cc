@@ -0,0 +1,45 @@
+#include "doorbell.h"
+
+#include <algorithm>
+#include <thread>
+
+void Doorbell::Ring() {
+  rings_.fetch_add(1);
+
+  // pairs with the store of parked_ in Wait, either the consumer sees
+  // the new count or we see it parked
+  if (parked_.load()) {
+    // taking the mutex orders the notify after the consumer started
+    // waiting, it checks the count with the mutex held
+    std::lock_guard<std::mutex> lock(mutex_);
+    cv_.notify_one();
+  }
+}
+
+uint64_t Doorbell::Rings() const { return rings_.load(); }
+
+bool Doorbell::Wait(uint64_t seen, std::chrono::nanoseconds spin,
+                    std::chrono::nanoseconds timeout) {
+  const auto start = std::chrono::steady_clock::now();
+  const auto spin_end = start + std::min(spin, timeout);
+
+  while (rings_.load(std::memory_order_acquire) == seen) {
+    if (std::chrono::steady_clock::now() >= spin_end) {
+      break;
+    }
+    std::this_thread::yield();
+  }
+
+  if (rings_.load() != seen) {
+    return true;
+  }
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  parked_.store(true);
+  const bool rung = cv_.wait_until(lock, start + timeout, [this, seen] {
+    return rings_.load() != seen;
+  });
+  parked_.store(false);
+
+  return rung;
+}
@@ -0,0 +1,72 @@
+#include "feed_buffer.h"
+
+#include <cstring>
+
+FeedBuffer::FeedBuffer(std::size_t capacity)
+    : data_(new char[capacity]), capacity_(capacity) {}
+
+char *FeedBuffer::WriteData() {
+  if (read_ > 0 && capacity_ - write_ < capacity_ / 2) {
+    Compact();
+  }
+  return data_.get() + write_;
+}
+
+std::size_t FeedBuffer::WriteSpace() const { return capacity_ - write_; }
+
+void FeedBuffer::Commit(std::size_t n) { write_ += n; }
+
+std::string_view FeedBuffer::Data() const {
+  return std::string_view(data_.get() + read_, write_ - read_);
+}
+
+void FeedBuffer::Consume(std::size_t n) {
+  read_ += n;
+  if (read_ == write_) {
+    // nothing to move
+    read_ = 0;
+    write_ = 0;
+  }
+}
+
+bool FeedBuffer::NextLine(std::string_view &line) {
+  while (read_ < write_) {
+    const char *begin = data_.get() + read_;
+    const auto *newline =
+        static_cast<const char *>(std::memchr(begin, '\n', write_ - read_));
+
+    if (newline == nullptr) {
+      // full and still no end, this line cannot fit
+      if (read_ == 0 && write_ == capacity_) {
+        if (!dropping_line_) {
+          ++dropped_lines_;
+        }
+        dropping_line_ = true;
+        Consume(write_ - read_);
+      }
+      return false;
+    }
+
+    const std::size_t length = static_cast<std::size_t>(newline - begin);
+    Consume(length + 1);
+
+    if (dropping_line_) {
+      // the end of the line too long
+      dropping_line_ = false;
+      continue;
+    }
+
+    // Consume may have rewound read_, the bytes are still there
+    line = std::string_view(begin, length);
+    return true;
+  }
+
+  return false;
+}
+
+void FeedBuffer::Compact() {
+  const std::size_t unread = write_ - read_;
+  std::memmove(data_.get(), data_.get() + read_, unread);
+  read_ = 0;
+  write_ = unread;
+}
@@ -0,0 +1,109 @@
+#include "feed_protocol.h"
+
+#include <chrono>
+#include <cstring>
+#include <nlohmann/json.hpp>
+#include <string>
+
+#include "json_tick_decoder.h"
+
+using json = nlohmann::json;
+
+// the records are copied as is, the feed runs on the same host
+static_assert(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__,
+              "binary feed records are little endian");
+
+namespace {
+
+template <typename T> T Load(const char *data) {
+  T value;
+  std::memcpy(&value, data, sizeof(T));
+  return value;
+}
+
+} // namespace
+
+DecodeStatus DecodeBinaryRecord(const char *data, std::size_t size,
+                                MarketDataPoint &point,
+                                std::size_t &consumed) {
+  uint64_t sequence;
+  return DecodeBinaryRecord(data, size, point, consumed, sequence);
+}
+
+DecodeStatus DecodeBinaryRecord(const char *data, std::size_t size,
+                                MarketDataPoint &point, std::size_t &consumed,
+                                uint64_t &sequence) {
+  if (size < sizeof(uint16_t)) {
+    return DecodeStatus::NeedMore;
+  }
+
+  const std::size_t length = Load<uint16_t>(data);
+  if (length < kBinaryRecordHeaderSize || length > kBinaryRecordMaxSize) {
+    return DecodeStatus::Invalid;
+  }
+  if (size < length) {
+    return DecodeStatus::NeedMore;
+  }
+
+  const std::size_t symbol_length = static_cast<uint8_t>(data[2]);
+  if (kBinaryRecordHeaderSize + symbol_length > length) {
+    return DecodeStatus::Invalid;
+  }
+
+  point.price = Load<double>(data + 4);
+  point.quantity = Load<int64_t>(data + 12);
+
+  const int64_t timestamp_ns = Load<int64_t>(data + 20);
+  if (timestamp_ns == 0) {
+    StampNow(point);
+  } else {
+    point.timestamp_seconds = timestamp_ns / 1000000000;
+    point.timestamp_nanos = static_cast<int32_t>(timestamp_ns % 1000000000);
+  }
+
+  point.set_instrument_id(
+      std::string_view(data + kBinaryRecordHeaderSize, symbol_length));
+
+  const std::size_t symbol_end = kBinaryRecordHeaderSize + symbol_length;
+  sequence = length >= symbol_end + sizeof(uint64_t)
+                 ? Load<uint64_t>(data + symbol_end)
+                 : kNoSequence;
+
+  consumed = length;
+  return DecodeStatus::Ok;
+}
+
+void ParseJsonTick(std::string_view line, MarketDataPoint &point) {
+  if (!DecodeJsonTick(line, point)) {
+    ParseJsonTickDom(line, point);
+  }
+
+  StampNow(point);
+}
+
+void ParseJsonTickDom(std::string_view line, MarketDataPoint &point) {
+  json json_data = json::parse(line);
+
+  if (json_data.contains("price")) {
+    point.price = json_data["price"].get<double>();
+  }
+  if (json_data.contains("quantity")) {
+    point.quantity = json_data["quantity"].get<int64_t>();
+  }
+  if (json_data.contains("instrument_id")) {
+    point.set_instrument_id(json_data["instrument_id"].get<std::string>());
+  }
+}
+
+void StampNow(MarketDataPoint &point) {
+  auto now = std::chrono::system_clock::now();
+  auto duration = now.time_since_epoch();
+  auto seconds = std::chrono::duration_cast<std::chrono::seconds>(duration);
+  auto nanos_total =
+      std::chrono::duration_cast<std::chrono::nanoseconds>(duration);
+  auto nanos_remainder =
+      nanos_total - std::chrono::duration_cast<std::chrono::nanoseconds>(seconds);
+
+  point.timestamp_seconds = seconds.count();
+  point.timestamp_nanos = static_cast<int32_t>(nanos_remainder.count());
+}
@@ -0,0 +1,191 @@
+#include "json_tick_decoder.h"
+
+#include <charconv>
+#include <cstdint>
+#include <string_view>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+const char *SkipWhitespace(const char *p, const char *end) {
+  while (p < end && (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n')) {
+    ++p;
+  }
+  return p;
+}
+
+// the first '"' or '\\' from p, end when there is none
+const char *FindQuoteOrBackslash(const char *p, const char *end) {
+#if defined(__SSE2__)
+  const __m128i quote = _mm_set1_epi8('"');
+  const __m128i backslash = _mm_set1_epi8('\\');
+
+  for (; p + 16 <= end; p += 16) {
+    const __m128i chunk =
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+    const int mask =
+        _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(chunk, quote),
+                                       _mm_cmpeq_epi8(chunk, backslash)));
+    if (mask != 0) {
+      return p + __builtin_ctz(static_cast<unsigned>(mask));
+    }
+  }
+#endif
+
+  for (; p < end; ++p) {
+    if (*p == '"' || *p == '\\') {
+      return p;
+    }
+  }
+  return end;
+}
+
+// p is past the opening quote, the string ends before the returned
+// pointer's quote, nullptr for an escape or no closing quote
+const char *ScanString(const char *p, const char *end) {
+  const char *found = FindQuoteOrBackslash(p, end);
+  if (found == end || *found == '\\') {
+    return nullptr;
+  }
+  return found;
+}
+
+// json only allows these in a number, from_chars would also take
+// inf or nan
+bool IsNumberChar(char c) {
+  return (c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.' ||
+         c == 'e' || c == 'E';
+}
+
+const char *NumberEnd(const char *p, const char *end) {
+  while (p < end && IsNumberChar(*p)) {
+    ++p;
+  }
+  return p;
+}
+
+enum class Key { Price, Quantity, InstrumentId, Unknown };
+
+Key ToKey(std::string_view name) {
+  if (name == "price") {
+    return Key::Price;
+  }
+  if (name == "quantity") {
+    return Key::Quantity;
+  }
+  if (name == "instrument_id") {
+    return Key::InstrumentId;
+  }
+  return Key::Unknown;
+}
+
+} // namespace
+
+bool DecodeJsonTick(std::string_view line, MarketDataPoint &point) {
+  const char *p = line.data();
+  const char *const end = line.data() + line.size();
+
+  // written to point only once the whole line is read, so a line that
+  // goes to nlohmann interns nothing here
+  MarketDataPoint decoded = point;
+  std::string_view instrument_id;
+  bool has_instrument_id = false;
+
+  p = SkipWhitespace(p, end);
+  if (p == end || *p != '{') {
+    return false;
+  }
+  p = SkipWhitespace(p + 1, end);
+
+  if (p < end && *p == '}') {
+    p = SkipWhitespace(p + 1, end);
+    if (p != end) {
+      return false;
+    }
+    point = decoded;
+    return true;
+  }
+
+  while (true) {
+    if (p == end || *p != '"') {
+      return false;
+    }
+    const char *key_end = ScanString(p + 1, end);
+    if (key_end == nullptr) {
+      return false;
+    }
+    const Key key = ToKey(std::string_view(p + 1, key_end - p - 1));
+
+    p = SkipWhitespace(key_end + 1, end);
+    if (p == end || *p != ':') {
+      return false;
+    }
+    p = SkipWhitespace(p + 1, end);
+    if (p == end) {
+      return false;
+    }
+
+    switch (key) {
+    case Key::Price: {
+      const char *number_end = NumberEnd(p, end);
+      const auto result = std::from_chars(p, number_end, decoded.price);
+      if (result.ec != std::errc() || result.ptr != number_end) {
+        return false;
+      }
+      p = number_end;
+      break;
+    }
+    case Key::Quantity: {
+      const char *number_end = NumberEnd(p, end);
+      // 10.0 or 1e3 go to nlohmann, which converts them
+      const auto result = std::from_chars(p, number_end, decoded.quantity);
+      if (result.ec != std::errc() || result.ptr != number_end) {
+        return false;
+      }
+      p = number_end;
+      break;
+    }
+    case Key::InstrumentId: {
+      if (*p != '"') {
+        return false;
+      }
+      const char *value_end = ScanString(p + 1, end);
+      if (value_end == nullptr) {
+        return false;
+      }
+      instrument_id = std::string_view(p + 1, value_end - p - 1);
+      has_instrument_id = true;
+      p = value_end + 1;
+      break;
+    }
+    case Key::Unknown:
+      return false;
+    }
+
+    p = SkipWhitespace(p, end);
+    if (p == end) {
+      return false;
+    }
+    if (*p == ',') {
+      p = SkipWhitespace(p + 1, end);
+      continue;
+    }
+    if (*p == '}') {
+      break;
+    }
+    return false;
+  }
+
+  if (SkipWhitespace(p + 1, end) != end) {
+    return false;
+  }
+
+  if (has_instrument_id) {
+    decoded.set_instrument_id(instrument_id);
+  }
+  point = decoded;
+  return true;
+}
@@ -0,0 +1,229 @@
+#include "market_data_subscription.h"
+
+#include <utility>
+
+#include "symbol_table.h"
+
+MarketDataSubscription::MarketDataSubscription(
+    std::shared_ptr<const BroadcastRing> ring,
+    const SubscriptionOptions& options)
+    : reader(std::move(ring)), options(options) {}
+
+void MarketDataSubscription::SetInstruments(std::vector<std::string> ids) {
+    instrument_ids = std::move(ids);
+    symbol_ids.clear();
+    wanted_.clear();
+
+    for (const auto& instrument_id : instrument_ids) {
+        const uint32_t symbol_id =
+            SymbolTable::GetInstance().Intern(instrument_id);
+        symbol_ids.push_back(symbol_id);
+        if (symbol_id >= wanted_.size()) {
+            wanted_.resize(symbol_id + 1);
+        }
+        wanted_[symbol_id] = true;
+    }
+
+    if (!instrument_ids.empty()) {
+        // room for the backlog the policy keeps while the newest points
+        // are pushed, as the gateway keeps the ring twice as large
+        uint64_t size = 1;
+        while (size < 2 * options.capacity) {
+            size *= 2;
+        }
+        pending_.reset(new PendingPoint[size]);
+        pending_mask_ = size - 1;
+    }
+}
+
+void MarketDataSubscription::Push(uint64_t sequence) {
+    const uint64_t position = pushed_.load(std::memory_order_relaxed);
+    PendingPoint& pending = pending_[position & pending_mask_];
+
+    pending.position.store(2 * position + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    pending.sequence.store(sequence, std::memory_order_relaxed);
+
+    pending.position.store(2 * position + 2, std::memory_order_release);
+    pushed_.store(position + 1, std::memory_order_release);
+}
+
+uint64_t MarketDataSubscription::Lag() const {
+    // the cursor first, so the difference never goes below 0
+    const uint64_t next = Next();
+    return End() - next;
+}
+
+bool MarketDataSubscription::Poll(MarketDataPoint& point) {
+    while (true) {
+        if (conflated_next_ < conflated_.size()) {
+            point = conflated_[conflated_next_++];
+            conflated_left_.store(conflated_.size() - conflated_next_);
+            return true;
+        }
+
+        ApplyPolicy();
+        if (conflated_next_ < conflated_.size()) {
+            continue;
+        }
+
+        if (instrument_ids.empty()) {
+            return reader.Poll(point);
+        }
+
+        const uint64_t next = next_.load(std::memory_order_relaxed);
+        switch (Read(next, point)) {
+        case BroadcastRing::ReadStatus::Ok:
+            next_.store(next + 1, std::memory_order_release);
+            return true;
+        case BroadcastRing::ReadStatus::Overwritten:
+            // lapped, reading goes on with its next point
+            lost_.fetch_add(1, std::memory_order_relaxed);
+            next_.store(next + 1, std::memory_order_release);
+            break;
+        case BroadcastRing::ReadStatus::NotPublished:
+            return false;
+        }
+    }
+}
+
+bool MarketDataSubscription::HasPending() const {
+    return conflated_left_.load() > 0 || Lag() > 0;
+}
+
+void MarketDataSubscription::Close() {
+    active.store(false);
+    doorbell.Ring();
+    if (on_push) {
+        on_push();
+    }
+}
+
+uint64_t MarketDataSubscription::Next() const {
+    if (instrument_ids.empty()) {
+        return reader.Next();
+    }
+    return next_.load(std::memory_order_acquire);
+}
+
+uint64_t MarketDataSubscription::End() const {
+    if (instrument_ids.empty()) {
+        return reader.Ring().Published();
+    }
+    return pushed_.load(std::memory_order_acquire);
+}
+
+BroadcastRing::ReadStatus
+MarketDataSubscription::Read(uint64_t position, MarketDataPoint& point) const {
+    if (instrument_ids.empty()) {
+        return reader.Ring().Read(position, point);
+    }
+
+    const PendingPoint& pending = pending_[position & pending_mask_];
+    const uint64_t pushed = 2 * position + 2;
+
+    const uint64_t before = pending.position.load(std::memory_order_acquire);
+    if (before < pushed) {
+        return BroadcastRing::ReadStatus::NotPublished;
+    }
+    if (before > pushed) {
+        return BroadcastRing::ReadStatus::Overwritten;
+    }
+
+    const uint64_t sequence = pending.sequence.load(std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_acquire);
+
+    if (pending.position.load(std::memory_order_relaxed) != before) {
+        return BroadcastRing::ReadStatus::Overwritten;
+    }
+    return reader.Ring().Read(sequence, point);
+}
+
+void MarketDataSubscription::MoveTo(uint64_t position) {
+    if (instrument_ids.empty()) {
+        reader.SkipTo(position);
+    } else {
+        next_.store(position, std::memory_order_release);
+    }
+}
+
+void MarketDataSubscription::ApplyPolicy() {
+    const uint64_t next = Next();
+    const uint64_t published = End();
+    const bool full = published - next > options.capacity;
+
+    switch (options.policy) {
+    case BackpressurePolicy::DropNewest:
+        if (holding_) {
+            if (next >= keep_until_) {
+                holding_ = false;
+                SkipTo(resume_at_);
+            }
+        } else if (full) {
+            holding_ = true;
+            keep_until_ = next + options.capacity;
+            resume_at_ = published;
+        }
+        break;
+    case BackpressurePolicy::DropOldest:
+    case BackpressurePolicy::BlockWithTimeout:
+        if (full) {
+            SkipTo(published - options.capacity);
+        }
+        break;
+    case BackpressurePolicy::ConflatePerInstrument:
+        if (full) {
+            Conflate(published);
+        }
+        break;
+    case BackpressurePolicy::DisconnectSlowConsumer:
+        // Broadcast closes it, what is left is read
+        break;
+    }
+}
+
+void MarketDataSubscription::SkipTo(uint64_t position) {
+    const uint64_t next = Next();
+    if (position <= next) {
+        return;
+    }
+
+    // every point in between is one of the subscription
+    dropped.fetch_add(position - next, std::memory_order_relaxed);
+    MoveTo(position);
+}
+
+void MarketDataSubscription::Conflate(uint64_t end) {
+    MarketDataPoint point;
+    uint64_t next = Next();
+
+    conflated_.clear();
+    conflated_next_ = 0;
+
+    for (; next < end; ++next) {
+        if (Read(next, point) != BroadcastRing::ReadStatus::Ok) {
+            // lapped, Poll() goes on from there
+            break;
+        }
+
+        if (point.symbol_id >= conflated_index_.size()) {
+            conflated_index_.resize(point.symbol_id + 1);
+        }
+        uint32_t& index = conflated_index_[point.symbol_id];
+        if (index == 0) {
+            conflated_.push_back(point);
+            index = static_cast<uint32_t>(conflated_.size());
+        } else {
+            conflated_[index - 1] = point;
+            dropped.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    for (const auto& kept : conflated_) {
+        conflated_index_[kept.symbol_id] = 0;
+    }
+
+    MoveTo(next);
+    conflated_left_.store(conflated_.size());
+}
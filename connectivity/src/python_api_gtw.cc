@@ -1,45 +1,146 @@
 #include "python_api_gtw.h"
 
-#include <boost/array.hpp>
-#include <boost/asio.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
 #include <iostream>
-#include <nlohmann/json.hpp>
+#include <limits>
 #include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
 
-using namespace boost::asio::ip;
-using json = nlohmann::json;
+#include "socket_feed_gateway.h"
+#include "symbol_table.h"
 
-PythonApiGtw::PythonApiGtw() {}
+static_assert(sizeof(MarketDataRecord::instrument_id) >
+                  SymbolTable::kMaxNameLength,
+              "every interned name fits the ring record");
 
-PythonApiGtw::~PythonApiGtw() {
-  should_stop_.store(true);
+namespace {
 
-  if (socket_reader_thread_.joinable()) {
-    socket_reader_thread_.join();
+// BlockWithTimeout, the point waits until sub has room for it
+void WaitForRoom(MarketDataSubscription &sub) {
+  if (sub.options.policy != BackpressurePolicy::BlockWithTimeout ||
+      sub.Lag() < sub.options.capacity) {
+    return;
   }
 
-  {
-    std::shared_lock<std::shared_mutex> lock(subscribers_mutex_);
-    for (auto &sub : subscribers_) {
-      sub->active.store(false);
+  const auto deadline =
+      std::chrono::steady_clock::now() + sub.options.block_timeout;
+  while (sub.Lag() >= sub.options.capacity) {
+    if (!sub.active.load()) {
+      return;
+    }
+    if (std::chrono::steady_clock::now() >= deadline) {
+      // the stream skips its oldest points instead
+      sub.block_timeouts.fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
+    std::this_thread::yield();
+  }
+}
+
+void Wake(MarketDataSubscription &sub) {
+  // only this thread writes it
+  const uint64_t lag = sub.Lag();
+  if (lag > sub.max_lag.load(std::memory_order_relaxed)) {
+    sub.max_lag.store(lag, std::memory_order_relaxed);
+  }
+
+  if (sub.options.policy == BackpressurePolicy::DisconnectSlowConsumer &&
+      lag > sub.options.capacity) {
+    if (!sub.disconnected.exchange(true)) {
+      sub.Close();
     }
+    return;
+  }
+
+  sub.doorbell.Ring();
+  if (sub.on_push) {
+    sub.on_push();
+  }
+}
+
+} // namespace
+
+PythonApiGtw::PythonApiGtw(uint32_t ring_capacity)
+    : points_(std::make_shared<BroadcastRing>(ring_capacity)) {}
+
+PythonApiGtw::~PythonApiGtw() {
+  for (auto &feed : feeds_) {
+    feed->gateway->Stop();
+  }
+
+  // a gateway never started, or fed with Broadcast
+  CloseSubscribers();
+}
+
+void PythonApiGtw::AddFeed(std::unique_ptr<FeedGateway> feed) {
+  if (running_.load()) {
+    std::cerr << "Feed " << feed->Name() << " added after Start, ignored"
+              << std::endl;
+    return;
   }
+
+  feeds_.push_back(std::make_unique<Feed>());
+  feeds_.back()->gateway = std::move(feed);
+}
+
+void PythonApiGtw::SetConflictRule(FeedConflictRule rule) {
+  conflict_rule_ = rule;
 }
 
 void PythonApiGtw::Start() {
   if (running_.load()) {
     return;
   }
-  should_stop_.store(false);
-  socket_reader_thread_ = std::thread(&PythonApiGtw::SocketReaderThread, this);
+
+  if (feeds_.empty()) {
+    AddFeed(std::make_unique<SocketFeedGateway>());
+  }
+
+  // without the ring, the scripts still get the points through gRPC
+  if (!ring_.IsOpen() && ring_.Create(kMarketDataRingName)) {
+    std::cout << "Publishing market data in shared memory "
+              << kMarketDataRingName << std::endl;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(publish_mutex_);
+    owners_.clear();
+    newest_.clear();
+  }
+
+  open_feeds_.store(feeds_.size());
+  running_.store(true);
+
+  for (std::size_t feed = 0; feed < feeds_.size(); ++feed) {
+    std::cout << "Starting feed " << feed << " from "
+              << feeds_[feed]->gateway->Name() << std::endl;
+    feeds_[feed]->gateway->Start(*this, feed);
+  }
 }
 
-std::shared_ptr<MarketDataSubscription> PythonApiGtw::Subscribe() {
-  auto subscription = std::make_shared<MarketDataSubscription>();
+std::shared_ptr<MarketDataSubscription>
+PythonApiGtw::Subscribe(std::vector<std::string> instrument_ids,
+                        std::function<void()> on_push,
+                        const SubscriptionOptions &options) {
+  // a reader further behind could be lapped before its policy applies
+  SubscriptionOptions bounded = options;
+  bounded.capacity =
+      std::clamp<uint64_t>(options.capacity, 1, points_->Capacity() / 2);
+
+  auto subscription =
+      std::make_shared<MarketDataSubscription>(points_, bounded);
+  subscription->SetInstruments(std::move(instrument_ids));
+  subscription->on_push = std::move(on_push);
 
   {
     std::unique_lock<std::shared_mutex> lock(subscribers_mutex_);
     subscribers_.push_back(subscription);
+    RebuildRoutes();
   }
 
   std::cout << "New client subscribed (total: " << subscribers_.size() << ")"
@@ -54,6 +155,15 @@ void PythonApiGtw::Unsubscribe(
   auto it = std::find(subscribers_.begin(), subscribers_.end(), subscription);
   if (it != subscribers_.end()) {
     subscribers_.erase(it);
+    RebuildRoutes();
+  }
+
+  // one line per stream, the counters are not logged as they move
+  if (subscription->dropped.load() > 0 || subscription->LostCount() > 0) {
+    std::cout << "Client dropped " << subscription->dropped.load()
+              << " updates and lost " << subscription->LostCount()
+              << " (max lag " << subscription->max_lag.load() << ")"
+              << std::endl;
   }
 
   std::cout << "Client unsubscribed (remaining: " << subscribers_.size() << ")"
@@ -62,121 +172,166 @@ void PythonApiGtw::Unsubscribe(
 
 bool PythonApiGtw::IsRunning() const { return running_.load(); }
 
-void PythonApiGtw::Broadcast(const MarketDataPoint &point) {
-  std::shared_lock<std::shared_mutex> lock(subscribers_mutex_);
+uint64_t PythonApiGtw::PublishedCount(std::size_t feed) const {
+  return feeds_[feed]->published.load(std::memory_order_relaxed);
+}
+
+uint64_t PythonApiGtw::ConflictCount(std::size_t feed) const {
+  return feeds_[feed]->conflicts.load(std::memory_order_relaxed);
+}
 
+void PythonApiGtw::CloseSubscribers() {
+  std::shared_lock<std::shared_mutex> lock(subscribers_mutex_);
   for (auto &sub : subscribers_) {
-    if (!sub->queue.push(point)) {
-      std::cerr << "WARNING: Queue full for a subscriber, dropping update for "
-                << point.instrument_id << std::endl;
-    }
+    sub->Close();
   }
 }
 
-void PythonApiGtw::SocketReaderThread() {
-  running_.store(true);
+void PythonApiGtw::RebuildRoutes() {
+  routes_.clear();
+  all_instruments_subscribers_.clear();
+  blocking_subscribers_ = 0;
 
-  try {
-    boost::asio::io_service ios;
+  for (auto &sub : subscribers_) {
+    if (sub->options.policy == BackpressurePolicy::BlockWithTimeout) {
+      ++blocking_subscribers_;
+    }
 
-    tcp::endpoint endpoint(boost::asio::ip::address::from_string("127.0.0.1"),
-                           9000);
-    tcp::socket socket(ios);
+    if (sub->instrument_ids.empty()) {
+      all_instruments_subscribers_.push_back(sub.get());
+      continue;
+    }
 
-    socket.connect(endpoint);
-    std::cout << "Connected to Python API Gateway on port 9000" << std::endl;
+    for (uint32_t symbol_id : sub->symbol_ids) {
+      if (symbol_id >= routes_.size()) {
+        routes_.resize(symbol_id + 1);
+      }
+      auto &route = routes_[symbol_id];
+      // an instrument requested twice by the same subscriber
+      if (route.empty() || route.back() != sub.get()) {
+        route.push_back(sub.get());
+      }
+    }
+  }
+}
 
-    boost::array<char, 4096> buffer;
-    std::string accumulated_data;
-    constexpr size_t max_accumulated_size = 1024 * 1024;
+void PythonApiGtw::OnPoint(std::size_t feed, const MarketDataPoint &point,
+                           uint64_t /*sequence*/) {
+  std::lock_guard<std::mutex> lock(publish_mutex_);
 
-    while (!should_stop_.load()) {
-      boost::system::error_code error;
+  // decided with the lock held, so the points of an instrument are
+  // published in the order the rule accepted them
+  if (!Accept(feed, point)) {
+    feeds_[feed]->conflicts.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
 
-      size_t len = socket.read_some(boost::asio::buffer(buffer), error);
+  Publish(point);
+  feeds_[feed]->published.fetch_add(1, std::memory_order_relaxed);
+}
 
-      if (error == boost::asio::error::eof) {
-        std::cout << "Connection closed by peer" << std::endl;
-        break;
-      } else if (error) {
-        std::cerr << "Error reading from socket: " << error.message()
-                  << std::endl;
-        break;
+void PythonApiGtw::OnFeedClosed(std::size_t feed) {
+  std::cout << "Feed " << feed << " from " << feeds_[feed]->gateway->Name()
+            << " closed after " << PublishedCount(feed) << " points ("
+            << ConflictCount(feed) << " dropped by the conflict rule)"
+            << std::endl;
+
+  {
+    // the other feeds take its instruments
+    std::lock_guard<std::mutex> lock(publish_mutex_);
+    for (auto &owner : owners_) {
+      if (owner == feed + 1) {
+        owner = 0;
       }
+    }
+  }
 
-      accumulated_data.append(buffer.data(), len);
+  if (open_feeds_.fetch_sub(1) == 1) {
+    running_.store(false);
+    CloseSubscribers();
+  }
+}
 
-      if (accumulated_data.size() > max_accumulated_size) {
-        std::cerr << "Accumulated data exceeded limit, clearing buffer"
-                  << std::endl;
-        accumulated_data.clear();
-        continue;
-      }
+bool PythonApiGtw::Accept(std::size_t feed, const MarketDataPoint &point) {
+  switch (conflict_rule_) {
+  case FeedConflictRule::AcceptAll:
+    return true;
 
-      size_t newline_pos;
-      while ((newline_pos = accumulated_data.find('\n')) != std::string::npos) {
-        std::string json_line = accumulated_data.substr(0, newline_pos);
-        accumulated_data.erase(0, newline_pos + 1);
-
-        if (json_line.empty()) {
-          continue;
-        }
-
-        try {
-          json json_data = json::parse(json_line);
-
-          MarketDataPoint data_point;
-
-          if (json_data.contains("price")) {
-            data_point.price = json_data["price"].get<double>();
-          }
-          if (json_data.contains("quantity")) {
-            data_point.quantity = json_data["quantity"].get<int64_t>();
-          }
-          if (json_data.contains("instrument_id")) {
-            data_point.set_instrument_id(
-                json_data["instrument_id"].get<std::string>().c_str());
-          }
-
-          auto now = std::chrono::system_clock::now();
-          auto duration = now.time_since_epoch();
-          auto seconds =
-              std::chrono::duration_cast<std::chrono::seconds>(duration);
-          auto nanos_total =
-              std::chrono::duration_cast<std::chrono::nanoseconds>(duration);
-          auto nanos_remainder =
-              nanos_total -
-              std::chrono::duration_cast<std::chrono::nanoseconds>(seconds);
-
-          data_point.timestamp_seconds = seconds.count();
-          data_point.timestamp_nanos =
-              static_cast<int32_t>(nanos_remainder.count());
-
-          Broadcast(data_point);
-
-        } catch (const json::parse_error &parse_error) {
-          std::cerr << "JSON parse error: " << parse_error.what() << std::endl;
-          std::cerr << "Raw data: " << json_line << std::endl;
-        } catch (const std::exception &exception) {
-          std::cerr << "Error processing message: " << exception.what()
-                    << std::endl;
-        }
-      }
+  case FeedConflictRule::FeedPriority: {
+    if (point.symbol_id >= owners_.size()) {
+      owners_.resize(point.symbol_id + 1);
     }
+    uint32_t &owner = owners_[point.symbol_id];
+    if (owner != 0 && owner < feed + 1) {
+      return false;
+    }
+    owner = static_cast<uint32_t>(feed + 1);
+    return true;
+  }
 
-  } catch (const std::exception &exception) {
-    std::cerr << "Exception in SocketReaderThread: " << exception.what()
-              << std::endl;
+  case FeedConflictRule::NewestTimestamp: {
+    if (point.symbol_id >= newest_.size()) {
+      newest_.resize(point.symbol_id + 1,
+                     std::numeric_limits<int64_t>::min());
+    }
+    const int64_t timestamp =
+        point.timestamp_seconds * 1000000000 + point.timestamp_nanos;
+    int64_t &newest = newest_[point.symbol_id];
+    if (timestamp < newest) {
+      return false;
+    }
+    newest = timestamp;
+    return true;
+  }
+  }
+  return true;
+}
+
+void PythonApiGtw::Broadcast(const MarketDataPoint &point) {
+  std::lock_guard<std::mutex> lock(publish_mutex_);
+  Publish(point);
+}
+
+void PythonApiGtw::Publish(const MarketDataPoint &point) {
+  if (ring_.IsOpen()) {
+    MarketDataRecord record;
+    record.price = point.price;
+    record.quantity = point.quantity;
+    record.timestamp_seconds = point.timestamp_seconds;
+    record.timestamp_nanos = point.timestamp_nanos;
+    // the scripts read the name, the ids only mean something here
+    const std::string_view name = point.instrument_id();
+    std::memcpy(record.instrument_id, name.data(), name.size());
+    std::memset(record.instrument_id + name.size(), 0,
+                sizeof(record.instrument_id) - name.size());
+    ring_.Publish(record);
   }
 
-  running_.store(false);
+  std::shared_lock<std::shared_mutex> lock(subscribers_mutex_);
 
-  {
-    std::shared_lock<std::shared_mutex> lock(subscribers_mutex_);
-    for (auto &sub : subscribers_) {
-      sub->active.store(false);
+  static const std::vector<MarketDataSubscription *> kNoRoute;
+  const auto &route =
+      point.symbol_id < routes_.size() ? routes_[point.symbol_id] : kNoRoute;
+
+  if (blocking_subscribers_ > 0) {
+    for (auto *sub : all_instruments_subscribers_) {
+      WaitForRoom(*sub);
+    }
+    for (auto *sub : route) {
+      WaitForRoom(*sub);
     }
   }
 
-  std::cout << "Socket reader thread exiting" << std::endl;
+  // written once, every subscription reads it from there
+  points_->Publish(point);
+  const uint64_t sequence = points_->Published() - 1;
+
+  for (auto *sub : all_instruments_subscribers_) {
+    Wake(*sub);
+  }
+  // the others only count and read their own points
+  for (auto *sub : route) {
+    sub->Push(sequence);
+    Wake(*sub);
+  }
 }
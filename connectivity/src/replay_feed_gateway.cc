@@ -0,0 +1,163 @@
+#include "replay_feed_gateway.h"
+
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utility>
+
+#include "feed_protocol.h"
+
+using namespace std::chrono;
+
+namespace {
+
+// where a record keeps its timestamp, see feed_protocol.h
+constexpr std::size_t kTimestampOffset = 20;
+
+} // namespace
+
+ReplayFeedGateway::ReplayFeedGateway(std::string path, double speed)
+    : path_(std::move(path)), speed_(speed) {}
+
+ReplayFeedGateway::~ReplayFeedGateway() { Stop(); }
+
+std::string ReplayFeedGateway::Name() const { return "replay " + path_; }
+
+void ReplayFeedGateway::Start(FeedSink &sink, std::size_t feed) {
+  if (running_.load()) {
+    return;
+  }
+  // the thread of a replay which reached the end of its file
+  if (replay_thread_.joinable()) {
+    replay_thread_.join();
+  }
+
+  sink_ = &sink;
+  feed_ = feed;
+  should_stop_.store(false);
+  running_.store(true);
+
+  replay_thread_ = std::thread(&ReplayFeedGateway::ReplayThread, this);
+}
+
+void ReplayFeedGateway::Stop() {
+  {
+    std::lock_guard<std::mutex> lock(wait_mutex_);
+    should_stop_.store(true);
+  }
+  stopped_.notify_all();
+
+  if (replay_thread_.joinable()) {
+    replay_thread_.join();
+  }
+}
+
+bool ReplayFeedGateway::IsRunning() const { return running_.load(); }
+
+void ReplayFeedGateway::ReplayThread() {
+  const int fd = open(path_.c_str(), O_RDONLY);
+  struct stat info;
+
+  if (fd == -1 || fstat(fd, &info) == -1) {
+    std::cerr << "could not open the recording " << path_ << ": "
+              << std::strerror(errno) << std::endl;
+  } else if (info.st_size > 0) {
+    const std::size_t size = static_cast<std::size_t>(info.st_size);
+    void *memory = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+    if (memory == MAP_FAILED) {
+      std::cerr << "could not map the recording " << path_ << ": "
+                << std::strerror(errno) << std::endl;
+    } else {
+      // read once from the start to the end
+      madvise(memory, size, MADV_SEQUENTIAL);
+
+      std::cout << "Replaying " << size << " bytes of " << path_ << std::endl;
+      Replay(static_cast<const char *>(memory), size);
+      munmap(memory, size);
+    }
+  }
+
+  if (fd != -1) {
+    close(fd);
+  }
+
+  std::cout << "Replayed " << replayed_.load() << " records of " << path_
+            << " (" << duration_cast<microseconds>(MaxLateness()).count()
+            << " us late at most)" << std::endl;
+
+  running_.store(false);
+  sink_->OnFeedClosed(feed_);
+}
+
+void ReplayFeedGateway::Replay(const char *data, std::size_t size) {
+  std::size_t offset = 0;
+  if (static_cast<uint8_t>(data[0]) == kBinaryFeedHandshake) {
+    offset = 1;
+  }
+
+  // the first timestamp of the recording is replayed at start
+  int64_t first_ns = 0;
+  steady_clock::time_point start;
+
+  while (offset < size && !should_stop_.load(std::memory_order_relaxed)) {
+    MarketDataPoint point;
+    std::size_t consumed = 0;
+    uint64_t sequence = kNoSequence;
+
+    const DecodeStatus status = DecodeBinaryRecord(
+        data + offset, size - offset, point, consumed, sequence);
+
+    if (status != DecodeStatus::Ok) {
+      std::cerr << (status == DecodeStatus::NeedMore ? "Truncated"
+                                                     : "Invalid")
+                << " record at offset " << offset << " of " << path_
+                << std::endl;
+      break;
+    }
+
+    int64_t recorded_ns;
+    std::memcpy(&recorded_ns, data + offset + kTimestampOffset,
+                sizeof(recorded_ns));
+
+    if (speed_ > 0 && recorded_ns != 0) {
+      const steady_clock::time_point now = steady_clock::now();
+      if (first_ns == 0) {
+        first_ns = recorded_ns;
+        start = now;
+      }
+
+      const auto due =
+          start + duration_cast<steady_clock::duration>(
+                      duration<double, std::nano>((recorded_ns - first_ns) /
+                                                  speed_));
+      if (due > now && !WaitUntil(due)) {
+        break;
+      }
+
+      // the wake up counts too
+      const int64_t late =
+          duration_cast<nanoseconds>((due > now ? steady_clock::now() : now) -
+                                     due)
+              .count();
+      // only this thread writes it
+      if (late > max_lateness_ns_.load(std::memory_order_relaxed)) {
+        max_lateness_ns_.store(late, std::memory_order_relaxed);
+      }
+    }
+
+    sink_->OnPoint(feed_, point, sequence);
+    replayed_.fetch_add(1, std::memory_order_relaxed);
+    offset += consumed;
+  }
+}
+
+bool ReplayFeedGateway::WaitUntil(steady_clock::time_point due) {
+  std::unique_lock<std::mutex> lock(wait_mutex_);
+  return !stopped_.wait_until(lock, due,
+                              [this] { return should_stop_.load(); });
+}
@@ -0,0 +1,253 @@
+#include "services/market_data_callback_service.h"
+
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "services/market_data_service.h"
+
+namespace {
+
+// one point per message
+bool FillMessage(MarketDataSubscription &subscription,
+                 internal::PriceUpdate &price_update) {
+  MarketDataPoint data_point;
+  if (!subscription.Poll(data_point)) {
+    return false;
+  }
+
+  MarketDataService::FillPriceUpdate(data_point, price_update);
+  return true;
+}
+
+// everything pending
+bool FillMessage(MarketDataSubscription &subscription,
+                 internal::PriceUpdateBatch &batch) {
+  batch.clear_updates();
+
+  MarketDataPoint data_point;
+  while (batch.updates_size() < MarketDataService::kMaxBatchSize &&
+         subscription.Poll(data_point)) {
+    MarketDataService::FillPriceUpdate(data_point, *batch.add_updates());
+  }
+
+  return batch.updates_size() > 0;
+}
+
+} // namespace
+
+// armed_ is true while the stream waits for a push, whoever sets it
+// back to false owns the next fill, so there is only one at a time
+// the other flags are guarded by mtx_
+// a reactor deletes itself once gRPC called OnDone and no pump job
+// is left
+template <typename Message>
+class PriceStreamReactor final : public grpc::ServerWriteReactor<Message> {
+public:
+  PriceStreamReactor(MarketDataCallbackService &service,
+                     const internal::MarketDataRequest &request)
+      : service_(service) {
+    // the gateway only wakes us for the requested instruments
+    subscription_ = service_.gateway_->Subscribe(
+        std::vector<std::string>(request.instrument_ids().begin(),
+                                 request.instrument_ids().end()),
+        [this] { OnPush(); },
+        MarketDataService::SubscriptionOptionsFrom(request));
+    ++service_.open_streams_;
+
+    Rearm();
+  }
+
+  void OnWriteDone(bool ok) override {
+    {
+      std::unique_lock<std::mutex> lock(mtx_);
+      writing_ = false;
+
+      if (!ok) {
+        // client disconnected
+        cancelled_ = true;
+      }
+
+      if (cancelled_) {
+        if (!finished_ && pumps_ == 0) {
+          FinishLocked(lock);
+        }
+        return;
+      }
+    }
+
+    Rearm();
+  }
+
+  void OnCancel() override {
+    std::unique_lock<std::mutex> lock(mtx_);
+    cancelled_ = true;
+
+    if (!finished_ && !writing_ && pumps_ == 0) {
+      FinishLocked(lock);
+    }
+  }
+
+  void OnDone() override {
+    // no on_push once it returns
+    service_.gateway_->Unsubscribe(subscription_);
+    --service_.open_streams_;
+
+    std::unique_lock<std::mutex> lock(mtx_);
+    done_ = true;
+
+    if (pumps_ == 0) {
+      lock.unlock();
+      delete this;
+    }
+  }
+
+private:
+  // feed thread publishing the point
+  void OnPush() {
+    // pairs with the fence of Rearm, either we see armed_ or Rearm
+    // sees the point we pushed
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    if (armed_.load(std::memory_order_relaxed) && armed_.exchange(false)) {
+      Schedule();
+    }
+  }
+
+  void Rearm() {
+    armed_.store(true, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    if (HasWork() && armed_.exchange(false)) {
+      Schedule();
+    }
+  }
+
+  bool HasWork() const {
+    return subscription_->HasPending() ||
+           !subscription_->active.load();
+  }
+
+  void Schedule() {
+    {
+      std::lock_guard<std::mutex> lock(mtx_);
+      ++pumps_;
+    }
+    service_.pump_.Submit([this] { Pump(); });
+  }
+
+  // pump thread, owns the fill
+  void Pump() {
+    while (true) {
+      {
+        std::unique_lock<std::mutex> lock(mtx_);
+        if (finished_ || cancelled_) {
+          break;
+        }
+        if (!subscription_->active.load()) {
+          // the gateway is gone
+          if (!writing_) {
+            FinishLocked(lock);
+          }
+          break;
+        }
+      }
+
+      if (FillMessage(*subscription_, message_)) {
+        std::unique_lock<std::mutex> lock(mtx_);
+        if (finished_ || cancelled_) {
+          break;
+        }
+        writing_ = true;
+        lock.unlock();
+
+        // OnWriteDone takes over the fill
+        this->StartWrite(&message_);
+        break;
+      }
+
+      // a push may have come after the fill found nothing
+      armed_.store(true, std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      if (!HasWork() || !armed_.exchange(false)) {
+        break;
+      }
+    }
+
+    std::unique_lock<std::mutex> lock(mtx_);
+
+    // a cancel that came while we held the fill, finished before
+    // leaving pumps_ so OnDone cannot delete us meanwhile
+    if (cancelled_ && !finished_ && !writing_ && pumps_ == 1) {
+      FinishLocked(lock);
+      lock.lock();
+    }
+
+    --pumps_;
+
+    if (done_ && pumps_ == 0) {
+      lock.unlock();
+      delete this;
+    }
+  }
+
+  // Finish is called without mtx_, OnDone takes it
+  void FinishLocked(std::unique_lock<std::mutex> &lock) {
+    finished_ = true;
+    const bool cancelled = cancelled_;
+    lock.unlock();
+
+    if (cancelled) {
+      this->Finish(grpc::Status::CANCELLED);
+    } else if (subscription_->disconnected.load()) {
+      this->Finish(MarketDataService::SlowConsumerStatus());
+    } else {
+      this->Finish(grpc::Status::OK);
+    }
+  }
+
+  MarketDataCallbackService &service_;
+  std::shared_ptr<MarketDataSubscription> subscription_;
+
+  // written by the fill owner only, read by gRPC until OnWriteDone
+  Message message_;
+
+  std::atomic<bool> armed_{false};
+
+  std::mutex mtx_;
+  // pump jobs submitted and not yet returned
+  int pumps_ = 0;
+  bool writing_ = false;
+  bool cancelled_ = false;
+  bool finished_ = false;
+  bool done_ = false;
+};
+
+MarketDataCallbackService::MarketDataCallbackService(std::size_t pump_threads)
+    : MarketDataCallbackService(std::make_shared<PythonApiGtw>(),
+                                pump_threads) {
+  gateway_->Start();
+  std::cout << "MarketDataCallbackService initialized" << std::endl;
+}
+
+MarketDataCallbackService::MarketDataCallbackService(
+    std::shared_ptr<PythonApiGtw> gateway, std::size_t pump_threads)
+    : gateway_(std::move(gateway)), pump_(pump_threads) {}
+
+grpc::ServerWriteReactor<internal::PriceUpdate> *
+MarketDataCallbackService::StreamPrices(
+    grpc::CallbackServerContext * /*context*/,
+    const internal::MarketDataRequest *request) {
+  ++call_count_;
+  return new PriceStreamReactor<internal::PriceUpdate>(*this, *request);
+}
+
+grpc::ServerWriteReactor<internal::PriceUpdateBatch> *
+MarketDataCallbackService::StreamPriceBatches(
+    grpc::CallbackServerContext * /*context*/,
+    const internal::MarketDataRequest *request) {
+  ++call_count_;
+  return new PriceStreamReactor<internal::PriceUpdateBatch>(*this, *request);
+}
@@ -4,7 +4,10 @@
 #include <google/protobuf/timestamp.pb.h>
 #include <iostream>
 #include <stdexcept>
-#include <thread>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
 
 MarketDataService::MarketDataService()
     : gateway_(std::make_shared<PythonApiGtw>()) {
@@ -12,51 +15,50 @@ MarketDataService::MarketDataService()
   std::cout << "MarketDataService initialized" << std::endl;
 }
 
-grpc::Status MarketDataService::StreamPrices(
-    grpc::ServerContext *context, const google::protobuf::Empty * /*request*/,
-    grpc::ServerWriter<internal::PriceUpdate> *writer) {
+MarketDataService::MarketDataService(std::shared_ptr<PythonApiGtw> gateway)
+    : gateway_(std::move(gateway)) {}
 
+std::shared_ptr<MarketDataSubscription>
+MarketDataService::Subscribe(const char *rpc_name,
+                             const internal::MarketDataRequest &request) {
   ++call_count_;
 
-  std::cout << "Client connected to StreamPrices (call #" << call_count_ << ")"
-            << std::endl;
+  std::cout << "Client connected to " << rpc_name << " (call #" << call_count_
+            << ", instruments: ";
+  if (request.instrument_ids().empty()) {
+    std::cout << "all";
+  } else {
+    std::cout << request.instrument_ids_size();
+  }
+  std::cout << ")" << std::endl;
+
+  if (!gateway_) {
+    throw std::runtime_error("Python gateway not initialized");
+  }
+
+  // the gateway only wakes the stream for the requested instruments
+  // so the others are never serialized for this client
+  return gateway_->Subscribe(
+      std::vector<std::string>(request.instrument_ids().begin(),
+                               request.instrument_ids().end()),
+      {}, SubscriptionOptionsFrom(request));
+}
+
+grpc::Status MarketDataService::StreamPrices(
+    grpc::ServerContext *context, const internal::MarketDataRequest *request,
+    grpc::ServerWriter<internal::PriceUpdate> *writer) {
 
   try {
-    if (!gateway_) {
-      throw std::runtime_error("Python gateway not initialized");
-    }
+    auto subscription = Subscribe("StreamPrices", *request);
 
-    auto subscription = gateway_->Subscribe();
-
-    while (!context->IsCancelled() && subscription->active.load()) {
-      MarketDataPoint data_point;
-
-      if (subscription->queue.pop(data_point)) {
-        internal::PriceUpdate price_update;
-        price_update.set_price(data_point.price);
-        price_update.set_quantity(data_point.quantity);
-        price_update.set_instrument_id(data_point.instrument_id);
-
-        auto *timestamp = price_update.mutable_timestamp();
-        timestamp->set_seconds(data_point.timestamp_seconds);
-        timestamp->set_nanos(data_point.timestamp_nanos);
-
-        if (!writer->Write(price_update)) {
-          std::cerr << "Failed to write to gRPC stream (client disconnected)"
-                    << std::endl;
-          break;
-        } else {
-          std::cout << "Sent price update: " << data_point.instrument_id
-                    << " price=" << data_point.price
-                    << " quantity=" << data_point.quantity << std::endl;
-        }
-      } else {
-        std::this_thread::sleep_for(std::chrono::microseconds(100));
-      }
-    }
+    WritePoints(context, *subscription, OptionsFrom(*request), writer);
 
     gateway_->Unsubscribe(subscription);
 
+    if (subscription->disconnected.load()) {
+      return SlowConsumerStatus();
+    }
+
     std::cout << "StreamPrices completed for client" << std::endl;
 
   } catch (const std::exception &except) {
@@ -71,3 +73,96 @@ grpc::Status MarketDataService::StreamPrices(
 
   return grpc::Status::OK;
 }
+
+grpc::Status MarketDataService::StreamPriceBatches(
+    grpc::ServerContext *context, const internal::MarketDataRequest *request,
+    grpc::ServerWriter<internal::PriceUpdateBatch> *writer) {
+
+  try {
+    auto subscription = Subscribe("StreamPriceBatches", *request);
+
+    WriteBatches(context, *subscription, OptionsFrom(*request), writer);
+
+    gateway_->Unsubscribe(subscription);
+
+    if (subscription->disconnected.load()) {
+      return SlowConsumerStatus();
+    }
+
+    std::cout << "StreamPriceBatches completed for client" << std::endl;
+
+  } catch (const std::exception &except) {
+    ++failed_call_count_;
+
+    std::cerr << "Exception in StreamPriceBatches: " << except.what()
+              << std::endl;
+
+    return grpc::Status(
+        grpc::StatusCode::INTERNAL,
+        std::string("Exception in MarketData StreamPriceBatches: ") +
+            except.what());
+  }
+
+  return grpc::Status::OK;
+}
+
+void MarketDataService::FillPriceUpdate(const MarketDataPoint &data_point,
+                                        internal::PriceUpdate &price_update) {
+  price_update.set_price(data_point.price);
+  price_update.set_quantity(data_point.quantity);
+  // the only place the name of a point is looked up for the streams
+  const std::string_view instrument_id = data_point.instrument_id();
+  price_update.set_instrument_id(instrument_id.data(), instrument_id.size());
+
+  auto *timestamp = price_update.mutable_timestamp();
+  timestamp->set_seconds(data_point.timestamp_seconds);
+  timestamp->set_nanos(data_point.timestamp_nanos);
+}
+
+StreamOptions
+MarketDataService::OptionsFrom(const internal::MarketDataRequest &request) {
+  StreamOptions options;
+  options.max_batch_delay =
+      std::chrono::microseconds(request.max_batch_delay_us());
+  options.spin = std::chrono::microseconds(request.wait_spin_us());
+  return options;
+}
+
+SubscriptionOptions MarketDataService::SubscriptionOptionsFrom(
+    const internal::MarketDataRequest &request) {
+  SubscriptionOptions options;
+
+  switch (request.backpressure()) {
+  case internal::MarketDataRequest::DROP_OLDEST:
+    options.policy = BackpressurePolicy::DropOldest;
+    break;
+  case internal::MarketDataRequest::CONFLATE_PER_INSTRUMENT:
+    options.policy = BackpressurePolicy::ConflatePerInstrument;
+    break;
+  case internal::MarketDataRequest::BLOCK_WITH_TIMEOUT:
+    options.policy = BackpressurePolicy::BlockWithTimeout;
+    break;
+  case internal::MarketDataRequest::DISCONNECT_SLOW_CONSUMER:
+    options.policy = BackpressurePolicy::DisconnectSlowConsumer;
+    break;
+  default:
+    // DROP_NEWEST, or a policy added after this distributor
+    options.policy = BackpressurePolicy::DropNewest;
+    break;
+  }
+
+  if (request.queue_capacity() > 0) {
+    options.capacity = request.queue_capacity();
+  }
+  if (request.block_timeout_us() > 0) {
+    options.block_timeout =
+        std::chrono::microseconds(request.block_timeout_us());
+  }
+  return options;
+}
+
+grpc::Status MarketDataService::SlowConsumerStatus() {
+  return grpc::Status(grpc::StatusCode::RESOURCE_EXHAUSTED,
+                      "stream closed, it lagged more than queue_capacity "
+                      "updates behind the feed");
+}
@@ -0,0 +1,217 @@
+#include "socket_feed_gateway.h"
+
+#include <boost/asio.hpp>
+#include <iostream>
+#include <nlohmann/json.hpp>
+#include <string_view>
+#include <sys/socket.h>
+#include <utility>
+
+#include "feed_protocol.h"
+
+using namespace boost::asio::ip;
+using json = nlohmann::json;
+
+SocketFeedGateway::SocketFeedGateway(std::string host, uint16_t port,
+                                     std::chrono::milliseconds reconnect_delay)
+    : host_(std::move(host)), port_(port), reconnect_delay_(reconnect_delay) {}
+
+SocketFeedGateway::~SocketFeedGateway() { Stop(); }
+
+std::string SocketFeedGateway::Name() const {
+  return host_ + ":" + std::to_string(port_);
+}
+
+void SocketFeedGateway::Start(FeedSink &sink, std::size_t feed) {
+  if (running_.load()) {
+    return;
+  }
+  // the thread of a feed which ended on its own
+  if (socket_reader_thread_.joinable()) {
+    socket_reader_thread_.join();
+  }
+
+  sink_ = &sink;
+  feed_ = feed;
+  should_stop_.store(false);
+  running_.store(true);
+
+  socket_reader_thread_ =
+      std::thread(&SocketFeedGateway::SocketReaderThread, this);
+}
+
+void SocketFeedGateway::Stop() {
+  should_stop_.store(true);
+
+  {
+    std::lock_guard<std::mutex> lock(socket_mutex_);
+    if (socket_fd_ != -1) {
+      // read_some returns, the socket itself is closed by its thread
+      ::shutdown(socket_fd_, SHUT_RDWR);
+    }
+  }
+  stopped_.notify_all();
+
+  if (socket_reader_thread_.joinable()) {
+    socket_reader_thread_.join();
+  }
+}
+
+bool SocketFeedGateway::IsRunning() const { return running_.load(); }
+
+void SocketFeedGateway::SocketReaderThread() {
+  while (true) {
+    ReadConnection();
+
+    if (should_stop_.load() || reconnect_delay_.count() == 0) {
+      break;
+    }
+
+    std::unique_lock<std::mutex> lock(socket_mutex_);
+    if (stopped_.wait_for(lock, reconnect_delay_,
+                          [this] { return should_stop_.load(); })) {
+      break;
+    }
+    std::cout << "Reconnecting to " << Name() << std::endl;
+  }
+
+  running_.store(false);
+  sink_->OnFeedClosed(feed_);
+
+  std::cout << "Socket reader thread exiting" << std::endl;
+}
+
+void SocketFeedGateway::ReadConnection() {
+  // closed once Stop() can no longer see its descriptor
+  boost::asio::io_service ios;
+  tcp::socket socket(ios);
+
+  try {
+    tcp::endpoint endpoint(boost::asio::ip::address::from_string(host_),
+                           port_);
+    socket.connect(endpoint);
+
+    // a Stop() which came before sees the socket, one which came
+    // during connect() is seen by the loop
+    {
+      std::lock_guard<std::mutex> lock(socket_mutex_);
+      socket_fd_ = socket.native_handle();
+    }
+
+    connects_.fetch_add(1);
+    std::cout << "Connected to Python API Gateway on " << Name() << std::endl;
+    sink_->OnFeedSession(feed_);
+
+    FeedBuffer feed;
+    FeedFormat format = FeedFormat::Unknown;
+
+    while (!should_stop_.load()) {
+      boost::system::error_code error;
+
+      // the complete lines and records are consumed after every read
+      // so only a line longer than the buffer could leave it full
+      char *write_data = feed.WriteData();
+      if (feed.WriteSpace() == 0) {
+        std::cerr << "Feed buffer full, closing the feed" << std::endl;
+        break;
+      }
+
+      size_t len = socket.read_some(
+          boost::asio::buffer(write_data, feed.WriteSpace()), error);
+
+      if (error == boost::asio::error::eof) {
+        std::cout << "Connection closed by peer" << std::endl;
+        break;
+      } else if (error) {
+        std::cerr << "Error reading from socket: " << error.message()
+                  << std::endl;
+        break;
+      }
+
+      feed.Commit(len);
+
+      // the first byte of the feed tells its format
+      if (format == FeedFormat::Unknown && !feed.Data().empty()) {
+        if (static_cast<uint8_t>(feed.Data()[0]) == kBinaryFeedHandshake) {
+          format = FeedFormat::Binary;
+          feed.Consume(1);
+          std::cout << "Python API Gateway sends binary records" << std::endl;
+        } else {
+          format = FeedFormat::Json;
+        }
+      }
+
+      if (format == FeedFormat::Binary) {
+        if (!ConsumeBinary(feed)) {
+          std::cerr << "Invalid binary record, closing the feed" << std::endl;
+          break;
+        }
+      } else {
+        const std::size_t dropped = feed.DroppedLines();
+        ConsumeJson(feed);
+        if (feed.DroppedLines() != dropped) {
+          std::cerr << "Dropped a line longer than " << feed.Capacity()
+                    << " bytes" << std::endl;
+        }
+      }
+    }
+
+  } catch (const std::exception &exception) {
+    std::cerr << "Exception in SocketReaderThread (" << Name()
+              << "): " << exception.what() << std::endl;
+  }
+
+  std::lock_guard<std::mutex> lock(socket_mutex_);
+  socket_fd_ = -1;
+}
+
+bool SocketFeedGateway::ConsumeBinary(FeedBuffer &feed) {
+  const std::string_view data = feed.Data();
+  std::size_t offset = 0;
+
+  while (offset < data.size()) {
+    MarketDataPoint data_point;
+    std::size_t consumed = 0;
+    uint64_t sequence = kNoSequence;
+
+    const DecodeStatus status =
+        DecodeBinaryRecord(data.data() + offset, data.size() - offset,
+                           data_point, consumed, sequence);
+
+    if (status == DecodeStatus::NeedMore) {
+      break;
+    }
+    if (status == DecodeStatus::Invalid) {
+      return false;
+    }
+
+    sink_->OnPoint(feed_, data_point, sequence);
+    offset += consumed;
+  }
+
+  feed.Consume(offset);
+  return true;
+}
+
+void SocketFeedGateway::ConsumeJson(FeedBuffer &feed) {
+  std::string_view json_line;
+
+  while (feed.NextLine(json_line)) {
+    if (json_line.empty()) {
+      continue;
+    }
+
+    try {
+      MarketDataPoint data_point;
+      ParseJsonTick(json_line, data_point);
+      sink_->OnPoint(feed_, data_point, kNoSequence);
+
+    } catch (const json::parse_error &parse_error) {
+      std::cerr << "JSON parse error: " << parse_error.what() << std::endl;
+      std::cerr << "Raw data: " << json_line << std::endl;
+    } catch (const std::exception &exception) {
+      std::cerr << "Error processing message: " << exception.what()
+                << std::endl;
+    }
+  }
+}
@@ -0,0 +1,69 @@
+#include "symbol_table.h"
+
+#include <iostream>
+#include <mutex>
+
+SymbolTable::SymbolTable() {
+    // kEmptyId, so that a default point has the empty name
+    Intern(std::string_view());
+}
+
+SymbolTable::~SymbolTable() {
+    for (auto& chunk : chunks_) {
+        delete chunk.load(std::memory_order_relaxed);
+    }
+}
+
+uint32_t SymbolTable::Intern(std::string_view name) {
+    name = name.substr(0, kMaxNameLength);
+
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        auto it = ids_.find(name);
+        if (it != ids_.end()) {
+            return it->second;
+        }
+    }
+
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    // interned by another thread between the two locks
+    auto it = ids_.find(name);
+    if (it != ids_.end()) {
+        return it->second;
+    }
+
+    const uint32_t id = size_.load(std::memory_order_relaxed);
+    const std::size_t chunk_index = id >> kChunkBits;
+    if (chunk_index >= kMaxChunks) {
+        std::cerr << "WARNING: Symbol table full, dropping instrument "
+                  << name << std::endl;
+        return kEmptyId;
+    }
+
+    Chunk* chunk = chunks_[chunk_index].load(std::memory_order_relaxed);
+    if (chunk == nullptr) {
+        chunk = new Chunk();
+        chunks_[chunk_index].store(chunk, std::memory_order_release);
+    }
+
+    std::string& stored = chunk->names[id & (kChunkSize - 1)];
+    stored.assign(name);
+    ids_.emplace(std::string_view(stored), id);
+
+    size_.store(id + 1, std::memory_order_release);
+    return id;
+}
+
+std::string_view SymbolTable::Name(uint32_t id) const {
+    if (id >= size_.load(std::memory_order_acquire)) {
+        return {};
+    }
+
+    const Chunk* chunk =
+        chunks_[id >> kChunkBits].load(std::memory_order_acquire);
+    return chunk->names[id & (kChunkSize - 1)];
+}
+
+std::size_t SymbolTable::Size() const {
+    return size_.load(std::memory_order_acquire);
+}
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <vector>
+#include <grpcpp/grpcpp.h>
 #include "messages/price_update.pb.h"
 
 // Mock implementation that mimics grpc::ServerWriter<T> interface
@@ -53,3 +54,4 @@ private:
 };
 
 using MockGrpcWriter = MockServerWriter<internal::PriceUpdate>;
+using MockGrpcBatchWriter = MockServerWriter<internal::PriceUpdateBatch>;
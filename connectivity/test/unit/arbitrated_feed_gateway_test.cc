@@ -0,0 +1,211 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include "arbitrated_feed_gateway.h"
+
+namespace {
+
+// a line driven by the test through the OnPoint of the gateway
+class IdleLine : public FeedGateway {
+public:
+  std::string Name() const override { return "idle"; }
+
+  void Start(FeedSink &sink, std::size_t feed) override {
+    sink_ = &sink;
+    feed_ = feed;
+    running_ = true;
+  }
+
+  void Stop() override {
+    if (running_) {
+      running_ = false;
+      sink_->OnFeedClosed(feed_);
+    }
+  }
+
+  bool IsRunning() const override { return running_; }
+
+private:
+  FeedSink *sink_ = nullptr;
+  std::size_t feed_ = 0;
+  bool running_ = false;
+};
+
+class RecordingSink : public FeedSink {
+public:
+  void OnPoint(std::size_t feed, const MarketDataPoint &point,
+               uint64_t sequence) override {
+    feeds.push_back(feed);
+    prices.push_back(point.price);
+    sequences.push_back(sequence);
+  }
+
+  void OnFeedClosed(std::size_t feed) override { closed.push_back(feed); }
+
+  std::vector<std::size_t> feeds;
+  std::vector<double> prices;
+  std::vector<uint64_t> sequences;
+  std::vector<std::size_t> closed;
+};
+
+MarketDataPoint Point(double price) {
+  MarketDataPoint point;
+  point.set_instrument_id("AB");
+  point.price = price;
+  return point;
+}
+
+constexpr std::size_t kA = ArbitratedFeedGateway::kLineA;
+constexpr std::size_t kB = ArbitratedFeedGateway::kLineB;
+
+} // namespace
+
+class ArbitratedFeedGatewayTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    gateway_ = std::make_unique<ArbitratedFeedGateway>(
+        std::make_unique<IdleLine>(), std::make_unique<IdleLine>(),
+        std::chrono::milliseconds(20));
+    gateway_->Start(sink_, 5);
+  }
+
+  RecordingSink sink_;
+  std::unique_ptr<ArbitratedFeedGateway> gateway_;
+};
+
+TEST_F(ArbitratedFeedGatewayTest, FirstCopyWins) {
+  gateway_->OnPoint(kA, Point(1), 1);
+  gateway_->OnPoint(kB, Point(1), 1);
+  gateway_->OnPoint(kB, Point(2), 2);
+  gateway_->OnPoint(kA, Point(2), 2);
+  gateway_->OnPoint(kA, Point(3), 3);
+
+  EXPECT_EQ(sink_.sequences, (std::vector<uint64_t>{1, 2, 3}));
+  EXPECT_EQ(sink_.feeds, (std::vector<std::size_t>{5, 5, 5}));
+  EXPECT_EQ(gateway_->WonCount(kA), 2u);
+  EXPECT_EQ(gateway_->WonCount(kB), 1u);
+  EXPECT_EQ(gateway_->DuplicateCount(kA), 1u);
+  EXPECT_EQ(gateway_->DuplicateCount(kB), 1u);
+  // B only won a race
+  EXPECT_EQ(gateway_->FailoverCount(), 0u);
+}
+
+TEST_F(ArbitratedFeedGatewayTest, SlowerLineFillsWhatTheFasterOneSkipped) {
+  for (uint64_t sequence = 120; sequence < 125; ++sequence) {
+    gateway_->OnPoint(kA, Point(sequence), sequence);
+    gateway_->OnPoint(kB, Point(sequence), sequence);
+  }
+  // A reconnects and resumes ahead of B
+  gateway_->OnFeedSession(kA);
+  gateway_->OnPoint(kA, Point(130), 130);
+  gateway_->OnPoint(kA, Point(131), 131);
+  for (uint64_t sequence = 125; sequence < 132; ++sequence) {
+    gateway_->OnPoint(kB, Point(sequence), sequence);
+  }
+
+  EXPECT_EQ(sink_.sequences,
+            (std::vector<uint64_t>{120, 121, 122, 123, 124, 130, 131, 125,
+                                   126, 127, 128, 129}));
+  EXPECT_EQ(gateway_->WonCount(kB), 5u);
+  EXPECT_EQ(gateway_->DuplicateCount(kB), 7u);
+  EXPECT_EQ(gateway_->GapCount(), 0u);
+}
+
+TEST_F(ArbitratedFeedGatewayTest, CountsSequencesNeitherLineSent) {
+  gateway_->OnPoint(kA, Point(1), 1);
+  gateway_->OnPoint(kB, Point(4), 4);
+  gateway_->OnPoint(kA, Point(2), 2);
+  EXPECT_EQ(sink_.sequences, (std::vector<uint64_t>{1, 4, 2}));
+  EXPECT_EQ(gateway_->GapCount(), 0u);
+
+  // 3 leaves the window, too late to come in
+  const uint64_t newest = 4 + ArbitratedFeedGateway::kSequenceWindow;
+  gateway_->OnPoint(kB, Point(newest), newest);
+  gateway_->OnPoint(kA, Point(3), 3);
+
+  EXPECT_EQ(sink_.sequences.back(), newest);
+  EXPECT_EQ(gateway_->GapCount(), 1u);
+  EXPECT_EQ(gateway_->DuplicateCount(kA), 1u);
+}
+
+TEST_F(ArbitratedFeedGatewayTest, RestartedNumberingIsTaken) {
+  for (uint64_t sequence = 1; sequence < 4; ++sequence) {
+    gateway_->OnPoint(kA, Point(sequence), sequence);
+    gateway_->OnPoint(kB, Point(sequence), sequence);
+  }
+
+  // A goes back, the feed numbers from 1 again
+  gateway_->OnPoint(kA, Point(10), 1);
+  // what B still had of the old numbering
+  gateway_->OnPoint(kB, Point(4), 4);
+  // B follows
+  gateway_->OnPoint(kB, Point(10), 1);
+  gateway_->OnPoint(kB, Point(11), 2);
+  gateway_->OnPoint(kA, Point(11), 2);
+
+  EXPECT_EQ(sink_.sequences, (std::vector<uint64_t>{1, 2, 3, 1, 2}));
+  EXPECT_EQ(sink_.prices, (std::vector<double>{1, 2, 3, 10, 11}));
+  EXPECT_EQ(gateway_->DuplicateCount(kB), 5u);
+}
+
+TEST_F(ArbitratedFeedGatewayTest, ReconnectedLineFollowsTheNewNumbering) {
+  gateway_->OnPoint(kA, Point(1), 100);
+  gateway_->OnPoint(kB, Point(1), 100);
+  gateway_->OnPoint(kA, Point(2), 1);
+
+  // B was down while the feed restarted, it comes back further on
+  gateway_->OnPoint(kB, Point(3), 101);
+  gateway_->OnFeedSession(kB);
+  gateway_->OnPoint(kB, Point(4), 2);
+  gateway_->OnPoint(kA, Point(4), 2);
+
+  EXPECT_EQ(sink_.sequences, (std::vector<uint64_t>{100, 1, 2}));
+  EXPECT_EQ(gateway_->WonCount(kB), 1u);
+}
+
+TEST_F(ArbitratedFeedGatewayTest, StalledLineFailsOver) {
+  gateway_->OnPoint(kA, Point(1), 1);
+  std::this_thread::sleep_for(std::chrono::milliseconds(30));
+  gateway_->OnPoint(kB, Point(2), 2);
+
+  EXPECT_EQ(gateway_->FailoverCount(), 1u);
+  EXPECT_EQ(gateway_->ActiveLine(), kB);
+}
+
+TEST_F(ArbitratedFeedGatewayTest, UnnumberedPointsFollowTheActiveLine) {
+  gateway_->OnPoint(kA, Point(1), kNoSequence);
+  gateway_->OnPoint(kB, Point(1), kNoSequence);
+  EXPECT_EQ(gateway_->DuplicateCount(kB), 1u);
+
+  // A goes quiet, B takes over and A is now the standby
+  std::this_thread::sleep_for(std::chrono::milliseconds(30));
+  gateway_->OnPoint(kB, Point(2), kNoSequence);
+  gateway_->OnPoint(kA, Point(2), kNoSequence);
+
+  EXPECT_EQ(sink_.prices, (std::vector<double>{1, 2}));
+  EXPECT_EQ(gateway_->ActiveLine(), kB);
+  EXPECT_EQ(gateway_->FailoverCount(), 1u);
+  EXPECT_EQ(gateway_->DuplicateCount(kA), 1u);
+}
+
+TEST_F(ArbitratedFeedGatewayTest, ClosedLineFailsOverAtOnce) {
+  gateway_->OnPoint(kA, Point(1), kNoSequence);
+  gateway_->OnFeedClosed(kA);
+  gateway_->OnPoint(kB, Point(2), kNoSequence);
+
+  EXPECT_EQ(sink_.prices, (std::vector<double>{1, 2}));
+  EXPECT_EQ(gateway_->FailoverCount(), 1u);
+  // the feed goes on with one line
+  EXPECT_TRUE(sink_.closed.empty());
+  EXPECT_TRUE(gateway_->IsRunning());
+}
+
+TEST_F(ArbitratedFeedGatewayTest, ClosesWithBothLines) {
+  gateway_->Stop();
+
+  EXPECT_EQ(sink_.closed, std::vector<std::size_t>{5});
+  EXPECT_FALSE(gateway_->IsRunning());
+}
@@ -0,0 +1,110 @@
+#include <gtest/gtest.h>
+#include <memory>
+#include "broadcast_ring.h"
+#include "market_data_subscription.h"
+
+namespace {
+
+MarketDataPoint MakePoint(const char *instrument_id, double price) {
+  MarketDataPoint point;
+  point.price = price;
+  point.set_instrument_id(instrument_id);
+  return point;
+}
+
+} // namespace
+
+TEST(BroadcastRingTest, CapacityIsAPowerOf2) {
+  EXPECT_EQ(BroadcastRing(1000).Capacity(), 1024u);
+  EXPECT_EQ(BroadcastRing(1024).Capacity(), 1024u);
+}
+
+TEST(BroadcastRingTest, EveryReaderGetsEveryPoint) {
+  auto ring = std::make_shared<BroadcastRing>(16);
+  BroadcastReader first(ring);
+  BroadcastReader second(ring);
+  MarketDataPoint point;
+
+  EXPECT_FALSE(first.Poll(point));
+
+  ring->Publish(MakePoint("AAPL", 1.5));
+  ring->Publish(MakePoint("MSFT", 2.5));
+
+  for (auto *reader : {&first, &second}) {
+    ASSERT_TRUE(reader->Poll(point));
+    EXPECT_DOUBLE_EQ(point.price, 1.5);
+    ASSERT_TRUE(reader->Poll(point));
+    EXPECT_EQ(point.instrument_id(), "MSFT");
+    EXPECT_FALSE(reader->Poll(point));
+  }
+}
+
+TEST(BroadcastRingTest, ReadingStartsAtTheNextPoint) {
+  auto ring = std::make_shared<BroadcastRing>(16);
+  ring->Publish(MakePoint("AAPL", 1.5));
+
+  BroadcastReader reader(ring);
+  MarketDataPoint point;
+  EXPECT_FALSE(reader.Poll(point));
+
+  ring->Publish(MakePoint("AAPL", 2.5));
+  ASSERT_TRUE(reader.Poll(point));
+  EXPECT_DOUBLE_EQ(point.price, 2.5);
+}
+
+TEST(BroadcastRingTest, LagCountsUnreadPoints) {
+  auto ring = std::make_shared<BroadcastRing>(16);
+  BroadcastReader reader(ring);
+
+  for (int i = 0; i < 5; ++i) {
+    ring->Publish(MakePoint("AAPL", i));
+  }
+  EXPECT_EQ(reader.Lag(), 5u);
+
+  MarketDataPoint point;
+  reader.Poll(point);
+  EXPECT_EQ(reader.Lag(), 4u);
+}
+
+TEST(BroadcastRingTest, LappedReaderGoesOnFromTheOldestPoint) {
+  auto ring = std::make_shared<BroadcastRing>(16);
+  BroadcastReader reader(ring);
+
+  for (int i = 0; i < 20; ++i) {
+    ring->Publish(MakePoint("AAPL", i));
+  }
+
+  // 0 to 3 were overwritten, 4 to 19 are still there
+  MarketDataPoint point;
+  ASSERT_TRUE(reader.Poll(point));
+  EXPECT_DOUBLE_EQ(point.price, 4);
+  EXPECT_EQ(reader.LostCount(), 4u);
+  EXPECT_EQ(reader.Lag(), 15u);
+
+  int read = 1;
+  while (reader.Poll(point)) {
+    ++read;
+  }
+  EXPECT_EQ(read, 16);
+  EXPECT_DOUBLE_EQ(point.price, 19);
+}
+
+TEST(BroadcastRingTest, SubscriptionSkipsOtherInstruments) {
+  auto ring = std::make_shared<BroadcastRing>(16);
+  MarketDataSubscription subscription(ring);
+  subscription.SetInstruments({"MSFT"});
+
+  ring->Publish(MakePoint("AAPL", 1.5));
+  EXPECT_FALSE(subscription.HasPending());
+
+  // the gateway pushes the points of the subscription
+  ring->Publish(MakePoint("MSFT", 2.5));
+  subscription.Push(ring->Published() - 1);
+  EXPECT_TRUE(subscription.HasPending());
+
+  MarketDataPoint point;
+  ASSERT_TRUE(subscription.Poll(point));
+  EXPECT_EQ(point.instrument_id(), "MSFT");
+  EXPECT_FALSE(subscription.HasPending());
+  EXPECT_FALSE(subscription.Poll(point));
+}
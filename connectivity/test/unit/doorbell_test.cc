@@ -0,0 +1,68 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include <thread>
+#include "doorbell.h"
+
+using namespace std::chrono;
+
+TEST(DoorbellTest, RingCounts) {
+  Doorbell doorbell;
+  EXPECT_EQ(doorbell.Rings(), 0u);
+
+  doorbell.Ring();
+  doorbell.Ring();
+  EXPECT_EQ(doorbell.Rings(), 2u);
+}
+
+TEST(DoorbellTest, WaitReturnsAtOnceAfterARing) {
+  Doorbell doorbell;
+  const uint64_t seen = doorbell.Rings();
+  doorbell.Ring();
+
+  const auto start = steady_clock::now();
+  EXPECT_TRUE(doorbell.Wait(seen, nanoseconds(0), seconds(5)));
+  EXPECT_LT(steady_clock::now() - start, seconds(1));
+}
+
+TEST(DoorbellTest, WaitTimesOutWithoutRing) {
+  Doorbell doorbell;
+
+  EXPECT_FALSE(doorbell.Wait(doorbell.Rings(), microseconds(100),
+                             milliseconds(5)));
+}
+
+TEST(DoorbellTest, ParkedWaiterWakesUp) {
+  Doorbell doorbell;
+  const uint64_t seen = doorbell.Rings();
+
+  std::thread ringer([&doorbell] {
+    std::this_thread::sleep_for(milliseconds(5));
+    doorbell.Ring();
+  });
+
+  const auto start = steady_clock::now();
+  EXPECT_TRUE(doorbell.Wait(seen, nanoseconds(0), seconds(5)));
+  EXPECT_LT(steady_clock::now() - start, seconds(1));
+
+  ringer.join();
+}
+
+TEST(DoorbellTest, NoRingIsLost) {
+  Doorbell doorbell;
+  constexpr int kRings = 100000;
+
+  std::thread ringer([&doorbell] {
+    for (int i = 0; i < kRings; ++i) {
+      doorbell.Ring();
+    }
+  });
+
+  // every wait ends with a ring, never with the timeout
+  uint64_t seen = 0;
+  while (seen < kRings) {
+    ASSERT_TRUE(doorbell.Wait(seen, nanoseconds(0), seconds(5)));
+    seen = doorbell.Rings();
+  }
+
+  ringer.join();
+}
@@ -0,0 +1,108 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "feed_buffer.h"
+
+namespace {
+
+// what the socket reader does with one read
+void Write(FeedBuffer &feed, std::string_view bytes) {
+  char *data = feed.WriteData();
+  ASSERT_GE(feed.WriteSpace(), bytes.size());
+  std::memcpy(data, bytes.data(), bytes.size());
+  feed.Commit(bytes.size());
+}
+
+std::vector<std::string> Lines(FeedBuffer &feed) {
+  std::vector<std::string> lines;
+  std::string_view line;
+  while (feed.NextLine(line)) {
+    lines.emplace_back(line);
+  }
+  return lines;
+}
+
+} // namespace
+
+TEST(FeedBufferTest, LinesSplitAcrossReads) {
+  FeedBuffer feed(64);
+
+  Write(feed, "first\nsec");
+  EXPECT_EQ(Lines(feed), std::vector<std::string>{"first"});
+
+  Write(feed, "ond\n\nthird\n");
+  EXPECT_EQ(Lines(feed), (std::vector<std::string>{"second", "", "third"}));
+  EXPECT_TRUE(feed.Data().empty());
+}
+
+TEST(FeedBufferTest, PartialLineMovesToTheFront) {
+  FeedBuffer feed(16);
+
+  // 12 bytes read, the partial line starts at 10
+  Write(feed, "123456789\nab");
+  EXPECT_EQ(Lines(feed), std::vector<std::string>{"123456789"});
+
+  // less than half free at the back, the 2 bytes move
+  feed.WriteData();
+  EXPECT_EQ(feed.WriteSpace(), 14u);
+
+  Write(feed, "cdefghijklm\n");
+  EXPECT_EQ(Lines(feed), std::vector<std::string>{"abcdefghijklm"});
+}
+
+TEST(FeedBufferTest, LineLongerThanTheBufferIsDropped) {
+  FeedBuffer feed(8);
+
+  Write(feed, "12345678");
+  EXPECT_TRUE(Lines(feed).empty());
+  EXPECT_EQ(feed.DroppedLines(), 1u);
+
+  // the end of the long line, then a good one
+  Write(feed, "90\nok\n");
+  EXPECT_EQ(Lines(feed), std::vector<std::string>{"ok"});
+  EXPECT_EQ(feed.DroppedLines(), 1u);
+}
+
+TEST(FeedBufferTest, ConsumeKeepsTheRest) {
+  FeedBuffer feed(32);
+
+  Write(feed, "abcdef");
+  feed.Consume(4);
+  EXPECT_EQ(feed.Data(), "ef");
+
+  feed.Consume(2);
+  EXPECT_TRUE(feed.Data().empty());
+  // empty, the next read starts at the front
+  feed.WriteData();
+  EXPECT_EQ(feed.WriteSpace(), 32u);
+}
+
+TEST(FeedBufferTest, NeverHoldsMoreThanItsCapacity) {
+  FeedBuffer feed(64);
+  const std::string tick = "{\"price\": 1.5}\n";
+  std::size_t lines = 0;
+
+  // a burst read as fast as the buffer takes it
+  std::string burst;
+  for (int i = 0; i < 1000; ++i) {
+    burst += tick;
+  }
+
+  std::string_view rest(burst);
+  while (!rest.empty()) {
+    char *data = feed.WriteData();
+    const std::size_t n = std::min(feed.WriteSpace(), rest.size());
+    ASSERT_GT(n, 0u);
+    std::memcpy(data, rest.data(), n);
+    feed.Commit(n);
+    rest.remove_prefix(n);
+
+    lines += Lines(feed).size();
+  }
+
+  EXPECT_EQ(lines, 1000u);
+  EXPECT_EQ(feed.DroppedLines(), 0u);
+}
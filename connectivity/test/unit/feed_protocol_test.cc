@@ -0,0 +1,148 @@
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include "feed_protocol.h"
+
+namespace {
+
+// feed_protocol.encode_tick('AAPL', 1.5, 10, 1700000000123456789)
+const std::string kPythonRecord = std::string(
+    "\x20\x00\x04\x00"
+    "\x00\x00\x00\x00\x00\x00\xf8\x3f"
+    "\x0a\x00\x00\x00\x00\x00\x00\x00"
+    "\x15\xcd\x85\x3d\xfe\x9c\x97\x17"
+    "AAPL",
+    32);
+
+std::string Record(uint16_t length, const std::string &symbol,
+                   int64_t timestamp_ns) {
+  std::string record(length, '\0');
+  const uint8_t symbol_length = static_cast<uint8_t>(symbol.size());
+  const double price = 2.5;
+  const int64_t quantity = 7;
+
+  std::memcpy(&record[0], &length, sizeof(length));
+  std::memcpy(&record[2], &symbol_length, sizeof(symbol_length));
+  std::memcpy(&record[4], &price, sizeof(price));
+  std::memcpy(&record[12], &quantity, sizeof(quantity));
+  std::memcpy(&record[20], &timestamp_ns, sizeof(timestamp_ns));
+  std::memcpy(&record[kBinaryRecordHeaderSize], symbol.data(), symbol.size());
+  return record;
+}
+
+} // namespace
+
+TEST(FeedProtocolTest, DecodesPythonRecord) {
+  MarketDataPoint point;
+  std::size_t consumed = 0;
+
+  ASSERT_EQ(DecodeBinaryRecord(kPythonRecord.data(), kPythonRecord.size(),
+                               point, consumed),
+            DecodeStatus::Ok);
+
+  EXPECT_EQ(consumed, kPythonRecord.size());
+  EXPECT_EQ(point.instrument_id(), "AAPL");
+  EXPECT_DOUBLE_EQ(point.price, 1.5);
+  EXPECT_EQ(point.quantity, 10);
+  EXPECT_EQ(point.timestamp_seconds, 1700000000);
+  EXPECT_EQ(point.timestamp_nanos, 123456789);
+}
+
+TEST(FeedProtocolTest, PartialRecordNeedsMore) {
+  MarketDataPoint point;
+  std::size_t consumed = 0;
+
+  EXPECT_EQ(DecodeBinaryRecord(kPythonRecord.data(), 1, point, consumed),
+            DecodeStatus::NeedMore);
+  EXPECT_EQ(DecodeBinaryRecord(kPythonRecord.data(), kPythonRecord.size() - 1,
+                               point, consumed),
+            DecodeStatus::NeedMore);
+}
+
+TEST(FeedProtocolTest, ZeroTimestampIsStampedOnReceipt) {
+  const std::string record = Record(32, "MSFT", 0);
+  MarketDataPoint point;
+  std::size_t consumed = 0;
+
+  ASSERT_EQ(DecodeBinaryRecord(record.data(), record.size(), point, consumed),
+            DecodeStatus::Ok);
+  EXPECT_GT(point.timestamp_seconds, 1700000000);
+}
+
+TEST(FeedProtocolTest, LongerRecordIsSkippedWhole) {
+  // 8 bytes of a later version after the sequence
+  const std::string record = Record(48, "MSFT", 5) + Record(32, "AAPL", 5);
+  MarketDataPoint point;
+  std::size_t consumed = 0;
+
+  ASSERT_EQ(DecodeBinaryRecord(record.data(), record.size(), point, consumed),
+            DecodeStatus::Ok);
+  EXPECT_EQ(consumed, 48u);
+  EXPECT_EQ(point.instrument_id(), "MSFT");
+
+  ASSERT_EQ(DecodeBinaryRecord(record.data() + consumed,
+                               record.size() - consumed, point, consumed),
+            DecodeStatus::Ok);
+  EXPECT_EQ(point.instrument_id(), "AAPL");
+}
+
+TEST(FeedProtocolTest, DecodesSequence) {
+  std::string record = Record(40, "MSFT", 5);
+  const uint64_t sent = 42;
+  std::memcpy(&record[32], &sent, sizeof(sent));
+  MarketDataPoint point;
+  std::size_t consumed = 0;
+  uint64_t sequence = 0;
+
+  ASSERT_EQ(DecodeBinaryRecord(record.data(), record.size(), point, consumed,
+                               sequence),
+            DecodeStatus::Ok);
+  EXPECT_EQ(sequence, 42u);
+
+  // a record of the older feeds has none
+  ASSERT_EQ(DecodeBinaryRecord(kPythonRecord.data(), kPythonRecord.size(),
+                               point, consumed, sequence),
+            DecodeStatus::Ok);
+  EXPECT_EQ(sequence, kNoSequence);
+}
+
+TEST(FeedProtocolTest, LongSymbolIsTruncated) {
+  const std::string symbol(40, 'X');
+  const std::string record =
+      Record(kBinaryRecordHeaderSize + symbol.size(), symbol, 5);
+  MarketDataPoint point;
+  std::size_t consumed = 0;
+
+  ASSERT_EQ(DecodeBinaryRecord(record.data(), record.size(), point, consumed),
+            DecodeStatus::Ok);
+  EXPECT_EQ(point.instrument_id().size(), SymbolTable::kMaxNameLength);
+}
+
+TEST(FeedProtocolTest, BrokenFramingIsInvalid) {
+  MarketDataPoint point;
+  std::size_t consumed = 0;
+
+  // json sent after the handshake
+  const std::string json_line = "{\"price\": 1.5}\n";
+  EXPECT_EQ(DecodeBinaryRecord(json_line.data(), json_line.size(), point,
+                               consumed),
+            DecodeStatus::Invalid);
+
+  // symbol past the end of the record
+  std::string record = Record(32, "AAPL", 5);
+  record[2] = 10;
+  EXPECT_EQ(DecodeBinaryRecord(record.data(), record.size(), point, consumed),
+            DecodeStatus::Invalid);
+}
+
+TEST(FeedProtocolTest, ParsesJsonTick) {
+  MarketDataPoint point;
+  ParseJsonTick(R"({"instrument_id": "AAPL", "price": 1.5, "quantity": 10})",
+                point);
+
+  EXPECT_EQ(point.instrument_id(), "AAPL");
+  EXPECT_DOUBLE_EQ(point.price, 1.5);
+  EXPECT_EQ(point.quantity, 10);
+  EXPECT_GT(point.timestamp_seconds, 0);
+}
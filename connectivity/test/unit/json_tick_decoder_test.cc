@@ -0,0 +1,97 @@
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+#include "feed_protocol.h"
+#include "json_tick_decoder.h"
+
+TEST(JsonTickDecoderTest, DecodesTick) {
+  MarketDataPoint point;
+
+  ASSERT_TRUE(DecodeJsonTick(
+      R"({"instrument_id": "AAPL", "price": 1.5, "quantity": 10})", point));
+
+  EXPECT_EQ(point.instrument_id(), "AAPL");
+  EXPECT_DOUBLE_EQ(point.price, 1.5);
+  EXPECT_EQ(point.quantity, 10);
+}
+
+TEST(JsonTickDecoderTest, AnyOrderAndWhitespace) {
+  MarketDataPoint point;
+
+  ASSERT_TRUE(DecodeJsonTick(
+      " {\"quantity\":-3 ,\t\"price\" :2e2,\"instrument_id\":\"MSFT\"}\r",
+      point));
+
+  EXPECT_EQ(point.instrument_id(), "MSFT");
+  EXPECT_DOUBLE_EQ(point.price, 200.0);
+  EXPECT_EQ(point.quantity, -3);
+}
+
+TEST(JsonTickDecoderTest, LongInstrumentIdIsTruncated) {
+  // longer than a 16 byte scan and than MarketDataPoint keeps
+  const std::string instrument_id(40, 'X');
+  MarketDataPoint point;
+
+  ASSERT_TRUE(DecodeJsonTick(
+      "{\"instrument_id\": \"" + instrument_id + "\", \"price\": 1}", point));
+
+  EXPECT_EQ(point.instrument_id().size(), SymbolTable::kMaxNameLength);
+}
+
+TEST(JsonTickDecoderTest, UnexpectedShapesAreLeftToNlohmann) {
+  const std::vector<std::string> lines = {
+      R"({"price": 1.5, "venue": "XNAS"})",
+      R"({"instrument_id": "A\u0041PL"})",
+      R"({"price": {"bid": 1.5}})",
+      R"({"price": true})",
+      R"({"price": nan})",
+      R"({"quantity": 10.5})",
+      R"({"instrument_id": 7})",
+      R"({"price": 1.5} trailing)",
+      R"({"price": 1.5)",
+      R"([1.5, 10])",
+      "",
+  };
+
+  for (const auto &line : lines) {
+    MarketDataPoint point;
+    point.price = 42.0;
+
+    EXPECT_FALSE(DecodeJsonTick(line, point)) << line;
+    // nothing written
+    EXPECT_DOUBLE_EQ(point.price, 42.0) << line;
+  }
+}
+
+TEST(JsonTickDecoderTest, AgreesWithNlohmann) {
+  const std::vector<std::string> lines = {
+      R"({"instrument_id": "AAPL", "price": 101.25, "quantity": 300})",
+      R"({"price": 0.1, "quantity": 0, "instrument_id": ""})",
+      R"({"price": -1.5E-3})",
+      R"({"quantity": 9223372036854775807})",
+      R"({})",
+  };
+
+  for (const auto &line : lines) {
+    MarketDataPoint fast;
+    MarketDataPoint dom;
+
+    ASSERT_TRUE(DecodeJsonTick(line, fast)) << line;
+    ParseJsonTickDom(line, dom);
+
+    EXPECT_EQ(fast.price, dom.price) << line;
+    EXPECT_EQ(fast.quantity, dom.quantity) << line;
+    EXPECT_EQ(fast.symbol_id, dom.symbol_id) << line;
+  }
+}
+
+TEST(JsonTickDecoderTest, ParseJsonTickFallsBack) {
+  MarketDataPoint point;
+
+  ParseJsonTick(R"({"instrument_id": "AAPL", "price": 1.5, "x": null})",
+                point);
+
+  EXPECT_EQ(point.instrument_id(), "AAPL");
+  EXPECT_DOUBLE_EQ(point.price, 1.5);
+  EXPECT_GT(point.timestamp_seconds, 0);
+}
@@ -0,0 +1,135 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <grpcpp/grpcpp.h>
+#include "services/market_data_callback_service.h"
+
+using namespace std::chrono;
+
+// the service runs behind a real in process server on the loopback
+// its gateway has no socket, the tests feed it with Broadcast
+class MarketDataCallbackServiceTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    gateway_ = std::make_shared<PythonApiGtw>();
+    service_ = std::make_unique<MarketDataCallbackService>(gateway_, 1);
+
+    int port = 0;
+    grpc::ServerBuilder builder;
+    builder.AddListeningPort("127.0.0.1:0", grpc::InsecureServerCredentials(),
+                             &port);
+    builder.RegisterService(service_.get());
+    server_ = builder.BuildAndStart();
+    ASSERT_NE(server_, nullptr);
+
+    stub_ = internal::MarketDataService::NewStub(
+        grpc::CreateChannel("127.0.0.1:" + std::to_string(port),
+                            grpc::InsecureChannelCredentials()));
+  }
+
+  void TearDown() override {
+    server_->Shutdown();
+    server_.reset();
+    service_.reset();
+  }
+
+  bool WaitForOpenStreams(std::size_t count) {
+    const auto deadline = steady_clock::now() + seconds(5);
+    while (service_->OpenStreams() != count) {
+      if (steady_clock::now() > deadline) {
+        return false;
+      }
+      std::this_thread::sleep_for(milliseconds(1));
+    }
+    return true;
+  }
+
+  void Broadcast(const char *instrument_id, double price) {
+    MarketDataPoint point;
+    point.price = price;
+    point.quantity = 10;
+    point.set_instrument_id(instrument_id);
+    gateway_->Broadcast(point);
+  }
+
+  std::shared_ptr<PythonApiGtw> gateway_;
+  std::unique_ptr<MarketDataCallbackService> service_;
+  std::unique_ptr<grpc::Server> server_;
+  std::unique_ptr<internal::MarketDataService::Stub> stub_;
+};
+
+TEST_F(MarketDataCallbackServiceTest, StreamPricesSendsRequestedInstruments) {
+  grpc::ClientContext context;
+  internal::MarketDataRequest request;
+  request.add_instrument_ids("AAPL");
+  auto reader = stub_->StreamPrices(&context, request);
+
+  ASSERT_TRUE(WaitForOpenStreams(1));
+  Broadcast("AAPL", 1.5);
+  Broadcast("MSFT", 2.5);
+  Broadcast("AAPL", 3.5);
+
+  internal::PriceUpdate update;
+  ASSERT_TRUE(reader->Read(&update));
+  EXPECT_EQ(update.instrument_id(), "AAPL");
+  EXPECT_DOUBLE_EQ(update.price(), 1.5);
+  ASSERT_TRUE(reader->Read(&update));
+  EXPECT_EQ(update.instrument_id(), "AAPL");
+  EXPECT_DOUBLE_EQ(update.price(), 3.5);
+
+  context.TryCancel();
+  reader->Finish();
+  EXPECT_TRUE(WaitForOpenStreams(0));
+}
+
+TEST_F(MarketDataCallbackServiceTest, StreamPriceBatchesSendsEveryPoint) {
+  constexpr int kPoints = 2000;
+
+  grpc::ClientContext context;
+  internal::MarketDataRequest request;
+  auto reader = stub_->StreamPriceBatches(&context, request);
+
+  ASSERT_TRUE(WaitForOpenStreams(1));
+
+  // spaced so the subscription queue never overflows
+  std::thread feed([this] {
+    for (int i = 0; i < kPoints; ++i) {
+      Broadcast("AAPL", i);
+      if (i % 256 == 255) {
+        std::this_thread::sleep_for(milliseconds(5));
+      }
+    }
+  });
+
+  internal::PriceUpdateBatch batch;
+  int received = 0;
+  while (received < kPoints && reader->Read(&batch)) {
+    for (const auto &update : batch.updates()) {
+      EXPECT_DOUBLE_EQ(update.price(), received);
+      ++received;
+    }
+  }
+  feed.join();
+  EXPECT_EQ(received, kPoints);
+
+  context.TryCancel();
+  reader->Finish();
+  EXPECT_TRUE(WaitForOpenStreams(0));
+}
+
+TEST_F(MarketDataCallbackServiceTest, CancelledIdleStreamIsDone) {
+  grpc::ClientContext context;
+  internal::MarketDataRequest request;
+  auto reader = stub_->StreamPriceBatches(&context, request);
+
+  ASSERT_TRUE(WaitForOpenStreams(1));
+
+  context.TryCancel();
+  EXPECT_EQ(reader->Finish().error_code(), grpc::StatusCode::CANCELLED);
+  EXPECT_TRUE(WaitForOpenStreams(0));
+
+  // nobody left to push to
+  Broadcast("AAPL", 1.5);
+}
@@ -1,11 +1,14 @@
 #include <gtest/gtest.h>
-#include <cstring>
 #include "market_data_point.h"
 
 TEST(MarketDataPointTest, IsTriviallyCopyable) {
   EXPECT_TRUE(std::is_trivially_copyable<MarketDataPoint>::value);
 }
 
+TEST(MarketDataPointTest, FitsHalfACacheLine) {
+  EXPECT_EQ(sizeof(MarketDataPoint), 32);
+}
+
 TEST(MarketDataPointTest, DefaultConstructor) {
   MarketDataPoint point;
 
@@ -13,7 +16,8 @@ TEST(MarketDataPointTest, DefaultConstructor) {
   EXPECT_EQ(point.quantity, 0);
   EXPECT_EQ(point.timestamp_seconds, 0);
   EXPECT_EQ(point.timestamp_nanos, 0);
-  EXPECT_EQ(point.instrument_id[0], '\0');
+  EXPECT_EQ(point.symbol_id, SymbolTable::kEmptyId);
+  EXPECT_EQ(point.instrument_id(), "");
 }
 
 TEST(MarketDataPointTest, SetInstrumentId) {
@@ -22,7 +26,7 @@ TEST(MarketDataPointTest, SetInstrumentId) {
 
   point.set_instrument_id(test_id);
 
-  EXPECT_STREQ(point.instrument_id, test_id);
+  EXPECT_EQ(point.instrument_id(), test_id);
 }
 
 TEST(MarketDataPointTest, InstrumentIdTruncation) {
@@ -31,18 +35,16 @@ TEST(MarketDataPointTest, InstrumentIdTruncation) {
 
   point.set_instrument_id(long_id);
 
-  EXPECT_EQ(std::strlen(point.instrument_id), 31);
-  EXPECT_EQ(point.instrument_id[31], '\0');
+  EXPECT_EQ(point.instrument_id(), std::string_view(long_id, 31));
 }
 
-TEST(MarketDataPointTest, InstrumentIdNullTermination) {
+TEST(MarketDataPointTest, InstrumentIdAtMaxLength) {
   MarketDataPoint point;
   const char* exact_31_chars = "1234567890123456789012345678901";
 
   point.set_instrument_id(exact_31_chars);
 
-  EXPECT_STREQ(point.instrument_id, exact_31_chars);
-  EXPECT_EQ(point.instrument_id[31], '\0');
+  EXPECT_EQ(point.instrument_id(), exact_31_chars);
 }
 
 TEST(MarketDataPointTest, SetAllFields) {
@@ -58,7 +60,7 @@ TEST(MarketDataPointTest, SetAllFields) {
   EXPECT_EQ(point.quantity, 100);
   EXPECT_EQ(point.timestamp_seconds, 1234567890);
   EXPECT_EQ(point.timestamp_nanos, 123456789);
-  EXPECT_STREQ(point.instrument_id, "GOOGL");
+  EXPECT_EQ(point.instrument_id(), "GOOGL");
 }
 
 TEST(MarketDataPointTest, CopyConstructor) {
@@ -71,5 +73,6 @@ TEST(MarketDataPointTest, CopyConstructor) {
 
   EXPECT_EQ(point2.price, 200.50);
   EXPECT_EQ(point2.quantity, 50);
-  EXPECT_STREQ(point2.instrument_id, "MSFT");
+  EXPECT_EQ(point2.instrument_id(), "MSFT");
+  EXPECT_EQ(point2.symbol_id, point1.symbol_id);
 }
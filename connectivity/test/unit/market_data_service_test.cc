@@ -1,4 +1,8 @@
 #include <gtest/gtest.h>
+#include <chrono>
+#include <thread>
+#include "mock_grpc_writer.h"
+#include "mock_server_context.h"
 #include "services/market_data_service.h"
 
 class MarketDataServiceTest : public ::testing::Test {
@@ -22,6 +26,171 @@ TEST_F(MarketDataServiceTest, ServiceInitializes) {
 // 1. A real Python gateway running on port 9000 (integration test)
 // 2. Refactoring PythonApiGtw to accept injected socket dependency
 //
-// Additionally, grpc::ServerWriter is marked 'final' so it cannot be mocked
-// via inheritance. Testing the streaming behavior requires refactoring
-// for dependency injection or integration testing.
+// The write loops behind StreamPrices and StreamPriceBatches take any
+// writer, so they are tested below with MockServerWriter
+
+namespace {
+
+MarketDataPoint MakePoint(const char *instrument_id, double price) {
+  MarketDataPoint point;
+  point.price = price;
+  point.quantity = 10;
+  point.timestamp_seconds = 1700000000;
+  point.timestamp_nanos = 42;
+  point.set_instrument_id(instrument_id);
+  return point;
+}
+
+// ends the subscription once max_writes messages were written
+// so the write loops return
+template <typename Mock>
+struct StoppingWriter {
+  Mock mock;
+  MarketDataSubscription *subscription;
+  size_t max_writes;
+
+  template <typename T>
+  bool Write(const T &message) {
+    const bool written = mock.Write(message);
+    if (mock.GetMessageCount() >= max_writes) {
+      subscription->active = false;
+    }
+    return written;
+  }
+};
+
+} // namespace
+
+TEST(MarketDataServiceWriteTest, WritePointsSendsOneMessagePerPoint) {
+  MockServerContext context;
+  auto ring = std::make_shared<BroadcastRing>(1024);
+  MarketDataSubscription subscription(ring);
+  ring->Publish(MakePoint("AAPL", 1.5));
+  ring->Publish(MakePoint("MSFT", 2.5));
+
+  StoppingWriter<MockGrpcWriter> writer{{}, &subscription, 2};
+  MarketDataService::WritePoints(&context, subscription, StreamOptions{},
+                                 &writer);
+
+  ASSERT_EQ(writer.mock.GetMessageCount(), 2u);
+  EXPECT_EQ(writer.mock.GetMessages()[0].instrument_id(), "AAPL");
+  EXPECT_EQ(writer.mock.GetMessages()[1].instrument_id(), "MSFT");
+  EXPECT_EQ(writer.mock.GetMessages()[1].timestamp().nanos(), 42);
+}
+
+TEST(MarketDataServiceWriteTest, WriteBatchesSendsPendingPointsTogether) {
+  MockServerContext context;
+  auto ring = std::make_shared<BroadcastRing>(1024);
+  MarketDataSubscription subscription(ring);
+  ring->Publish(MakePoint("AAPL", 1.5));
+  ring->Publish(MakePoint("MSFT", 2.5));
+  ring->Publish(MakePoint("AAPL", 3.5));
+
+  StoppingWriter<MockGrpcBatchWriter> writer{{}, &subscription, 1};
+  MarketDataService::WriteBatches(&context, subscription, StreamOptions{},
+                                  &writer);
+
+  ASSERT_EQ(writer.mock.GetMessageCount(), 1u);
+  const auto &batch = writer.mock.GetLastMessage();
+  ASSERT_EQ(batch.updates_size(), 3);
+  EXPECT_EQ(batch.updates(1).instrument_id(), "MSFT");
+  EXPECT_DOUBLE_EQ(batch.updates(2).price(), 3.5);
+  EXPECT_EQ(batch.updates(2).timestamp().seconds(), 1700000000);
+}
+
+TEST(MarketDataServiceWriteTest, WriteBatchesWaitsForLatePoints) {
+  MockServerContext context;
+  auto ring = std::make_shared<BroadcastRing>(1024);
+  MarketDataSubscription subscription(ring);
+  ring->Publish(MakePoint("AAPL", 1.5));
+
+  std::thread late_producer([&subscription, &ring] {
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    ring->Publish(MakePoint("AAPL", 2.5));
+    subscription.doorbell.Ring();
+  });
+
+  StreamOptions options;
+  options.max_batch_delay = std::chrono::milliseconds(100);
+
+  StoppingWriter<MockGrpcBatchWriter> writer{{}, &subscription, 1};
+  MarketDataService::WriteBatches(&context, subscription, options, &writer);
+  late_producer.join();
+
+  ASSERT_EQ(writer.mock.GetMessageCount(), 1u);
+  EXPECT_EQ(writer.mock.GetLastMessage().updates_size(), 2);
+}
+
+TEST(MarketDataServiceWriteTest, WriteBatchesStopsWhenTheClientLeaves) {
+  MockServerContext context;
+  auto ring = std::make_shared<BroadcastRing>(1024);
+  MarketDataSubscription subscription(ring);
+  ring->Publish(MakePoint("AAPL", 1.5));
+
+  MockGrpcBatchWriter writer;
+  writer.SetShouldFail(true);
+
+  // returns after the failed write even though the subscription is active
+  MarketDataService::WriteBatches(&context, subscription, StreamOptions{},
+                                  &writer);
+
+  EXPECT_EQ(writer.GetMessageCount(), 0u);
+  EXPECT_TRUE(subscription.active.load());
+}
+
+TEST(MarketDataServiceWriteTest, WritePointsWakesUpOnTheDoorbell) {
+  MockServerContext context;
+  auto ring = std::make_shared<BroadcastRing>(1024);
+  MarketDataSubscription subscription(ring);
+
+  std::thread producer([&subscription, &ring] {
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    ring->Publish(MakePoint("AAPL", 1.5));
+    subscription.doorbell.Ring();
+  });
+
+  StoppingWriter<MockGrpcWriter> writer{{}, &subscription, 1};
+  MarketDataService::WritePoints(&context, subscription, StreamOptions{},
+                                 &writer);
+  producer.join();
+
+  EXPECT_EQ(writer.mock.GetMessageCount(), 1u);
+}
+
+TEST(MarketDataServiceWriteTest, CloseEndsAnIdleStream) {
+  MockServerContext context;
+  auto ring = std::make_shared<BroadcastRing>(1024);
+  MarketDataSubscription subscription(ring);
+
+  std::thread closer([&subscription] {
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    subscription.Close();
+  });
+
+  MockGrpcWriter writer;
+  MarketDataService::WritePoints(&context, subscription, StreamOptions{},
+                                 &writer);
+  closer.join();
+
+  EXPECT_EQ(writer.GetMessageCount(), 0u);
+}
+
+TEST(MarketDataServiceWriteTest, SubscriptionOptionsFromRequest) {
+  internal::MarketDataRequest request;
+
+  const SubscriptionOptions defaults =
+      MarketDataService::SubscriptionOptionsFrom(request);
+  EXPECT_EQ(defaults.policy, BackpressurePolicy::DropNewest);
+  EXPECT_EQ(defaults.capacity, SubscriptionOptions::kDefaultCapacity);
+
+  request.set_backpressure(
+      internal::MarketDataRequest::CONFLATE_PER_INSTRUMENT);
+  request.set_queue_capacity(64);
+  request.set_block_timeout_us(250);
+
+  const SubscriptionOptions options =
+      MarketDataService::SubscriptionOptionsFrom(request);
+  EXPECT_EQ(options.policy, BackpressurePolicy::ConflatePerInstrument);
+  EXPECT_EQ(options.capacity, 64u);
+  EXPECT_EQ(options.block_timeout, std::chrono::microseconds(250));
+}
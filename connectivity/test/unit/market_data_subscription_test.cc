@@ -0,0 +1,171 @@
+#include <gtest/gtest.h>
+#include <memory>
+#include <vector>
+#include "market_data_subscription.h"
+
+namespace {
+
+MarketDataPoint MakePoint(const char *instrument_id, double price) {
+  MarketDataPoint point;
+  point.price = price;
+  point.set_instrument_id(instrument_id);
+  return point;
+}
+
+SubscriptionOptions Options(BackpressurePolicy policy, uint64_t capacity) {
+  SubscriptionOptions options;
+  options.policy = policy;
+  options.capacity = capacity;
+  return options;
+}
+
+// what the gateway does, ring holds the points of every instrument
+void Publish(BroadcastRing &ring, MarketDataSubscription &subscription,
+             const MarketDataPoint &point) {
+  ring.Publish(point);
+  if (!subscription.instrument_ids.empty() &&
+      subscription.Wants(point.symbol_id)) {
+    subscription.Push(ring.Published() - 1);
+  }
+}
+
+std::vector<double> Drain(MarketDataSubscription &subscription) {
+  std::vector<double> prices;
+  MarketDataPoint point;
+  while (subscription.Poll(point)) {
+    prices.push_back(point.price);
+  }
+  return prices;
+}
+
+} // namespace
+
+TEST(MarketDataSubscriptionTest, UnderCapacityNothingIsDropped) {
+  auto ring = std::make_shared<BroadcastRing>(64);
+  MarketDataSubscription subscription(
+      ring, Options(BackpressurePolicy::DropNewest, 4));
+
+  for (int i = 0; i < 4; ++i) {
+    ring->Publish(MakePoint("AAPL", i));
+  }
+
+  EXPECT_EQ(Drain(subscription), (std::vector<double>{0, 1, 2, 3}));
+  EXPECT_EQ(subscription.dropped.load(), 0u);
+}
+
+TEST(MarketDataSubscriptionTest, DropNewestKeepsTheOldest) {
+  auto ring = std::make_shared<BroadcastRing>(64);
+  MarketDataSubscription subscription(
+      ring, Options(BackpressurePolicy::DropNewest, 4));
+
+  for (int i = 0; i < 10; ++i) {
+    ring->Publish(MakePoint("AAPL", i));
+  }
+
+  EXPECT_EQ(Drain(subscription), (std::vector<double>{0, 1, 2, 3}));
+  EXPECT_EQ(subscription.dropped.load(), 6u);
+
+  // reading goes on once it caught up
+  ring->Publish(MakePoint("AAPL", 10));
+  EXPECT_EQ(Drain(subscription), (std::vector<double>{10}));
+}
+
+TEST(MarketDataSubscriptionTest, DropOldestKeepsTheNewest) {
+  auto ring = std::make_shared<BroadcastRing>(64);
+  MarketDataSubscription subscription(
+      ring, Options(BackpressurePolicy::DropOldest, 4));
+
+  for (int i = 0; i < 10; ++i) {
+    ring->Publish(MakePoint("AAPL", i));
+  }
+
+  EXPECT_EQ(Drain(subscription), (std::vector<double>{6, 7, 8, 9}));
+  EXPECT_EQ(subscription.dropped.load(), 6u);
+}
+
+TEST(MarketDataSubscriptionTest, DropsOnlyCountTheRequestedInstruments) {
+  auto ring = std::make_shared<BroadcastRing>(64);
+  MarketDataSubscription subscription(
+      ring, Options(BackpressurePolicy::DropOldest, 4));
+  subscription.SetInstruments({"MSFT"});
+
+  for (int i = 0; i < 10; ++i) {
+    Publish(*ring, subscription, MakePoint(i % 2 == 0 ? "MSFT" : "AAPL", i));
+  }
+
+  // 5 points of MSFT, one more than the capacity
+  EXPECT_EQ(Drain(subscription), (std::vector<double>{2, 4, 6, 8}));
+  EXPECT_EQ(subscription.dropped.load(), 1u);
+}
+
+TEST(MarketDataSubscriptionTest, LagOnlyCountsTheRequestedInstruments) {
+  auto ring = std::make_shared<BroadcastRing>(64);
+  MarketDataSubscription subscription(
+      ring, Options(BackpressurePolicy::DropNewest, 4));
+  subscription.SetInstruments({"MSFT"});
+
+  for (int i = 0; i < 40; ++i) {
+    Publish(*ring, subscription, MakePoint("AAPL", i));
+  }
+  Publish(*ring, subscription, MakePoint("MSFT", 40));
+
+  EXPECT_EQ(subscription.Lag(), 1u);
+  EXPECT_TRUE(subscription.HasPending());
+  EXPECT_EQ(Drain(subscription), (std::vector<double>{40}));
+  EXPECT_EQ(subscription.dropped.load(), 0u);
+  EXPECT_FALSE(subscription.HasPending());
+}
+
+TEST(MarketDataSubscriptionTest, LappedSubscriptionOnlyLosesItsOwnPoints) {
+  auto ring = std::make_shared<BroadcastRing>(16);
+  MarketDataSubscription subscription(
+      ring, Options(BackpressurePolicy::DropOldest, 4));
+  subscription.SetInstruments({"MSFT"});
+
+  // the ring laps MSFT 0, MSFT 9 and 20 are still there
+  Publish(*ring, subscription, MakePoint("MSFT", 0));
+  for (int i = 1; i < 20; ++i) {
+    Publish(*ring, subscription, MakePoint(i == 9 ? "MSFT" : "AAPL", i));
+  }
+  Publish(*ring, subscription, MakePoint("MSFT", 20));
+
+  EXPECT_EQ(Drain(subscription), (std::vector<double>{9, 20}));
+  EXPECT_EQ(subscription.LostCount(), 1u);
+  EXPECT_EQ(subscription.dropped.load(), 0u);
+}
+
+TEST(MarketDataSubscriptionTest, ConflateKeepsTheLatestOfEachInstrument) {
+  auto ring = std::make_shared<BroadcastRing>(64);
+  MarketDataSubscription subscription(
+      ring, Options(BackpressurePolicy::ConflatePerInstrument, 2));
+
+  ring->Publish(MakePoint("AAPL", 1));
+  ring->Publish(MakePoint("MSFT", 2));
+  ring->Publish(MakePoint("AAPL", 3));
+  ring->Publish(MakePoint("GOOG", 4));
+  ring->Publish(MakePoint("AAPL", 5));
+
+  EXPECT_TRUE(subscription.HasPending());
+  EXPECT_EQ(Drain(subscription), (std::vector<double>{5, 2, 4}));
+  EXPECT_EQ(subscription.dropped.load(), 2u);
+  EXPECT_FALSE(subscription.HasPending());
+
+  ring->Publish(MakePoint("AAPL", 6));
+  EXPECT_EQ(Drain(subscription), (std::vector<double>{6}));
+}
+
+TEST(MarketDataSubscriptionTest, BlockAndDisconnectLeaveTheBacklog) {
+  auto ring = std::make_shared<BroadcastRing>(64);
+  // Broadcast enforces those, a reader past its timeout drops the oldest
+  MarketDataSubscription blocking(
+      ring, Options(BackpressurePolicy::BlockWithTimeout, 4));
+  MarketDataSubscription disconnecting(
+      ring, Options(BackpressurePolicy::DisconnectSlowConsumer, 4));
+
+  for (int i = 0; i < 6; ++i) {
+    ring->Publish(MakePoint("AAPL", i));
+  }
+
+  EXPECT_EQ(Drain(blocking), (std::vector<double>{2, 3, 4, 5}));
+  EXPECT_EQ(Drain(disconnecting).size(), 6u);
+}
@@ -1,6 +1,67 @@
 #include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
 #include "python_api_gtw.h"
 
+namespace {
+
+// hands its points to the gateway from its own thread, then closes
+// or waits for Stop()
+class ScriptedFeed : public FeedGateway {
+public:
+  ScriptedFeed(std::vector<MarketDataPoint> points, bool close_at_end)
+      : points_(std::move(points)), close_at_end_(close_at_end) {}
+  ~ScriptedFeed() override { Stop(); }
+
+  std::string Name() const override { return "scripted"; }
+
+  void Start(FeedSink &sink, std::size_t feed) override {
+    running_.store(true);
+    thread_ = std::thread([this, &sink, feed] {
+      for (const auto &point : points_) {
+        sink.OnPoint(feed, point, kNoSequence);
+      }
+      while (!close_at_end_ && !stop_.load()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      }
+      running_.store(false);
+      sink.OnFeedClosed(feed);
+    });
+  }
+
+  void Stop() override {
+    stop_.store(true);
+    if (thread_.joinable()) {
+      thread_.join();
+    }
+  }
+
+  bool IsRunning() const override { return running_.load(); }
+
+private:
+  std::vector<MarketDataPoint> points_;
+  const bool close_at_end_;
+  std::atomic<bool> stop_{false};
+  std::atomic<bool> running_{false};
+  std::thread thread_;
+};
+
+MarketDataPoint Point(const char *instrument, double price,
+                      int64_t timestamp_seconds = 0) {
+  MarketDataPoint point;
+  point.set_instrument_id(instrument);
+  point.price = price;
+  point.timestamp_seconds = timestamp_seconds;
+  return point;
+}
+
+} // namespace
+
 class PythonApiGtwTest : public ::testing::Test {
 protected:
   void SetUp() override {
@@ -52,6 +113,265 @@ TEST_F(PythonApiGtwTest, DestructorCleansUp) {
   SUCCEED();
 }
 
-// Note: Testing Start() and actual streaming requires either:
-// 1. A real Python gateway running on port 9000
-// 2. Refactoring to inject the socket/transport layer
+// the socket of the python feed is tested in socket_feed_gateway_test
+
+TEST_F(PythonApiGtwTest, FeedsPublishOneStream) {
+  constexpr int kPoints = 1000;
+  std::vector<MarketDataPoint> first;
+  std::vector<MarketDataPoint> second;
+  for (int i = 0; i < kPoints; ++i) {
+    first.push_back(Point("FEED_A", i));
+    second.push_back(Point("FEED_B", i));
+  }
+
+  SubscriptionOptions options;
+  options.capacity = 4 * kPoints;
+  auto subscription = gateway_->Subscribe({}, {}, options);
+  gateway_->AddFeed(std::make_unique<ScriptedFeed>(first, true));
+  gateway_->AddFeed(std::make_unique<ScriptedFeed>(second, true));
+  gateway_->Start();
+
+  // the subscription ends with the last feed
+  while (subscription->active.load()) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  EXPECT_FALSE(gateway_->IsRunning());
+
+  // interleaved, each instrument in the order of its feed
+  double next_a = 0;
+  double next_b = 0;
+  MarketDataPoint point;
+  while (subscription->Poll(point)) {
+    double &next = point.instrument_id() == "FEED_A" ? next_a : next_b;
+    EXPECT_EQ(point.price, next);
+    next = point.price + 1;
+  }
+  EXPECT_EQ(next_a, kPoints);
+  EXPECT_EQ(next_b, kPoints);
+  EXPECT_EQ(gateway_->PublishedCount(0), kPoints);
+  EXPECT_EQ(gateway_->PublishedCount(1), kPoints);
+
+  gateway_->Unsubscribe(subscription);
+}
+
+TEST_F(PythonApiGtwTest, SubscriptionsEndWithTheLastFeed) {
+  gateway_->AddFeed(std::make_unique<ScriptedFeed>(
+      std::vector<MarketDataPoint>{}, true));
+  gateway_->AddFeed(std::make_unique<ScriptedFeed>(
+      std::vector<MarketDataPoint>{}, false));
+  auto subscription = gateway_->Subscribe();
+  gateway_->Start();
+
+  // the first feed is gone, the second one still runs
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  EXPECT_TRUE(gateway_->IsRunning());
+  EXPECT_TRUE(subscription->active.load());
+
+  gateway_.reset();
+  EXPECT_FALSE(subscription->active.load());
+}
+
+TEST_F(PythonApiGtwTest, FeedPriorityKeepsTheFirstFeed) {
+  gateway_->AddFeed(std::make_unique<ScriptedFeed>(
+      std::vector<MarketDataPoint>{}, false));
+  gateway_->AddFeed(std::make_unique<ScriptedFeed>(
+      std::vector<MarketDataPoint>{}, false));
+  gateway_->SetConflictRule(FeedConflictRule::FeedPriority);
+  auto subscription = gateway_->Subscribe();
+
+  // the second feed has it until the first one sends it
+  gateway_->OnPoint(1, Point("PRIORITY", 1), kNoSequence);
+  gateway_->OnPoint(0, Point("PRIORITY", 2), kNoSequence);
+  gateway_->OnPoint(1, Point("PRIORITY", 3), kNoSequence);
+  gateway_->OnPoint(1, Point("PRIORITY_OTHER", 4), kNoSequence);
+
+  MarketDataPoint point;
+  std::vector<double> prices;
+  while (subscription->Poll(point)) {
+    prices.push_back(point.price);
+  }
+  EXPECT_EQ(prices, (std::vector<double>{1, 2, 4}));
+  EXPECT_EQ(gateway_->ConflictCount(0), 0u);
+  EXPECT_EQ(gateway_->ConflictCount(1), 1u);
+
+  // and gets it back once the first feed closes
+  gateway_->OnFeedClosed(0);
+  gateway_->OnPoint(1, Point("PRIORITY", 5), kNoSequence);
+  ASSERT_TRUE(subscription->Poll(point));
+  EXPECT_EQ(point.price, 5);
+
+  gateway_->Unsubscribe(subscription);
+}
+
+TEST_F(PythonApiGtwTest, NewestTimestampDropsOlderPoints) {
+  gateway_->AddFeed(std::make_unique<ScriptedFeed>(
+      std::vector<MarketDataPoint>{}, false));
+  gateway_->AddFeed(std::make_unique<ScriptedFeed>(
+      std::vector<MarketDataPoint>{}, false));
+  gateway_->SetConflictRule(FeedConflictRule::NewestTimestamp);
+  auto subscription = gateway_->Subscribe();
+
+  gateway_->OnPoint(0, Point("NEWEST", 1, 100), kNoSequence);
+  gateway_->OnPoint(1, Point("NEWEST", 2, 99), kNoSequence);
+  gateway_->OnPoint(1, Point("NEWEST", 3, 101), kNoSequence);
+  gateway_->OnPoint(0, Point("NEWEST", 4, 100), kNoSequence);
+  // another instrument has its own time
+  gateway_->OnPoint(0, Point("NEWEST_OTHER", 5, 50), kNoSequence);
+
+  MarketDataPoint point;
+  std::vector<double> prices;
+  while (subscription->Poll(point)) {
+    prices.push_back(point.price);
+  }
+  EXPECT_EQ(prices, (std::vector<double>{1, 3, 5}));
+  EXPECT_EQ(gateway_->ConflictCount(0), 1u);
+  EXPECT_EQ(gateway_->ConflictCount(1), 1u);
+
+  gateway_->Unsubscribe(subscription);
+}
+
+TEST_F(PythonApiGtwTest, SubscribeWithInstruments) {
+  auto all = gateway_->Subscribe();
+  auto filtered = gateway_->Subscribe({"AAPL", "MSFT"});
+
+  EXPECT_TRUE(all->instrument_ids.empty());
+  ASSERT_EQ(filtered->instrument_ids.size(), 2);
+  EXPECT_EQ(filtered->instrument_ids[0], "AAPL");
+  EXPECT_EQ(filtered->instrument_ids[1], "MSFT");
+
+  gateway_->Unsubscribe(filtered);
+  gateway_->Unsubscribe(all);
+}
+
+TEST_F(PythonApiGtwTest, BroadcastRoutesBySymbol) {
+  auto all = gateway_->Subscribe();
+  // not interned by any point yet
+  auto filtered = gateway_->Subscribe({"ROUTED_ONLY"});
+
+  MarketDataPoint routed;
+  routed.set_instrument_id("ROUTED_ONLY");
+  MarketDataPoint other;
+  other.set_instrument_id("NOT_ROUTED");
+
+  gateway_->Broadcast(other);
+  gateway_->Broadcast(routed);
+
+  // only the subscription of the instrument is woken
+  EXPECT_EQ(filtered->doorbell.Rings(), 1u);
+  EXPECT_EQ(all->doorbell.Rings(), 2u);
+
+  MarketDataPoint point;
+  ASSERT_TRUE(filtered->Poll(point));
+  EXPECT_EQ(point.instrument_id(), "ROUTED_ONLY");
+  EXPECT_FALSE(filtered->Poll(point));
+  EXPECT_EQ(all->reader.Lag(), 2u);
+
+  gateway_->Unsubscribe(filtered);
+  gateway_->Unsubscribe(all);
+}
+
+TEST_F(PythonApiGtwTest, EveryPointIsWrittenOnce) {
+  std::vector<std::shared_ptr<MarketDataSubscription>> subscriptions;
+  for (int i = 0; i < 100; ++i) {
+    subscriptions.push_back(gateway_->Subscribe());
+  }
+
+  MarketDataPoint point;
+  point.price = 1.5;
+  gateway_->Broadcast(point);
+
+  // one ring for all of them
+  const BroadcastRing &ring = subscriptions[0]->reader.Ring();
+  EXPECT_EQ(ring.Published(), 1u);
+  for (auto &subscription : subscriptions) {
+    EXPECT_EQ(&subscription->reader.Ring(), &ring);
+    ASSERT_TRUE(subscription->Poll(point));
+    EXPECT_DOUBLE_EQ(point.price, 1.5);
+    gateway_->Unsubscribe(subscription);
+  }
+}
+
+TEST_F(PythonApiGtwTest, CapacityIsBoundedByTheRing) {
+  PythonApiGtw gateway(16);
+  SubscriptionOptions options;
+  options.capacity = 1000;
+
+  auto subscription = gateway.Subscribe({}, {}, options);
+
+  EXPECT_EQ(subscription->options.capacity, 8u);
+  gateway.Unsubscribe(subscription);
+}
+
+TEST_F(PythonApiGtwTest, SlowConsumerIsDisconnected) {
+  SubscriptionOptions options;
+  options.policy = BackpressurePolicy::DisconnectSlowConsumer;
+  options.capacity = 2;
+  auto slow = gateway_->Subscribe({}, {}, options);
+  auto other = gateway_->Subscribe();
+
+  MarketDataPoint point;
+  for (int i = 0; i < 3; ++i) {
+    gateway_->Broadcast(point);
+  }
+
+  EXPECT_TRUE(slow->disconnected.load());
+  EXPECT_FALSE(slow->active.load());
+  EXPECT_EQ(slow->max_lag.load(), 3u);
+  EXPECT_TRUE(other->active.load());
+
+  gateway_->Unsubscribe(other);
+  gateway_->Unsubscribe(slow);
+}
+
+TEST_F(PythonApiGtwTest, QuietInstrumentDoesNotLagBehindABusyOne) {
+  SubscriptionOptions options;
+  options.policy = BackpressurePolicy::DropNewest;
+  auto dropping = gateway_->Subscribe({"QUIET"}, {}, options);
+  options.policy = BackpressurePolicy::DisconnectSlowConsumer;
+  auto disconnecting = gateway_->Subscribe({"QUIET"}, {}, options);
+
+  // twice the capacity of points of another instrument
+  for (int i = 0; i < 2048; ++i) {
+    gateway_->Broadcast(Point("BUSY", i));
+  }
+  gateway_->Broadcast(Point("QUIET", 1.5));
+
+  EXPECT_EQ(dropping->Lag(), 1u);
+  EXPECT_TRUE(disconnecting->active.load());
+  EXPECT_EQ(disconnecting->max_lag.load(), 1u);
+
+  MarketDataPoint point;
+  for (auto &subscription : {dropping, disconnecting}) {
+    ASSERT_TRUE(subscription->Poll(point));
+    EXPECT_EQ(point.instrument_id(), "QUIET");
+    EXPECT_EQ(subscription->dropped.load(), 0u);
+    EXPECT_EQ(subscription->LostCount(), 0u);
+    gateway_->Unsubscribe(subscription);
+  }
+}
+
+TEST_F(PythonApiGtwTest, FullBlockingSubscriptionHoldsTheFeed) {
+  SubscriptionOptions options;
+  options.policy = BackpressurePolicy::BlockWithTimeout;
+  options.capacity = 2;
+  options.block_timeout = std::chrono::milliseconds(20);
+  auto blocking = gateway_->Subscribe({}, {}, options);
+
+  MarketDataPoint point;
+  gateway_->Broadcast(point);
+  gateway_->Broadcast(point);
+  EXPECT_EQ(blocking->block_timeouts.load(), 0u);
+
+  const auto start = std::chrono::steady_clock::now();
+  gateway_->Broadcast(point);
+  EXPECT_GE(std::chrono::steady_clock::now() - start, options.block_timeout);
+  EXPECT_EQ(blocking->block_timeouts.load(), 1u);
+
+  // room again once it reads
+  ASSERT_TRUE(blocking->Poll(point));
+  ASSERT_TRUE(blocking->Poll(point));
+  gateway_->Broadcast(point);
+  EXPECT_EQ(blocking->block_timeouts.load(), 1u);
+
+  gateway_->Unsubscribe(blocking);
+}
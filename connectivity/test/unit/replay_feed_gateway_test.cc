@@ -0,0 +1,160 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+#include "feed_protocol.h"
+#include "replay_feed_gateway.h"
+
+namespace {
+
+class RecordingSink : public FeedSink {
+public:
+  void OnPoint(std::size_t /*feed*/, const MarketDataPoint &point,
+               uint64_t sequence) override {
+    std::lock_guard<std::mutex> lock(mutex_);
+    points.push_back(point);
+    sequences.push_back(sequence);
+  }
+
+  void OnFeedClosed(std::size_t feed) override {
+    std::lock_guard<std::mutex> lock(mutex_);
+    closed.push_back(feed);
+    changed_.notify_all();
+  }
+
+  bool WaitClosed() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    return changed_.wait_for(lock, std::chrono::seconds(5),
+                             [this] { return !closed.empty(); });
+  }
+
+  std::vector<MarketDataPoint> points;
+  std::vector<uint64_t> sequences;
+  std::vector<std::size_t> closed;
+
+private:
+  std::mutex mutex_;
+  std::condition_variable changed_;
+};
+
+std::string Record(const std::string &symbol, double price,
+                   int64_t timestamp_ns, uint64_t sequence) {
+  std::string record(kBinaryRecordHeaderSize + symbol.size() + 8, '\0');
+  const uint16_t length = static_cast<uint16_t>(record.size());
+  const uint8_t symbol_length = static_cast<uint8_t>(symbol.size());
+  const int64_t quantity = 1;
+
+  std::memcpy(&record[0], &length, sizeof(length));
+  std::memcpy(&record[2], &symbol_length, sizeof(symbol_length));
+  std::memcpy(&record[4], &price, sizeof(price));
+  std::memcpy(&record[12], &quantity, sizeof(quantity));
+  std::memcpy(&record[20], &timestamp_ns, sizeof(timestamp_ns));
+  std::memcpy(&record[kBinaryRecordHeaderSize], symbol.data(), symbol.size());
+  std::memcpy(&record[kBinaryRecordHeaderSize + symbol.size()], &sequence,
+              sizeof(sequence));
+  return record;
+}
+
+constexpr int64_t kSecond = 1000000000;
+constexpr int64_t kStart = 1700000000 * kSecond;
+
+} // namespace
+
+class ReplayFeedGatewayTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    char path[] = "/tmp/replay_feed_gateway_testXXXXXX";
+    const int fd = mkstemp(path);
+    ASSERT_NE(fd, -1);
+    close(fd);
+    path_ = path;
+  }
+
+  void TearDown() override { std::remove(path_.c_str()); }
+
+  void Write(const std::string &contents) {
+    std::ofstream(path_, std::ios::binary) << contents;
+  }
+
+  std::string path_;
+  RecordingSink sink_;
+};
+
+TEST_F(ReplayFeedGatewayTest, ReplaysEveryRecordInOrder) {
+  Write(std::string(1, static_cast<char>(kBinaryFeedHandshake)) +
+        Record("AAPL", 1.5, kStart, 1) + Record("MSFT", 2.5, kStart, 2) +
+        Record("AAPL", 3.5, kStart + kSecond, 3));
+
+  ReplayFeedGateway feed(path_, ReplayFeedGateway::kAsFastAsPossible);
+  feed.Start(sink_, 2);
+  ASSERT_TRUE(sink_.WaitClosed());
+  feed.Stop();
+
+  ASSERT_EQ(sink_.points.size(), 3u);
+  EXPECT_EQ(sink_.points[1].instrument_id(), "MSFT");
+  EXPECT_DOUBLE_EQ(sink_.points[2].price, 3.5);
+  // the recorded time, not the time of the replay
+  EXPECT_EQ(sink_.points[2].timestamp_seconds, 1700000001);
+  EXPECT_EQ(sink_.sequences, (std::vector<uint64_t>{1, 2, 3}));
+  EXPECT_EQ(sink_.closed, std::vector<std::size_t>{2});
+  EXPECT_EQ(feed.ReplayedCount(), 3u);
+  EXPECT_FALSE(feed.IsRunning());
+}
+
+TEST_F(ReplayFeedGatewayTest, KeepsThePaceOfTheRecording) {
+  // 200 ms of recording, 10 times faster
+  Write(Record("AAPL", 1, kStart, 1) +
+        Record("AAPL", 2, kStart + kSecond / 10, 2) +
+        Record("AAPL", 3, kStart + kSecond / 5, 3));
+
+  ReplayFeedGateway feed(path_, 10);
+  const auto start = std::chrono::steady_clock::now();
+  feed.Start(sink_, 0);
+  ASSERT_TRUE(sink_.WaitClosed());
+  const auto elapsed = std::chrono::steady_clock::now() - start;
+
+  EXPECT_EQ(sink_.points.size(), 3u);
+  EXPECT_GE(elapsed, std::chrono::milliseconds(20));
+  EXPECT_LT(elapsed, std::chrono::milliseconds(200));
+}
+
+TEST_F(ReplayFeedGatewayTest, StopInterruptsTheWait) {
+  // the second record is due in an hour
+  Write(Record("AAPL", 1, kStart, 1) +
+        Record("AAPL", 2, kStart + 3600 * kSecond, 2));
+
+  ReplayFeedGateway feed(path_);
+  feed.Start(sink_, 0);
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  feed.Stop();
+
+  EXPECT_EQ(sink_.points.size(), 1u);
+  EXPECT_EQ(sink_.closed.size(), 1u);
+}
+
+TEST_F(ReplayFeedGatewayTest, StopsAtATruncatedRecord) {
+  const std::string last = Record("MSFT", 2, kStart, 2);
+  Write(Record("AAPL", 1, kStart, 1) + last.substr(0, last.size() - 3));
+
+  ReplayFeedGateway feed(path_, ReplayFeedGateway::kAsFastAsPossible);
+  feed.Start(sink_, 0);
+  ASSERT_TRUE(sink_.WaitClosed());
+
+  EXPECT_EQ(sink_.points.size(), 1u);
+}
+
+TEST_F(ReplayFeedGatewayTest, MissingFileClosesTheFeed) {
+  ReplayFeedGateway feed(path_ + ".missing");
+  feed.Start(sink_, 0);
+  ASSERT_TRUE(sink_.WaitClosed());
+
+  EXPECT_TRUE(sink_.points.empty());
+}
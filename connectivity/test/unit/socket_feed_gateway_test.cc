@@ -0,0 +1,208 @@
+#include <gtest/gtest.h>
+#include <boost/asio.hpp>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "feed_protocol.h"
+#include "socket_feed_gateway.h"
+
+using boost::asio::ip::tcp;
+
+namespace {
+
+// keeps what the feed hands over
+class RecordingSink : public FeedSink {
+public:
+  void OnPoint(std::size_t feed, const MarketDataPoint &point,
+               uint64_t sequence) override {
+    std::lock_guard<std::mutex> lock(mutex_);
+    feeds.push_back(feed);
+    points.push_back(point);
+    sequences.push_back(sequence);
+    changed_.notify_all();
+  }
+
+  void OnFeedClosed(std::size_t feed) override {
+    std::lock_guard<std::mutex> lock(mutex_);
+    closed.push_back(feed);
+    changed_.notify_all();
+  }
+
+  void OnFeedSession(std::size_t /*feed*/) override {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ++sessions;
+  }
+
+  bool WaitClosed() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    return changed_.wait_for(lock, std::chrono::seconds(5),
+                             [this] { return !closed.empty(); });
+  }
+
+  bool WaitPoints(std::size_t count) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    return changed_.wait_for(lock, std::chrono::seconds(5),
+                             [this, count] { return points.size() >= count; });
+  }
+
+  std::vector<std::size_t> feeds;
+  std::vector<MarketDataPoint> points;
+  std::vector<uint64_t> sequences;
+  std::vector<std::size_t> closed;
+  int sessions = 0;
+
+private:
+  std::mutex mutex_;
+  std::condition_variable changed_;
+};
+
+// the python feed, on a free port of this host
+class FeedServer {
+public:
+  FeedServer() : acceptor_(ios_, tcp::endpoint(tcp::v4(), 0)) {}
+
+  uint16_t Port() const { return acceptor_.local_endpoint().port(); }
+
+  void Accept() { acceptor_.accept(socket_); }
+
+  void Send(const std::string &data) {
+    boost::asio::write(socket_, boost::asio::buffer(data));
+  }
+
+  void Close() { socket_.close(); }
+
+private:
+  boost::asio::io_service ios_;
+  tcp::acceptor acceptor_;
+  tcp::socket socket_{ios_};
+};
+
+std::string Record(const std::string &symbol, double price,
+                   uint64_t sequence = kNoSequence) {
+  std::string record(kBinaryRecordHeaderSize + symbol.size() +
+                         (sequence != kNoSequence ? sizeof(sequence) : 0),
+                     '\0');
+  const uint16_t length = static_cast<uint16_t>(record.size());
+  const uint8_t symbol_length = static_cast<uint8_t>(symbol.size());
+  const int64_t quantity = 1;
+  const int64_t timestamp_ns = 1700000000000000000;
+
+  std::memcpy(&record[0], &length, sizeof(length));
+  std::memcpy(&record[2], &symbol_length, sizeof(symbol_length));
+  std::memcpy(&record[4], &price, sizeof(price));
+  std::memcpy(&record[12], &quantity, sizeof(quantity));
+  std::memcpy(&record[20], &timestamp_ns, sizeof(timestamp_ns));
+  std::memcpy(&record[kBinaryRecordHeaderSize], symbol.data(), symbol.size());
+  if (sequence != kNoSequence) {
+    std::memcpy(&record[kBinaryRecordHeaderSize + symbol.size()], &sequence,
+                sizeof(sequence));
+  }
+  return record;
+}
+
+} // namespace
+
+TEST(SocketFeedGatewayTest, NameIsTheAddress) {
+  SocketFeedGateway feed("127.0.0.1", 9001);
+  EXPECT_EQ(feed.Name(), "127.0.0.1:9001");
+  EXPECT_FALSE(feed.IsRunning());
+}
+
+TEST(SocketFeedGatewayTest, HandsJsonLinesToTheSink) {
+  FeedServer server;
+  RecordingSink sink;
+  SocketFeedGateway feed("127.0.0.1", server.Port());
+
+  feed.Start(sink, 3);
+  server.Accept();
+  server.Send("{\"instrument_id\": \"AAPL\", \"price\": 1.5, \"quantity\": 10}\n"
+              "{\"instrument_id\": \"MSFT\", \"price\": 2.5, \"quantity\": 20}\n");
+  server.Close();
+
+  ASSERT_TRUE(sink.WaitClosed());
+  feed.Stop();
+
+  ASSERT_EQ(sink.points.size(), 2u);
+  EXPECT_EQ(sink.points[0].instrument_id(), "AAPL");
+  EXPECT_EQ(sink.points[1].instrument_id(), "MSFT");
+  EXPECT_EQ(sink.feeds, (std::vector<std::size_t>{3, 3}));
+  EXPECT_EQ(sink.closed, std::vector<std::size_t>{3});
+  EXPECT_FALSE(feed.IsRunning());
+}
+
+TEST(SocketFeedGatewayTest, HandsBinaryRecordsToTheSink) {
+  FeedServer server;
+  RecordingSink sink;
+  SocketFeedGateway feed("127.0.0.1", server.Port());
+
+  feed.Start(sink, 0);
+  server.Accept();
+  server.Send(std::string(1, static_cast<char>(kBinaryFeedHandshake)) +
+              Record("AAPL", 1.5) + Record("GOOG", 3.5, 7));
+  server.Close();
+
+  ASSERT_TRUE(sink.WaitClosed());
+
+  ASSERT_EQ(sink.points.size(), 2u);
+  EXPECT_EQ(sink.points[1].instrument_id(), "GOOG");
+  EXPECT_DOUBLE_EQ(sink.points[1].price, 3.5);
+  EXPECT_EQ(sink.sequences, (std::vector<uint64_t>{kNoSequence, 7}));
+}
+
+TEST(SocketFeedGatewayTest, StopEndsAnIdleConnection) {
+  FeedServer server;
+  RecordingSink sink;
+  SocketFeedGateway feed("127.0.0.1", server.Port());
+
+  feed.Start(sink, 0);
+  server.Accept();
+
+  // nothing is sent, the read only returns because of the shutdown
+  feed.Stop();
+
+  EXPECT_EQ(sink.closed.size(), 1u);
+  EXPECT_FALSE(feed.IsRunning());
+}
+
+TEST(SocketFeedGatewayTest, ClosesWhenNothingListens) {
+  uint16_t port;
+  {
+    FeedServer server;
+    port = server.Port();
+  }
+
+  RecordingSink sink;
+  SocketFeedGateway feed("127.0.0.1", port);
+  feed.Start(sink, 1);
+
+  ASSERT_TRUE(sink.WaitClosed());
+  EXPECT_TRUE(sink.points.empty());
+  EXPECT_EQ(sink.closed, std::vector<std::size_t>{1});
+}
+
+TEST(SocketFeedGatewayTest, ReconnectsAfterADrop) {
+  FeedServer server;
+  RecordingSink sink;
+  SocketFeedGateway feed("127.0.0.1", server.Port(),
+                         std::chrono::milliseconds(10));
+
+  feed.Start(sink, 0);
+  server.Accept();
+  server.Close();
+
+  // the feed is still open, and comes back
+  server.Accept();
+  server.Send("{\"instrument_id\": \"AAPL\", \"price\": 1.5, \"quantity\": 1}\n");
+  ASSERT_TRUE(sink.WaitPoints(1));
+  EXPECT_TRUE(sink.closed.empty());
+  EXPECT_TRUE(feed.IsRunning());
+  EXPECT_EQ(feed.ConnectCount(), 2u);
+  // the arbitration of the lines learns the numbering may restart
+  EXPECT_EQ(sink.sessions, 2);
+
+  feed.Stop();
+  EXPECT_EQ(sink.closed.size(), 1u);
+}
@@ -0,0 +1,72 @@
+#include <gtest/gtest.h>
+#include <string>
+#include <thread>
+#include <vector>
+#include "symbol_table.h"
+
+TEST(SymbolTableTest, EmptyNameIsTheEmptyId) {
+  auto &table = SymbolTable::GetInstance();
+
+  EXPECT_EQ(table.Intern(""), SymbolTable::kEmptyId);
+  EXPECT_EQ(table.Name(SymbolTable::kEmptyId), "");
+}
+
+TEST(SymbolTableTest, SameNameSameId) {
+  auto &table = SymbolTable::GetInstance();
+
+  const uint32_t aapl = table.Intern("SYMBOL_TEST_AAPL");
+  const uint32_t msft = table.Intern("SYMBOL_TEST_MSFT");
+
+  EXPECT_NE(aapl, SymbolTable::kEmptyId);
+  EXPECT_NE(aapl, msft);
+  EXPECT_EQ(table.Intern(std::string("SYMBOL_TEST_AAPL")), aapl);
+  EXPECT_EQ(table.Name(aapl), "SYMBOL_TEST_AAPL");
+  EXPECT_EQ(table.Name(msft), "SYMBOL_TEST_MSFT");
+}
+
+TEST(SymbolTableTest, IdsAreDense) {
+  auto &table = SymbolTable::GetInstance();
+
+  const uint32_t first = table.Intern("SYMBOL_TEST_DENSE_0");
+  const uint32_t second = table.Intern("SYMBOL_TEST_DENSE_1");
+
+  EXPECT_EQ(second, first + 1);
+  EXPECT_EQ(table.Size(), second + 1);
+}
+
+TEST(SymbolTableTest, UnknownIdHasNoName) {
+  auto &table = SymbolTable::GetInstance();
+
+  EXPECT_EQ(table.Name(static_cast<uint32_t>(table.Size())), "");
+}
+
+TEST(SymbolTableTest, LongNameIsTruncated) {
+  auto &table = SymbolTable::GetInstance();
+  const std::string name(40, 'Y');
+
+  const uint32_t id = table.Intern(name);
+
+  EXPECT_EQ(table.Name(id), name.substr(0, SymbolTable::kMaxNameLength));
+  EXPECT_EQ(table.Intern(name.substr(0, SymbolTable::kMaxNameLength)), id);
+}
+
+TEST(SymbolTableTest, ConcurrentInternAgrees) {
+  auto &table = SymbolTable::GetInstance();
+  // crosses a chunk, so names are read while a new chunk is published
+  constexpr int kNames = 3000;
+  std::vector<uint32_t> ids[2];
+
+  auto intern = [&table](std::vector<uint32_t> &ids) {
+    for (int i = 0; i < kNames; ++i) {
+      const std::string name = "SYMBOL_TEST_RACE_" + std::to_string(i);
+      ids.push_back(table.Intern(name));
+      EXPECT_EQ(table.Name(ids.back()), name);
+    }
+  };
+
+  std::thread other(intern, std::ref(ids[1]));
+  intern(ids[0]);
+  other.join();
+
+  EXPECT_EQ(ids[0], ids[1]);
+}
@@ -4,6 +4,8 @@ script   : NEWLINE* statement* EOF ;
 
 statement
     : schedule
+    | cancel
+    | reschedule
     | reacton
     | print
     | alert
@@ -14,6 +16,8 @@ statement
     ;
 
 schedule   : SCHEDULE argumentList block NEWLINE* ;
+cancel   : CANCEL argumentList NEWLINE* ;
+reschedule   : RESCHEDULE argumentList NEWLINE* ;
 reacton   : REACTON argumentList block NEWLINE* ;
 print   : PRINT '(' expression ')' NEWLINE* ;
 alert   : ALERT '(' expression ')' NEWLINE* ;
@@ -53,6 +57,8 @@ fragment DIGIT : [0-9] ;
 
 
 SCHEDULE : 'Schedule' ;
+CANCEL : 'Cancel' ;
+RESCHEDULE : 'Reschedule' ;
 REACTON : 'ReactOn' ;
 PRINT : 'Print' ;
 ALERT : 'Alert' ;